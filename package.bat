@@ -45,6 +45,7 @@ copy /Y "%QT_DIR%\bin\Qt6Gui.dll" "%DEPLOY_DIR%\" >nul
 copy /Y "%QT_DIR%\bin\Qt6Widgets.dll" "%DEPLOY_DIR%\" >nul
 copy /Y "%QT_DIR%\bin\Qt6Charts.dll" "%DEPLOY_DIR%\" >nul
 copy /Y "%QT_DIR%\bin\Qt6Qml.dll" "%DEPLOY_DIR%\" >nul
+copy /Y "%QT_DIR%\bin\Qt6Svg.dll" "%DEPLOY_DIR%\" >nul
 copy /Y "%QT_DIR%\bin\Qt6Network.dll" "%DEPLOY_DIR%\" >nul
 copy /Y "%QT_DIR%\bin\Qt6OpenGL.dll" "%DEPLOY_DIR%\" >nul
 copy /Y "%QT_DIR%\bin\Qt6OpenGLWidgets.dll" "%DEPLOY_DIR%\" >nul
@@ -141,6 +141,30 @@ void AppSettings::setWindowMaximized(bool maximized)
     m_settings->sync();
 }
 
+// ==================== 脚本相关 ====================
+
+int AppSettings::scriptTimeout() const
+{
+    return qMax(0, m_settings->value("Script/Timeout", DEFAULT_SCRIPT_TIMEOUT).toInt());
+}
+
+void AppSettings::setScriptTimeout(int seconds)
+{
+    m_settings->setValue("Script/Timeout", qMax(0, seconds));
+    m_settings->sync();
+}
+
+int AppSettings::derivedCacheLimit() const
+{
+    return qMax(0, m_settings->value("Script/DerivedCacheLimit", DEFAULT_DERIVED_CACHE_LIMIT).toInt());
+}
+
+void AppSettings::setDerivedCacheLimit(int megabytes)
+{
+    m_settings->setValue("Script/DerivedCacheLimit", qMax(0, megabytes));
+    m_settings->sync();
+}
+
 // ==================== 其他设置 ====================
 
 QStringList AppSettings::recentFiles() const
@@ -108,6 +108,28 @@ public:
      */
     void setWindowMaximized(bool maximized);
     
+    // ==================== 脚本相关 ====================
+    
+    /**
+     * @brief 获取脚本执行超时时间（秒），0 表示不限时
+     */
+    int scriptTimeout() const;
+    
+    /**
+     * @brief 设置脚本执行超时时间（秒）
+     */
+    void setScriptTimeout(int seconds);
+    
+    /**
+     * @brief 获取派生列磁盘缓存的大小上限（MB），0 表示禁用
+     */
+    int derivedCacheLimit() const;
+    
+    /**
+     * @brief 设置派生列磁盘缓存的大小上限（MB）
+     */
+    void setDerivedCacheLimit(int megabytes);
+    
     // ==================== 其他设置 ====================
     
     /**
@@ -145,6 +167,8 @@ private:
     
     // 默认值
     static const int DEFAULT_MAX_RECENT_FILES = 10;
+    static const int DEFAULT_SCRIPT_TIMEOUT = 120;
+    static const int DEFAULT_DERIVED_CACHE_LIMIT = 2048;
 };
 
 #endif // APPSETTINGS_H
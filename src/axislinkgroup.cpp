@@ -0,0 +1,108 @@
+#include "axislinkgroup.h"
+#include "chartwidget.h"
+
+namespace {
+// 约一帧的合并间隔（60Hz）
+const int kFrameIntervalMs = 16;
+}
+
+AxisLinkGroup::AxisLinkGroup(QObject *parent)
+    : QObject(parent)
+    , m_enabled(false)
+    , m_min(0.0)
+    , m_max(1.0)
+    , m_hasRange(false)
+{
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setInterval(kFrameIntervalMs);
+    connect(m_frameTimer, &QTimer::timeout, this, &AxisLinkGroup::broadcast);
+}
+
+void AxisLinkGroup::addChart(ChartWidget *chart)
+{
+    if (!chart || m_charts.contains(chart)) {
+        return;
+    }
+    m_charts.append(chart);
+    connect(chart, &ChartWidget::xRangeChanged, this, &AxisLinkGroup::onChartRangeChanged);
+    connect(chart, &QObject::destroyed, this, [this](QObject *object) {
+        for (int i = m_charts.size() - 1; i >= 0; --i) {
+            if (m_charts[i].isNull() || static_cast<QObject*>(m_charts[i].data()) == object) {
+                m_charts.removeAt(i);
+            }
+        }
+    });
+}
+
+void AxisLinkGroup::removeChart(ChartWidget *chart)
+{
+    if (!chart) {
+        return;
+    }
+    m_charts.removeAll(chart);
+    disconnect(chart, nullptr, this, nullptr);
+    if (m_source == chart) {
+        m_source = nullptr;
+    }
+}
+
+void AxisLinkGroup::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+    m_enabled = enabled;
+    m_frameTimer->stop();
+
+    if (!m_enabled) {
+        return;
+    }
+
+    // 以当前可见的图表为基准对齐其他图表
+    for (const QPointer<ChartWidget> &chart : m_charts) {
+        if (chart && chart->isVisible()) {
+            double xMin, xMax, yMin, yMax;
+            chart->getViewRange(xMin, xMax, yMin, yMax);
+            m_source = chart;
+            m_min = xMin;
+            m_max = xMax;
+            m_hasRange = true;
+            broadcast();
+            break;
+        }
+    }
+}
+
+void AxisLinkGroup::syncChart(ChartWidget *chart)
+{
+    if (m_enabled && m_hasRange && chart) {
+        chart->applyLinkedXRange(m_min, m_max);
+    }
+}
+
+void AxisLinkGroup::onChartRangeChanged(double min, double max)
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    m_source = qobject_cast<ChartWidget*>(sender());
+    m_min = min;
+    m_max = max;
+    m_hasRange = true;
+
+    // 拖拽、滚轮产生的连续变化在一帧内只广播一次
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start();
+    }
+}
+
+void AxisLinkGroup::broadcast()
+{
+    for (const QPointer<ChartWidget> &chart : m_charts) {
+        if (chart && chart != m_source) {
+            chart->applyLinkedXRange(m_min, m_max);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef AXISLINKGROUP_H
+#define AXISLINKGROUP_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+
+class ChartWidget;
+
+/**
+ * @brief X轴联动组
+ * 组内任一图表缩放或平移时，将X轴范围同步到其他图表。
+ * 同一帧内的多次变化合并为一次广播；不可见的图表延迟到显示时再更新
+ */
+class AxisLinkGroup : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AxisLinkGroup(QObject *parent = nullptr);
+
+    /**
+     * @brief 加入图表（图表销毁时自动移除）
+     */
+    void addChart(ChartWidget *chart);
+
+    /**
+     * @brief 移出图表
+     */
+    void removeChart(ChartWidget *chart);
+
+    /**
+     * @brief 启用/禁用联动
+     * 启用时将当前图表的X范围同步到组内其他图表
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief 将组内最近一次的X范围应用到指定图表（用于新加入的图表）
+     */
+    void syncChart(ChartWidget *chart);
+
+private slots:
+    void onChartRangeChanged(double min, double max);
+    void broadcast();
+
+private:
+    QList<QPointer<ChartWidget>> m_charts;
+    bool m_enabled;
+
+    // 待广播的范围（按帧合并）
+    QPointer<ChartWidget> m_source;
+    double m_min;
+    double m_max;
+    bool m_hasRange;
+    QTimer *m_frameTimer;
+};
+
+#endif // AXISLINKGROUP_H
@@ -1,10 +1,13 @@
 #include "canvaspanel.h"
 #include <QSplitter>
+#include <QShowEvent>
 
-CanvasPanel::CanvasPanel(CsvParser *parser, ScriptEngine *scriptEngine, QWidget *parent)
+CanvasPanel::CanvasPanel(CsvParser *parser, ColumnStore *columnStore, QWidget *parent)
     : QWidget(parent)
     , m_csvParser(parser)
-    , m_scriptEngine(scriptEngine)
+    , m_columnStore(columnStore)
+    , m_columnsDirty(false)
+    , m_hasPendingPreset(false)
 {
     // 主布局使用分割器
     QSplitter *splitter = new QSplitter(Qt::Horizontal, this);
@@ -71,6 +74,35 @@ CanvasPanel::~CanvasPanel()
 
 void CanvasPanel::refreshColumnList()
 {
+    // 隐藏的标签页不处理数据更新，显示时统一刷新
+    if (!isVisible()) {
+        m_columnsDirty = true;
+        return;
+    }
+    rebuildColumnList();
+}
+
+void CanvasPanel::ensureRealized()
+{
+    if (m_columnsDirty) {
+        rebuildColumnList();
+    }
+    if (m_hasPendingPreset) {
+        m_hasPendingPreset = false;
+        applyPresetNow(m_pendingPreset);
+    }
+}
+
+void CanvasPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    ensureRealized();
+}
+
+void CanvasPanel::rebuildColumnList()
+{
+    m_columnsDirty = false;
+    
     // 暂时断开信号，避免在更新过程中触发
     m_xAxisComboBox->blockSignals(true);
     
@@ -131,15 +163,21 @@ void CanvasPanel::refreshColumnList()
         }
     }
     
-    // 添加计算列到列表和X轴下拉框
-    for (auto it = m_computedColumns.constBegin(); it != m_computedColumns.constEnd(); ++it) {
-        QListWidgetItem *item = new QListWidgetItem("📊 " + it.key());
+    // 添加计算列到列表和X轴下拉框（已被删除的计算列不再保持选中）
+    const QStringList computedNames = m_columnStore ? m_columnStore->derivedColumnNames() : QStringList();
+    for (const QString &computedName : previousSelectedComputedColumns) {
+        if (!computedNames.contains(computedName)) {
+            m_selectedComputedColumns.remove(computedName);
+        }
+    }
+    for (const QString &computedName : computedNames) {
+        QListWidgetItem *item = new QListWidgetItem("📊 " + computedName);
         item->setData(Qt::UserRole, -1);  // 计算列使用-1作为索引
         item->setData(Qt::UserRole + 1, true);  // 标记为计算列
-        item->setData(Qt::UserRole + 2, it.key());  // 存储计算列名称
-        item->setToolTip("计算列: " + it.key() + " (点击添加/移除)");
+        item->setData(Qt::UserRole + 2, computedName);  // 存储计算列名称
+        item->setToolTip("计算列: " + computedName + " (点击添加/移除)");
         // 恢复之前的选中状态
-        if (previousSelectedComputedColumns.contains(it.key())) {
+        if (previousSelectedComputedColumns.contains(computedName)) {
             item->setCheckState(Qt::Checked);
         } else {
             item->setCheckState(Qt::Unchecked);
@@ -150,7 +188,7 @@ void CanvasPanel::refreshColumnList()
         m_columnListWidget->addItem(item);
         
         // 添加计算列到X轴下拉框
-        m_xAxisComboBox->addItem("📊 " + it.key(), QVariant::fromValue(QString("computed:" + it.key())));
+        m_xAxisComboBox->addItem("📊 " + computedName, QVariant::fromValue(QString("computed:" + computedName)));
     }
     
     // 恢复X轴选择
@@ -245,19 +283,30 @@ void CanvasPanel::onXAxisChanged(int index)
 
 void CanvasPanel::updateChart()
 {
-    m_chart->clearChart();
-    
     if ((m_selectedColumns.isEmpty() && m_selectedComputedColumns.isEmpty()) || !m_csvParser) {
+        m_chart->clearChart();
         return;
     }
     
-    // 获取X轴数据
-    QVector<double> xData = getXAxisData();
+    // 获取X轴数据（为空表示使用行索引，不生成索引数组）
+    QVector<double> xData;
+    if (!getXAxisData(xData)) {
+        m_chart->clearChart();
+        return;
+    }
     QString xAxisLabel = m_xAxisComboBox->currentText();
     QString xAxisColumnName = getXAxisColumnName();
     bool xAxisIsComputed = isXAxisComputed();
     
-    // 添加选中的CSV列
+    // 收集应当显示的曲线（数据均为列存储的共享引用）
+    struct WantedSeries {
+        QString name;
+        QVector<double> xData;
+        QVector<double> yData;
+    };
+    QList<WantedSeries> wanted;
+    
+    // 选中的CSV列
     QStringList columnNames = m_csvParser->getColumnNames();
     for (int colIndex : m_selectedColumns) {
         QString colName = columnNames[colIndex];
@@ -267,36 +316,46 @@ void CanvasPanel::updateChart()
             continue;
         }
         
-        QVector<double> yData = m_csvParser->getColumnData(colIndex);
-        
-        // 获取该列的样式设置
-        SeriesStyle style = m_seriesStyles.value(colName, SeriesStyle());
-        m_chart->addSeries(colName, xData, yData, QColor(), style);
+        ColumnHandle column = m_columnStore ? m_columnStore->column(colName) : ColumnHandle();
+        if (!column) {
+            continue;
+        }
+        wanted.append({colName, xData, column->values});
     }
     
-    // 添加选中的计算列
+    // 选中的计算列
     for (const QString &computedName : m_selectedComputedColumns) {
         // 跳过X轴列（如果X轴使用的是计算列）
         if (xAxisIsComputed && computedName == xAxisColumnName) {
             continue;
         }
         
-        if (m_computedColumns.contains(computedName)) {
-            QVector<double> yData = m_computedColumns[computedName];
-            // 使用X轴数据或者生成对应长度的索引
-            QVector<double> computedXData;
-            if (xData.size() == yData.size()) {
-                computedXData = xData;
-            } else {
-                // 如果长度不匹配，生成索引作为X轴
-                for (int i = 0; i < yData.size(); ++i) {
-                    computedXData.append(static_cast<double>(i));
-                }
-            }
-            
-            // 获取该计算列的样式设置
-            SeriesStyle style = m_seriesStyles.value(computedName, SeriesStyle());
-            m_chart->addSeries(computedName, computedXData, yData, QColor(), style);
+        ColumnHandle column = m_columnStore ? m_columnStore->derivedColumn(computedName) : ColumnHandle();
+        if (column) {
+            const QVector<double> &yData = column->values;
+            // 使用X轴数据；长度不匹配时以行索引作为X轴
+            QVector<double> computedXData = xData.size() == yData.size()
+                                            ? xData : QVector<double>();
+            wanted.append({computedName, computedXData, yData});
+        }
+    }
+    
+    // 与图表中已有的曲线对比，只处理变化的部分：
+    // 取消选中的曲线单独移除，新选中的单独添加，已有曲线仅在数据变化（如切换X轴）时重映射
+    QSet<QString> wantedNames;
+    for (const WantedSeries &series : wanted) {
+        wantedNames.insert(series.name);
+    }
+    for (const QString &name : m_chart->seriesNames()) {
+        if (!wantedNames.contains(name)) {
+            m_chart->removeSeries(name);
+        }
+    }
+    for (const WantedSeries &series : wanted) {
+        if (!m_chart->setSeriesData(series.name, series.xData, series.yData)) {
+            // 获取该列的样式设置
+            SeriesStyle style = m_seriesStyles.value(series.name, SeriesStyle());
+            m_chart->addSeries(series.name, series.xData, series.yData, QColor(), style);
         }
     }
     
@@ -304,12 +363,12 @@ void CanvasPanel::updateChart()
     m_chart->setYAxisLabel("Value");
 }
 
-QVector<double> CanvasPanel::getXAxisData()
+bool CanvasPanel::getXAxisData(QVector<double> &xData)
 {
-    QVector<double> xData;
+    xData.clear();
     
-    if (!m_csvParser || m_csvParser->getRowCount() == 0) {
-        return xData;
+    if (!m_csvParser || m_csvParser->getRowCount() == 0 || !m_columnStore) {
+        return false;
     }
     
     QVariant xAxisData = m_xAxisComboBox->currentData();
@@ -318,26 +377,29 @@ QVector<double> CanvasPanel::getXAxisData()
     // 检查是否是计算列（存储为 "computed:列名" 格式）
     if (dataStr.startsWith("computed:")) {
         QString computedName = dataStr.mid(9);  // 去掉 "computed:" 前缀
-        if (m_computedColumns.contains(computedName)) {
-            return m_computedColumns[computedName];
+        ColumnHandle column = m_columnStore->derivedColumn(computedName);
+        if (column) {
+            xData = column->values;
         }
-        // 计算列不存在，返回空
-        return xData;
+        // 计算列不存在时X轴不可用
+        return !xData.isEmpty();
     }
     
     int xAxisIndex = xAxisData.toInt();
     
     if (xAxisIndex < 0) {
-        // 使用行索引
-        for (int i = 0; i < m_csvParser->getRowCount(); ++i) {
-            xData.append(static_cast<double>(i));
-        }
-    } else {
+        // 使用行索引：由图表按下标直接换算，不生成数组
+        return true;
+    }
+    if (xAxisIndex < m_csvParser->getColumnCount()) {
         // 使用选定的CSV列
-        xData = m_csvParser->getColumnData(xAxisIndex);
+        ColumnHandle column = m_columnStore->column(m_csvParser->getColumnNames()[xAxisIndex]);
+        if (column) {
+            xData = column->values;
+        }
     }
     
-    return xData;
+    return !xData.isEmpty();
 }
 
 QString CanvasPanel::getXAxisColumnName() const
@@ -436,6 +498,11 @@ void CanvasPanel::updateYAxisAvailability()
 
 PlotPreset CanvasPanel::getPreset() const
 {
+    // 尚未显示过的标签页直接返回暂存的预设
+    if (m_hasPendingPreset) {
+        return m_pendingPreset;
+    }
+    
     PlotPreset preset;
     
     // 获取X轴列名
@@ -476,6 +543,18 @@ PlotPreset CanvasPanel::getPreset() const
 }
 
 void CanvasPanel::applyPreset(const PlotPreset &preset)
+{
+    // 隐藏的标签页只暂存预设，首次显示时再创建曲线
+    if (!isVisible()) {
+        m_pendingPreset = preset;
+        m_hasPendingPreset = true;
+        return;
+    }
+    m_hasPendingPreset = false;
+    applyPresetNow(preset);
+}
+
+void CanvasPanel::applyPresetNow(const PlotPreset &preset)
 {
     if (!m_csvParser || m_csvParser->getColumnCount() == 0) {
         return;
@@ -515,7 +594,7 @@ void CanvasPanel::applyPreset(const PlotPreset &preset)
     
     // 设置计算列
     for (const QString &colName : preset.computedColumns) {
-        if (m_computedColumns.contains(colName)) {
+        if (m_columnStore && m_columnStore->derivedColumn(colName)) {
             m_selectedComputedColumns.insert(colName);
             
             // 更新列表项的复选框状态
@@ -565,28 +644,6 @@ void CanvasPanel::applyPreset(const PlotPreset &preset)
     }
 }
 
-void CanvasPanel::addComputedColumn(const QString &name, const QVector<double> &data)
-{
-    // 只更新内部数据存储，不添加到UI列表
-    // UI列表的更新由 refreshColumnList() 统一处理
-    m_computedColumns[name] = data;
-}
-
-void CanvasPanel::removeComputedColumn(const QString &name)
-{
-    // 只更新内部数据存储
-    m_computedColumns.remove(name);
-    m_selectedComputedColumns.remove(name);
-    // UI更新由 refreshColumnList() 统一处理
-}
-
-void CanvasPanel::clearComputedColumns()
-{
-    m_computedColumns.clear();
-    m_selectedComputedColumns.clear();
-    // UI更新由 refreshColumnList() 统一处理
-}
-
 void CanvasPanel::showColumnContextMenu(const QPoint &pos)
 {
     QListWidgetItem *item = m_columnListWidget->itemAt(pos);
@@ -650,7 +707,8 @@ void CanvasPanel::showColumnContextMenu(const QPoint &pos)
                 isSelected = m_selectedColumns.contains(colIndex);
             }
             
-            if (isSelected) {
+            // 已绘制的曲线直接更新样式，无需重建整个图表
+            if (isSelected && !m_chart->setSeriesStyle(columnName, newStyle)) {
                 updateChart();
             }
         }
@@ -675,7 +733,7 @@ void CanvasPanel::showColumnContextMenu(const QPoint &pos)
             isSelected = m_selectedColumns.contains(colIndex);
         }
         
-        if (isSelected) {
+        if (isSelected && !m_chart->setSeriesStyle(columnName, SeriesStyle())) {
             updateChart();
         }
     });
@@ -14,7 +14,7 @@
 #include "chartwidget.h"
 #include "csvparser.h"
 #include "presetmanager.h"
-#include "scriptengine.h"
+#include "columnstore.h"
 #include "seriesstyledialog.h"
 
 /**
@@ -26,11 +26,12 @@ class CanvasPanel : public QWidget
     Q_OBJECT
     
 public:
-    explicit CanvasPanel(CsvParser *parser, ScriptEngine *scriptEngine = nullptr, QWidget *parent = nullptr);
+    explicit CanvasPanel(CsvParser *parser, ColumnStore *columnStore, QWidget *parent = nullptr);
     ~CanvasPanel();
     
     /**
      * @brief 刷新列列表
+     * 标签页隐藏时只做标记，首次显示时再刷新并重绘
      */
     void refreshColumnList();
     
@@ -56,8 +57,17 @@ public:
     
     /**
      * @brief 应用绘图预设
+     * 标签页隐藏时暂存预设，首次显示时再绑定数据并创建曲线
      */
     void applyPreset(const PlotPreset &preset);
+    
+    /**
+     * @brief 立即完成被推迟的刷新（如导出隐藏的标签页之前）
+     */
+    void ensureRealized();
+
+protected:
+    void showEvent(QShowEvent *event) override;
 
 private slots:
     /**
@@ -77,14 +87,27 @@ private slots:
 
 private:
     /**
-     * @brief 更新图表
+     * @brief 重建列列表（refreshColumnList 的实际实现）
+     */
+    void rebuildColumnList();
+    
+    /**
+     * @brief 立即应用绘图预设（applyPreset 的实际实现）
+     */
+    void applyPresetNow(const PlotPreset &preset);
+    
+    /**
+     * @brief 按当前选择增量更新图表
+     * 只添加/移除选择变化的曲线，X轴变化时就地替换已有曲线的数据
      */
     void updateChart();
     
     /**
      * @brief 获取X轴数据
+     * @param xData 输出；使用行索引时为空（隐式索引，不生成数组）
+     * @return X轴数据是否可用
      */
-    QVector<double> getXAxisData();
+    bool getXAxisData(QVector<double> &xData);
     
     /**
      * @brief 获取当前X轴列名
@@ -107,28 +130,9 @@ private:
      */
     void updateItemStyleIndicator(QListWidgetItem *item, bool hasStyle);
 
-public:
-    /**
-     * @brief 添加计算列（来自脚本引擎）
-     * @param name 列名
-     * @param data 数据
-     */
-    void addComputedColumn(const QString &name, const QVector<double> &data);
-    
-    /**
-     * @brief 移除计算列
-     * @param name 列名
-     */
-    void removeComputedColumn(const QString &name);
-    
-    /**
-     * @brief 清除所有计算列
-     */
-    void clearComputedColumns();
-
 private:
     CsvParser *m_csvParser;
-    ScriptEngine *m_scriptEngine;
+    ColumnStore *m_columnStore;     // 源数据列和计算列都从这里按句柄读取
     
     // UI组件
     QHBoxLayout *m_mainLayout;
@@ -149,14 +153,16 @@ private:
     // 列名到索引的映射
     QMap<QString, int> m_columnIndexMap;
     
-    // 计算列数据存储 (列名 -> 数据)
-    QMap<QString, QVector<double>> m_computedColumns;
-    
     // 已选中的计算列
     QSet<QString> m_selectedComputedColumns;
     
     // 曲线样式设置 (列名/计算列名 -> 样式)
     QMap<QString, SeriesStyle> m_seriesStyles;
+    
+    // 延迟实现：隐藏期间推迟的列表刷新和预设
+    bool m_columnsDirty;
+    bool m_hasPendingPreset;
+    PlotPreset m_pendingPreset;
 };
 
 #endif // CANVASPANEL_H
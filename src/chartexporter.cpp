@@ -0,0 +1,709 @@
+#include "chartexporter.h"
+#include "densitymap.h"
+#include "spectrogramrenderer.h"
+#include "geometrycache.h"
+#include "xvalues.h"
+#include <QCoreApplication>
+#include <QThreadPool>
+#include <QPointer>
+#include <QFileInfo>
+#include <QPainter>
+#include <QImage>
+#include <QSvgGenerator>
+#include <QPdfWriter>
+#include <QPageSize>
+#include <QPageLayout>
+#include <QFontMetricsF>
+#include <QPolygonF>
+#include <QtMath>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// 每次提交给QPainter的折线最大点数，过长的折线会让部分绘图后端变慢
+const int kPolylineBatch = 64 * 1024;
+
+// 时频图每个像素列最多平均的段数（完整精度导出时不限）
+const int kSpectrogramFramesPerColumn = 32;
+
+/**
+ * @brief 计算美观的刻度间隔（1/2/5 × 10^n）
+ */
+double niceStep(double range, int targetTicks)
+{
+    if (!(range > 0) || targetTicks <= 0) {
+        return 1.0;
+    }
+    double raw = range / targetTicks;
+    double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+    double residual = raw / magnitude;
+    if (residual > 5.0) {
+        return 10.0 * magnitude;
+    } else if (residual > 2.0) {
+        return 5.0 * magnitude;
+    } else if (residual > 1.0) {
+        return 2.0 * magnitude;
+    }
+    return magnitude;
+}
+
+QList<double> niceTicks(double minValue, double maxValue, int targetTicks)
+{
+    QList<double> ticks;
+    double step = niceStep(maxValue - minValue, targetTicks);
+    double first = std::ceil(minValue / step) * step;
+    for (double v = first; v <= maxValue + step * 1e-9 && ticks.size() < 100; v += step) {
+        // 消除 -0 和浮点累积误差
+        ticks.append(qAbs(v) < step * 1e-9 ? 0.0 : v);
+    }
+    return ticks;
+}
+
+QString tickLabel(double value)
+{
+    return QString::number(value, 'g', 6);
+}
+
+/**
+ * @brief 数据坐标到输出坐标的映射
+ */
+struct Mapper {
+    QRectF plot;
+    double xMin, xMax, yMin, yMax;
+    double sx, sy;
+
+    Mapper(const QRectF &plotRect, double x0, double x1, double y0, double y1)
+        : plot(plotRect), xMin(x0), xMax(x1), yMin(y0), yMax(y1)
+    {
+        sx = (xMax > xMin) ? plot.width() / (xMax - xMin) : 0.0;
+        sy = (yMax > yMin) ? plot.height() / (yMax - yMin) : 0.0;
+    }
+
+    double mapX(double x) const { return plot.left() + (x - xMin) * sx; }
+    double mapY(double y) const { return plot.bottom() - (y - yMin) * sy; }
+};
+
+/**
+ * @brief 一个独立的Y轴（多Y轴模式下可能有多个）
+ */
+struct AxisSpec {
+    QString title;
+    double yMin;
+    double yMax;
+    bool left;
+    double offset;  // 距离绘图区边缘的偏移
+};
+
+/**
+ * @brief 绘制折线
+ * 全分辨率模式按批次绘制所有点；抽稀模式下对落在同一像素列的连续点
+ * 只保留首、末、最小、最大四个点，保证输出与全分辨率在像素级一致
+ */
+void drawLine(QPainter *painter, const Mapper &map,
+              const QVector<double> &xData, const QVector<double> &yData,
+              bool decimate)
+{
+    const int count = XValues::count(xData, yData);
+    const XValues px(xData);
+    const double *py = yData.constData();
+
+    QPolygonF polyline;
+    polyline.reserve(qMin(count, kPolylineBatch));
+
+    auto flush = [&](bool keepLast) {
+        if (polyline.size() >= 2) {
+            painter->drawPolyline(polyline);
+        }
+        QPointF last = polyline.isEmpty() ? QPointF() : polyline.last();
+        bool hadPoints = !polyline.isEmpty();
+        polyline.clear();
+        // 分批时保留上一批的最后一个点，使折线连续
+        if (keepLast && hadPoints) {
+            polyline.append(last);
+        }
+    };
+    auto append = [&](const QPointF &p) {
+        polyline.append(p);
+        if (polyline.size() >= kPolylineBatch) {
+            flush(true);
+        }
+    };
+
+    if (!decimate) {
+        for (int i = 0; i < count; ++i) {
+            if (!std::isfinite(px[i]) || !std::isfinite(py[i])) {
+                flush(false);
+                continue;
+            }
+            append(QPointF(map.mapX(px[i]), map.mapY(py[i])));
+        }
+        flush(false);
+        return;
+    }
+
+    // 当前像素列内的连续段
+    bool hasRun = false;
+    qint64 runColumn = 0;
+    int firstIdx = 0, lastIdx = 0, minIdx = 0, maxIdx = 0;
+
+    auto emitRun = [&]() {
+        if (!hasRun) {
+            return;
+        }
+        int order[4] = {firstIdx, qMin(minIdx, maxIdx), qMax(minIdx, maxIdx), lastIdx};
+        int previous = -1;
+        for (int idx : order) {
+            if (idx != previous) {
+                append(QPointF(map.mapX(px[idx]), map.mapY(py[idx])));
+                previous = idx;
+            }
+        }
+        hasRun = false;
+    };
+
+    for (int i = 0; i < count; ++i) {
+        if (!std::isfinite(px[i]) || !std::isfinite(py[i])) {
+            emitRun();
+            flush(false);
+            continue;
+        }
+        qint64 column = static_cast<qint64>(std::floor(map.mapX(px[i])));
+        if (hasRun && column == runColumn) {
+            lastIdx = i;
+            if (py[i] < py[minIdx]) minIdx = i;
+            if (py[i] > py[maxIdx]) maxIdx = i;
+            continue;
+        }
+        emitRun();
+        hasRun = true;
+        runColumn = column;
+        firstIdx = lastIdx = minIdx = maxIdx = i;
+    }
+    emitRun();
+    flush(false);
+}
+
+/**
+ * @brief 绘制散点
+ * 抽稀模式下每个输出像素只绘制一次
+ */
+void drawScatter(QPainter *painter, const Mapper &map,
+                 const QVector<double> &xData, const QVector<double> &yData,
+                 double radius, bool decimate)
+{
+    const int count = XValues::count(xData, yData);
+    const XValues px(xData);
+    const int width = qMax(1, qCeil(map.plot.width()));
+    const int height = qMax(1, qCeil(map.plot.height()));
+    std::vector<bool> visited;
+    if (decimate) {
+        visited.assign(static_cast<size_t>(width) * height, false);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        double x = map.mapX(px[i]);
+        double y = map.mapY(yData[i]);
+        if (!std::isfinite(x) || !std::isfinite(y)) {
+            continue;
+        }
+        if (decimate) {
+            qint64 cx = static_cast<qint64>(x - map.plot.left());
+            qint64 cy = static_cast<qint64>(y - map.plot.top());
+            if (cx < 0 || cx >= width || cy < 0 || cy >= height) {
+                continue;
+            }
+            size_t cell = static_cast<size_t>(cy) * width + cx;
+            if (visited[cell]) {
+                continue;
+            }
+            visited[cell] = true;
+        }
+        painter->drawEllipse(QPointF(x, y), radius, radius);
+    }
+}
+
+/**
+ * @brief 绘制包络带
+ * 每个输出像素列填充最小/最大值区域，可选叠加均值线
+ */
+void drawEnvelope(QPainter *painter, const Mapper &map, const LodPyramid &lod,
+                  const QColor &color, double lineWidth, bool showMean)
+{
+    const int columns = qMax(1, qRound(map.plot.width()));
+    const QVector<LodPyramid::Column> cols = lod.aggregate(map.xMin, map.xMax, columns, true);
+
+    // 上边界从左到右、下边界从右到左，组成闭合多边形；空列处断开
+    QPolygonF upper, lower, mean;
+    auto flushBand = [&]() {
+        if (!upper.isEmpty()) {
+            QPolygonF band = upper;
+            for (int i = lower.size() - 1; i >= 0; --i) {
+                band.append(lower[i]);
+            }
+            QColor fill = color;
+            fill.setAlpha(90);
+            painter->setPen(QPen(color, 1.0));
+            painter->setBrush(fill);
+            painter->drawPolygon(band);
+        }
+        if (showMean && mean.size() >= 2) {
+            painter->setPen(QPen(color.darker(150), lineWidth));
+            painter->setBrush(Qt::NoBrush);
+            painter->drawPolyline(mean);
+        }
+        upper.clear();
+        lower.clear();
+        mean.clear();
+    };
+
+    for (const LodPyramid::Column &c : cols) {
+        if (c.count == 0) {
+            flushBand();
+            continue;
+        }
+        double x = map.mapX(c.x);
+        upper.append(QPointF(x, map.mapY(c.max)));
+        lower.append(QPointF(x, map.mapY(c.min)));
+        mean.append(QPointF(x, map.mapY(c.mean())));
+    }
+    flushBand();
+}
+
+/**
+ * @brief 按后缀创建输出设备并绘制
+ */
+bool renderToImage(const ExportJob &job, const QString &suffix, QString *error)
+{
+    const ExportOptions &options = job.options;
+    QImage image(options.size, QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull()) {
+        if (error) *error = QString("无法分配 %1x%2 的图像").arg(options.size.width()).arg(options.size.height());
+        return false;
+    }
+    const int dotsPerMeter = qRound(options.dpi / 0.0254);
+    image.setDotsPerMeterX(dotsPerMeter);
+    image.setDotsPerMeterY(dotsPerMeter);
+    image.fill(Qt::white);
+
+    {
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setRenderHint(QPainter::TextAntialiasing);
+        ChartExporter::render(&painter, QRectF(QPointF(0, 0), QSizeF(options.size)),
+                              job.snapshot, options, options.dpi / 96.0);
+    }
+
+    bool ok;
+    if (suffix == "jpg" || suffix == "jpeg") {
+        ok = image.convertToFormat(QImage::Format_RGB32).save(job.filePath, "JPG", options.quality);
+    } else {
+        ok = image.save(job.filePath);
+    }
+    if (!ok && error) {
+        *error = QString("无法写入文件: %1").arg(job.filePath);
+    }
+    return ok;
+}
+
+bool renderToSvg(const ExportJob &job, QString *error)
+{
+    const ExportOptions &options = job.options;
+    QSvgGenerator generator;
+    generator.setFileName(job.filePath);
+    generator.setSize(options.size);
+    generator.setViewBox(QRect(QPoint(0, 0), options.size));
+    generator.setResolution(options.dpi);
+    generator.setTitle(job.snapshot.title);
+
+    QPainter painter;
+    if (!painter.begin(&generator)) {
+        if (error) *error = QString("无法写入文件: %1").arg(job.filePath);
+        return false;
+    }
+    painter.fillRect(QRectF(QPointF(0, 0), QSizeF(options.size)), Qt::white);
+    ChartExporter::render(&painter, QRectF(QPointF(0, 0), QSizeF(options.size)),
+                          job.snapshot, options, options.dpi / 96.0);
+    painter.end();
+    return true;
+}
+
+bool renderToPdf(const ExportJob &job, QString *error)
+{
+    const ExportOptions &options = job.options;
+    QPdfWriter writer(job.filePath);
+    writer.setResolution(options.dpi);
+    writer.setTitle(job.snapshot.title);
+    // 页面尺寸与输出像素尺寸在给定DPI下一致，无页边距
+    QSizeF pageInches(double(options.size.width()) / options.dpi,
+                      double(options.size.height()) / options.dpi);
+    writer.setPageSize(QPageSize(pageInches, QPageSize::Inch, QString(), QPageSize::ExactMatch));
+    writer.setPageMargins(QMarginsF(0, 0, 0, 0));
+
+    QPainter painter;
+    if (!painter.begin(&writer)) {
+        if (error) *error = QString("无法写入文件: %1").arg(job.filePath);
+        return false;
+    }
+    painter.setRenderHint(QPainter::Antialiasing);
+    QRectF target(QPointF(0, 0), QSizeF(painter.viewport().size()));
+    ChartExporter::render(&painter, target, job.snapshot, options, options.dpi / 96.0);
+    painter.end();
+    return true;
+}
+
+} // namespace
+
+ChartExporter::ChartExporter(QObject *parent)
+    : QObject(parent)
+    , m_total(0)
+    , m_finished(0)
+    , m_succeeded(0)
+{
+}
+
+QStringList ChartExporter::supportedFormats()
+{
+    return QStringList() << "png" << "jpg" << "jpeg" << "bmp" << "svg" << "pdf";
+}
+
+void ChartExporter::exportCharts(const QList<ExportJob> &jobs)
+{
+    if (jobs.isEmpty()) {
+        return;
+    }
+
+    // 上一批已完成则开始新的批次，否则并入当前批次
+    if (!isBusy()) {
+        m_total = 0;
+        m_finished = 0;
+        m_succeeded = 0;
+        m_errors.clear();
+    }
+    m_total += jobs.size();
+
+    QPointer<ChartExporter> self(this);
+    for (const ExportJob &job : jobs) {
+        QThreadPool::globalInstance()->start([self, job]() {
+            QString error;
+            bool success = renderToFile(job, &error);
+            // 回到GUI线程汇报结果
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [self, job, success, error]() {
+                if (self) {
+                    self->onJobFinished(job.filePath, success, error);
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void ChartExporter::onJobFinished(const QString &filePath, bool success, const QString &error)
+{
+    m_finished++;
+    if (success) {
+        m_succeeded++;
+    } else {
+        m_errors.append(error);
+    }
+
+    emit progress(m_finished, m_total, filePath, success);
+    if (m_finished >= m_total) {
+        emit allFinished(m_succeeded, m_total, m_errors);
+    }
+}
+
+void ChartExporter::prepareGeometry(ChartSnapshot &snapshot)
+{
+    for (ChartSnapshot::Series &series : snapshot.series) {
+        if (series.prepared) {
+            continue;
+        }
+        const PreparedGeometry geometry = GeometryCache::build(series.xData, series.yData,
+                                                               series.style.filterByRange,
+                                                               series.style.minValue,
+                                                               series.style.maxValue);
+        series.xData = geometry.filteredX;
+        series.yData = geometry.filteredY;
+        series.lod = geometry.lod;
+        series.prepared = true;
+    }
+}
+
+bool ChartExporter::renderToFile(const ExportJob &source, QString *error)
+{
+    // 快照中的数据为隐式共享，复制任务不复制数据
+    ExportJob job = source;
+    prepareGeometry(job.snapshot);
+
+    const QSize &size = job.options.size;
+    if (size.width() <= 0 || size.height() <= 0 || job.options.dpi <= 0) {
+        if (error) *error = QString("无效的导出尺寸: %1").arg(job.filePath);
+        return false;
+    }
+
+    QString suffix = QFileInfo(job.filePath).suffix().toLower();
+    if (suffix == "svg") {
+        return renderToSvg(job, error);
+    } else if (suffix == "pdf") {
+        return renderToPdf(job, error);
+    } else if (supportedFormats().contains(suffix)) {
+        return renderToImage(job, suffix, error);
+    }
+
+    if (error) *error = QString("不支持的文件格式: %1").arg(job.filePath);
+    return false;
+}
+
+void ChartExporter::render(QPainter *painter, const QRectF &rect,
+                           const ChartSnapshot &snapshot, const ExportOptions &options,
+                           double scale)
+{
+    painter->save();
+
+    const double margin = 16 * scale;
+    QFont titleFont = painter->font();
+    titleFont.setPointSizeF(12);
+    titleFont.setBold(true);
+    QFont labelFont = painter->font();
+    labelFont.setPointSizeF(9);
+    QFont tickFont = painter->font();
+    tickFont.setPointSizeF(8);
+
+    // 字体度量按绘图设备的DPI计算
+    QFontMetricsF titleMetrics(titleFont, painter->device());
+    QFontMetricsF labelMetrics(labelFont, painter->device());
+    QFontMetricsF tickMetrics(tickFont, painter->device());
+
+    QRectF area = rect.adjusted(margin, margin, -margin, -margin);
+
+    // 标题
+    if (!snapshot.title.isEmpty()) {
+        painter->setFont(titleFont);
+        painter->setPen(Qt::black);
+        QRectF titleRect(area.left(), area.top(), area.width(), titleMetrics.height());
+        painter->drawText(titleRect, Qt::AlignCenter, snapshot.title);
+        area.setTop(titleRect.bottom() + margin * 0.5);
+    }
+
+    // 图例（单行，超出宽度时自动换行）
+    const double swatch = 18 * scale;
+    const double legendGap = 12 * scale;
+    if (!snapshot.series.isEmpty()) {
+        painter->setFont(labelFont);
+        double rowHeight = labelMetrics.height();
+        QList<QList<int>> rows;
+        QList<double> rowWidths;
+        double currentWidth = 0;
+        rows.append(QList<int>());
+        rowWidths.append(0);
+        for (int i = 0; i < snapshot.series.size(); ++i) {
+            double itemWidth = swatch + 4 * scale + labelMetrics.horizontalAdvance(snapshot.series[i].name);
+            if (!rows.last().isEmpty() && currentWidth + legendGap + itemWidth > area.width()) {
+                rows.append(QList<int>());
+                rowWidths.append(0);
+                currentWidth = 0;
+            }
+            currentWidth += (rows.last().isEmpty() ? 0 : legendGap) + itemWidth;
+            rows.last().append(i);
+            rowWidths.last() = currentWidth;
+        }
+
+        double y = area.top();
+        for (int r = 0; r < rows.size(); ++r) {
+            double x = area.left() + (area.width() - rowWidths[r]) / 2;
+            for (int i : rows[r]) {
+                const ChartSnapshot::Series &series = snapshot.series[i];
+                painter->setPen(Qt::NoPen);
+                painter->setBrush(series.color);
+                painter->drawRect(QRectF(x, y + rowHeight * 0.3, swatch, rowHeight * 0.4));
+                painter->setPen(Qt::black);
+                painter->setBrush(Qt::NoBrush);
+                x += swatch + 4 * scale;
+                double textWidth = labelMetrics.horizontalAdvance(series.name);
+                painter->drawText(QRectF(x, y, textWidth + 1, rowHeight),
+                                  Qt::AlignLeft | Qt::AlignVCenter, series.name);
+                x += textWidth + legendGap;
+            }
+            y += rowHeight;
+        }
+        area.setTop(y + margin * 0.5);
+    }
+
+    // 收集独立的Y轴，左右交替排列
+    QList<AxisSpec> axes;
+    if (snapshot.multiAxisMode && !snapshot.series.isEmpty()) {
+        for (const ChartSnapshot::Series &series : snapshot.series) {
+            bool exists = false;
+            for (const AxisSpec &axis : axes) {
+                if (axis.title == series.axisTitle && axis.yMin == series.yMin && axis.yMax == series.yMax) {
+                    exists = true;
+                    break;
+                }
+            }
+            if (!exists) {
+                axes.append({series.axisTitle, series.yMin, series.yMax, axes.size() % 2 == 0, 0.0});
+            }
+        }
+    } else {
+        axes.append({snapshot.yAxisLabel, snapshot.yMin, snapshot.yMax, true, 0.0});
+    }
+
+    // 每个Y轴的宽度：刻度文字 + 轴标题
+    const double tickLength = 5 * scale;
+    double axisWidth = tickLength + tickMetrics.horizontalAdvance("-0.000000") + 4 * scale
+                       + labelMetrics.height() + 4 * scale;
+    double leftWidth = 0, rightWidth = 0;
+    for (AxisSpec &axis : axes) {
+        if (axis.left) {
+            axis.offset = leftWidth;
+            leftWidth += axisWidth;
+        } else {
+            axis.offset = rightWidth;
+            rightWidth += axisWidth;
+        }
+    }
+    double bottomHeight = tickLength + tickMetrics.height() + 4 * scale;
+    if (!snapshot.xAxisLabel.isEmpty()) {
+        bottomHeight += labelMetrics.height();
+    }
+
+    QRectF plot(area.left() + leftWidth, area.top(),
+                area.width() - leftWidth - rightWidth, area.height() - bottomHeight);
+    if (plot.width() <= 1 || plot.height() <= 1) {
+        painter->restore();
+        return;
+    }
+
+    // 网格与X轴
+    QPen gridPen(QColor(220, 220, 220), 1 * scale);
+    QPen axisPen(QColor(80, 80, 80), 1 * scale);
+    const int xTickTarget = qMax(2, static_cast<int>(plot.width() / (100 * scale)));
+    const int yTickTarget = qMax(2, static_cast<int>(plot.height() / (60 * scale)));
+    QList<double> xTicks = niceTicks(snapshot.xMin, snapshot.xMax, xTickTarget);
+    Mapper xMapper(plot, snapshot.xMin, snapshot.xMax, 0, 1);
+
+    painter->setFont(tickFont);
+    for (double tick : xTicks) {
+        double x = xMapper.mapX(tick);
+        painter->setPen(gridPen);
+        painter->drawLine(QPointF(x, plot.top()), QPointF(x, plot.bottom()));
+        painter->setPen(axisPen);
+        painter->drawLine(QPointF(x, plot.bottom()), QPointF(x, plot.bottom() + tickLength));
+        QString text = tickLabel(tick);
+        double w = tickMetrics.horizontalAdvance(text);
+        painter->drawText(QRectF(x - w / 2 - 1, plot.bottom() + tickLength, w + 2, tickMetrics.height()),
+                          Qt::AlignCenter, text);
+    }
+    if (!snapshot.xAxisLabel.isEmpty()) {
+        painter->setFont(labelFont);
+        painter->drawText(QRectF(plot.left(), plot.bottom() + tickLength + tickMetrics.height() + 4 * scale,
+                                 plot.width(), labelMetrics.height()),
+                          Qt::AlignCenter, snapshot.xAxisLabel);
+    }
+
+    // Y轴（网格线仅按第一个轴绘制）
+    for (int a = 0; a < axes.size(); ++a) {
+        const AxisSpec &axis = axes[a];
+        Mapper yMapper(plot, 0, 1, axis.yMin, axis.yMax);
+        double edge = axis.left ? plot.left() - axis.offset : plot.right() + axis.offset;
+        double dir = axis.left ? -1.0 : 1.0;
+
+        painter->setPen(axisPen);
+        painter->drawLine(QPointF(edge, plot.top()), QPointF(edge, plot.bottom()));
+        painter->setFont(tickFont);
+        for (double tick : niceTicks(axis.yMin, axis.yMax, yTickTarget)) {
+            double y = yMapper.mapY(tick);
+            if (a == 0) {
+                painter->setPen(gridPen);
+                painter->drawLine(QPointF(plot.left(), y), QPointF(plot.right(), y));
+                painter->setPen(axisPen);
+            }
+            painter->drawLine(QPointF(edge, y), QPointF(edge + dir * tickLength, y));
+            QString text = tickLabel(tick);
+            double w = tickMetrics.horizontalAdvance(text);
+            double textX = axis.left ? edge - tickLength - 2 * scale - w : edge + tickLength + 2 * scale;
+            painter->drawText(QRectF(textX, y - tickMetrics.height() / 2, w + 1, tickMetrics.height()),
+                              Qt::AlignVCenter | (axis.left ? Qt::AlignRight : Qt::AlignLeft), text);
+        }
+
+        if (!axis.title.isEmpty()) {
+            painter->setFont(labelFont);
+            double titleCenter = edge + dir * (axisWidth - labelMetrics.height() / 2 - 2 * scale);
+            painter->save();
+            painter->translate(titleCenter, plot.center().y());
+            painter->rotate(axis.left ? -90 : 90);
+            painter->drawText(QRectF(-plot.height() / 2, -labelMetrics.height() / 2,
+                                     plot.height(), labelMetrics.height()),
+                              Qt::AlignCenter, axis.title);
+            painter->restore();
+        }
+    }
+
+    // 绘图区边框
+    painter->setPen(axisPen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(plot);
+
+    // 数据
+    painter->save();
+    painter->setClipRect(plot);
+    const bool decimate = !options.fullResolution;
+    for (const ChartSnapshot::Series &series : snapshot.series) {
+        double yMin = snapshot.multiAxisMode ? series.yMin : snapshot.yMin;
+        double yMax = snapshot.multiAxisMode ? series.yMax : snapshot.yMax;
+        Mapper map(plot, snapshot.xMin, snapshot.xMax, yMin, yMax);
+        SeriesDisplayMode mode = series.style.displayMode;
+
+        if (mode == SeriesDisplayMode::Density) {
+            // 按输出分辨率重新分箱，导出图像与屏幕分辨率无关
+            DensityBinner::Grid grid = DensityBinner::bin(series.xData, series.yData,
+                                                          snapshot.xMin, snapshot.xMax, yMin, yMax,
+                                                          qMax(1, qRound(plot.width())),
+                                                          qMax(1, qRound(plot.height())));
+            QImage image = DensityBinner::colorize(grid);
+            if (!image.isNull()) {
+                painter->drawImage(plot, image);
+            }
+            continue;
+        }
+
+        if (mode == SeriesDisplayMode::Spectrogram) {
+            // 按输出分辨率重新计算，Y轴范围即频率范围
+            QImage image = SpectrogramRenderer::render(series.xData, series.yData, series.style.spectral,
+                                                       snapshot.xMin, snapshot.xMax, yMin, yMax,
+                                                       qMax(1, qRound(plot.width())),
+                                                       qMax(1, qRound(plot.height())),
+                                                       decimate ? kSpectrogramFramesPerColumn : 0);
+            if (!image.isNull()) {
+                painter->drawImage(plot, image);
+            }
+            continue;
+        }
+
+        if (mode == SeriesDisplayMode::Envelope && series.lod) {
+            drawEnvelope(painter, map, *series.lod, series.color,
+                         series.style.lineWidth * scale, series.style.showMeanLine);
+            continue;
+        }
+
+        // X无序的包络带退化为折线
+        if (mode == SeriesDisplayMode::Line || mode == SeriesDisplayMode::LineAndScatter ||
+            mode == SeriesDisplayMode::Envelope) {
+            QPen pen(series.color, series.style.lineWidth * scale);
+            pen.setJoinStyle(Qt::RoundJoin);
+            pen.setCapStyle(Qt::RoundCap);
+            painter->setPen(pen);
+            painter->setBrush(Qt::NoBrush);
+            drawLine(painter, map, series.xData, series.yData, decimate);
+        }
+        if (mode == SeriesDisplayMode::Scatter || mode == SeriesDisplayMode::LineAndScatter) {
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(series.color);
+            drawScatter(painter, map, series.xData, series.yData,
+                        series.style.scatterSize * scale / 2.0, decimate);
+        }
+    }
+    painter->restore();
+
+    painter->restore();
+}
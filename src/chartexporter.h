@@ -0,0 +1,142 @@
+#ifndef CHARTEXPORTER_H
+#define CHARTEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QColor>
+#include <QSize>
+#include <QRectF>
+#include "seriesstyledialog.h"
+#include "lodpyramid.h"
+
+class QPainter;
+
+/**
+ * @brief 图表快照
+ * 在GUI线程中从ChartWidget采集，数据列为隐式共享，
+ * 之后可在工作线程中独立渲染而不访问任何图表对象
+ */
+struct ChartSnapshot
+{
+    /**
+     * @brief 单条曲线的快照
+     */
+    struct Series {
+        QString name;
+        QVector<double> xData;      // 全分辨率数据（已按样式过滤），为空表示X为行索引
+        QVector<double> yData;
+        QSharedPointer<const LodPyramid> lod;   // X单调时可用，包络带按输出列聚合
+        // 为 false 时曲线仍在显示预览：xData/yData 为未过滤的源数据，lod 为空，
+        // 由 prepareGeometry 在工作线程中按样式构建
+        bool prepared = true;
+        QColor color;
+        SeriesStyle style;
+        QString axisTitle;          // 所用Y轴的标题
+        double yMin = 0.0;          // 所用Y轴的当前范围
+        double yMax = 1.0;
+    };
+
+    QString title;
+    QString xAxisLabel;
+    QString yAxisLabel;
+    double xMin = 0.0;              // 当前视图范围
+    double xMax = 1.0;
+    double yMin = 0.0;
+    double yMax = 1.0;
+    bool multiAxisMode = false;
+    QList<Series> series;
+};
+
+/**
+ * @brief 导出选项
+ */
+struct ExportOptions
+{
+    QSize size = QSize(1920, 1080); // 输出尺寸（像素）
+    int dpi = 96;                   // 分辨率，影响字体和线宽的像素尺寸
+    int quality = 95;               // JPEG质量
+    bool fullResolution = true;     // true: 绘制全部数据点；false: 按输出像素列抽稀
+};
+
+/**
+ * @brief 单个导出任务
+ */
+struct ExportJob
+{
+    ChartSnapshot snapshot;
+    QString filePath;               // 按后缀选择格式：png / jpg / jpeg / bmp / svg / pdf
+    ExportOptions options;
+};
+
+/**
+ * @brief 图表导出引擎
+ * 在工作线程中离屏渲染图表，支持任意分辨率、DPI和 PNG/JPEG/SVG/PDF 格式，
+ * 可一次提交多个Canvas的任务而不阻塞界面
+ */
+class ChartExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChartExporter(QObject *parent = nullptr);
+
+    /**
+     * @brief 提交一批导出任务（异步执行）
+     */
+    void exportCharts(const QList<ExportJob> &jobs);
+
+    /**
+     * @brief 是否有尚未完成的任务
+     */
+    bool isBusy() const { return m_finished < m_total; }
+
+    /**
+     * @brief 支持的文件后缀
+     */
+    static QStringList supportedFormats();
+
+    /**
+     * @brief 为快照中尚未构建几何数据的曲线按样式过滤并建立LOD金字塔
+     * 大数据量时耗时较长，应在工作线程中调用
+     */
+    static void prepareGeometry(ChartSnapshot &snapshot);
+
+    /**
+     * @brief 同步渲染任务到文件（可在任意线程调用），会先调用 prepareGeometry
+     * @param error 失败时的错误信息
+     */
+    static bool renderToFile(const ExportJob &job, QString *error = nullptr);
+
+    /**
+     * @brief 将快照绘制到指定区域
+     * @param scale 线宽、边距相对于96 DPI的缩放系数
+     */
+    static void render(QPainter *painter, const QRectF &rect,
+                       const ChartSnapshot &snapshot, const ExportOptions &options,
+                       double scale);
+
+signals:
+    /**
+     * @brief 单个任务完成
+     */
+    void progress(int finished, int total, const QString &filePath, bool success);
+
+    /**
+     * @brief 当前批次全部完成
+     * @param errors 失败任务的错误信息
+     */
+    void allFinished(int succeeded, int total, const QStringList &errors);
+
+private:
+    void onJobFinished(const QString &filePath, bool success, const QString &error);
+
+    int m_total;
+    int m_finished;
+    int m_succeeded;
+    QStringList m_errors;
+};
+
+#endif // CHARTEXPORTER_H
@@ -1,4 +1,8 @@
 #include "chartwidget.h"
+#include "geometrycache.h"
+#include "xvalues.h"
+#include "spectralanalyzer.h"
+#include "spectrogramrenderer.h"
 #include <QHBoxLayout>
 #include <QPen>
 #include <QBrush>
@@ -7,6 +11,10 @@
 #include <QDialogButtonBox>
 #include <QScrollArea>
 #include <QGridLayout>
+#include <QShowEvent>
+#include <QPointer>
+#include <QThreadPool>
+#include <QCoreApplication>
 #include <cmath>
 #include <limits>
 
@@ -16,6 +24,45 @@ QT_USE_NAMESPACE
 QT_CHARTS_USE_NAMESPACE
 #endif
 
+namespace {
+// 折线点数超过该值时按视图从LOD金字塔降采样显示
+const int kLodMinPoints = 20000;
+// 尚未布局时生成初始显示点使用的列数
+const int kLodInitialColumns = 2000;
+// 折线在间断处最多拆分的段数，超出时只断开X跨度最大的间断
+const int kMaxLineSegments = 256;
+// 点数超过该值时先显示抽样预览，完整几何数据在后台构建
+const int kProgressiveMinPoints = 1000000;
+// 预览的最大点数
+const int kPreviewPoints = 20000;
+// 交互帧间隔（约60Hz）
+const int kFrameIntervalMs = 16;
+// 交互进行中LOD重采样/密度重新分箱的最小间隔
+const int kInteractiveRefreshMs = 100;
+// 时频图细化时每个像素列最多平均的段数，限制深度缩小视图的计算量
+const int kSpectrogramFramesPerColumn = 32;
+// 提示框内容最多每隔该时间重建一次
+const int kTooltipRefreshMs = 50;
+// 最后一次缩放/平移后经过该时间视为交互结束
+const int kInteractionIdleMs = 150;
+
+// 两个数组是否共享同一份存储（隐式共享时无需逐元素比较）
+inline bool isSameBuffer(const QVector<double> &a, const QVector<double> &b)
+{
+    return a.size() == b.size() && a.constData() == b.constData();
+}
+
+// 取系列的数据点（与系列共享存储，不逐点复制）
+inline QVector<QPointF> seriesPoints(const QXYSeries *series)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return series->points();
+#else
+    return series->pointsVector();
+#endif
+}
+}
+
 // ==================== ChartWidget ====================
 
 ChartWidget::ChartWidget(QWidget *parent)
@@ -24,6 +71,9 @@ ChartWidget::ChartWidget(QWidget *parent)
     , m_originalXMin(0), m_originalXMax(1)
     , m_originalYMin(0), m_originalYMax(1)
     , m_multiAxisMode(false)
+    , m_suppressXRangeSignal(false)
+    , m_hasPendingXRange(false)
+    , m_pendingXMin(0), m_pendingXMax(1)
 {
     m_layout = new QVBoxLayout(this);
     m_layout->setContentsMargins(0, 0, 0, 0);
@@ -50,12 +100,59 @@ ChartWidget::ChartWidget(QWidget *parent)
     m_chartView->setRenderHint(QPainter::Antialiasing);
     m_chartView->setMouseTracking(true);
     m_chartView->setAxes(m_axisX, m_axisY);
+    m_chartView->setOwner(this);
+    connect(m_chartView, &InteractiveChartView::interactionFinished,
+            this, &ChartWidget::onInteractionFinished);
     
     m_layout->addWidget(m_chartView);
+    
+    // 概览条：显示全部数据和当前视图范围，拖动刷选框平移/缩放主图
+    m_overview = new OverviewWidget(this);
+    m_layout->addWidget(m_overview);
+    // 刷选框与鼠标拖拽一样按帧合并，拖动期间LOD、密度图等按交互状态降频
+    connect(m_overview, &OverviewWidget::viewRangeRequested, m_chartView, &InteractiveChartView::requestXRange);
+    connect(m_overview, &OverviewWidget::dragStarted, m_chartView, [this]() {
+        m_chartView->setExternalDragging(true);
+    });
+    connect(m_overview, &OverviewWidget::dragFinished, m_chartView, [this]() {
+        m_chartView->setExternalDragging(false);
+    });
+    connect(m_axisX, &QValueAxis::rangeChanged, m_overview, &OverviewWidget::setViewRange);
+    connect(m_chart, &QChart::plotAreaChanged, this, &ChartWidget::updateOverviewMargins);
+    connect(m_overviewCheckBox, &QCheckBox::toggled, m_overview, &QWidget::setVisible);
+    
+    // 大数据量折线：缩放、平移后按视图重新降采样，同一帧内合并为一次
+    m_lodTimer = new QTimer(this);
+    m_lodTimer->setSingleShot(true);
+    m_lodTimer->setInterval(0);
+    connect(m_lodTimer, &QTimer::timeout, this, &ChartWidget::updateLodSeries);
+    connect(m_axisX, &QValueAxis::rangeChanged, this, &ChartWidget::scheduleLodUpdate);
+    connect(m_chart, &QChart::plotAreaChanged, this, &ChartWidget::scheduleLodUpdate);
+    
+    // 密度图层：缩放、平移或绘图区域变化后合并为一次重新分箱
+    m_densityTimer = new QTimer(this);
+    m_densityTimer->setSingleShot(true);
+    m_densityTimer->setInterval(0);
+    connect(m_densityTimer, &QTimer::timeout, this, &ChartWidget::updateDensityLayers);
+    connect(m_axisX, &QValueAxis::rangeChanged, this, &ChartWidget::scheduleDensityUpdate);
+    connect(m_axisY, &QValueAxis::rangeChanged, this, &ChartWidget::scheduleDensityUpdate);
+    connect(m_chart, &QChart::plotAreaChanged, this, &ChartWidget::scheduleDensityUpdate);
+    
+    // X轴联动
+    connect(m_axisX, &QValueAxis::rangeChanged, this, &ChartWidget::onXAxisRangeChanged);
 }
 
 ChartWidget::~ChartWidget()
 {
+    // 通知仍在运行的后台细化尽早结束
+    for (SeriesSpec &spec : m_seriesSpecs) {
+        if (spec.refineToken) {
+            spec.refineToken->storeRelease(1);
+        }
+        if (spec.spectrogramToken) {
+            spec.spectrogramToken->storeRelease(1);
+        }
+    }
 }
 
 void ChartWidget::setupToolbar()
@@ -138,43 +235,17 @@ void ChartWidget::setupToolbar()
     m_multiAxisCheckBox->setChecked(false);
     connect(m_multiAxisCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
         m_multiAxisMode = checked;
-        // 重新绘制图表
-        // 保存当前数据
-        QList<QPair<QString, QPair<QList<QPointF>, QPair<QColor, SeriesStyle>>>> seriesData;
-        for (QAbstractSeries *abstractSeries : m_chart->series()) {
-            QLineSeries *lineSeries = qobject_cast<QLineSeries*>(abstractSeries);
-            QScatterSeries *scatterSeries = qobject_cast<QScatterSeries*>(abstractSeries);
-            
-            if (lineSeries && !lineSeries->name().endsWith(" (点)")) {
-                QList<QPointF> points = lineSeries->points();
-                QColor color = lineSeries->color();
-                SeriesStyle style;
-                style.displayMode = SeriesDisplayMode::Line;
-                style.lineWidth = lineSeries->pen().width();
-                seriesData.append(qMakePair(lineSeries->name(), qMakePair(points, qMakePair(color, style))));
-            } else if (scatterSeries && !scatterSeries->name().endsWith(" (点)")) {
-                QList<QPointF> points = scatterSeries->points();
-                QColor color = scatterSeries->color();
-                SeriesStyle style;
-                style.displayMode = SeriesDisplayMode::Scatter;
-                style.scatterSize = scatterSeries->markerSize();
-                seriesData.append(qMakePair(scatterSeries->name(), qMakePair(points, qMakePair(color, style))));
-            }
-        }
-        
-        // 清除并重新添加
-        clearChart();
-        for (const auto &data : seriesData) {
-            QVector<double> xData, yData;
-            for (const QPointF &p : data.second.first) {
-                xData.append(p.x());
-                yData.append(p.y());
-            }
-            addSeries(data.first, xData, yData, data.second.second.first, data.second.second.second);
-        }
+        // 按系列规格重新分配Y轴，数据和样式保持不变
+        rebindAxes();
     });
     toolLayout->addWidget(m_multiAxisCheckBox);
     
+    // 概览条开关（概览条在图表创建后加入布局并连接）
+    m_overviewCheckBox = new QCheckBox("概览");
+    m_overviewCheckBox->setToolTip("在图表下方显示全部数据的概览，\n拖动其中的选框可快速定位视图");
+    m_overviewCheckBox->setChecked(true);
+    toolLayout->addWidget(m_overviewCheckBox);
+    
     // 分隔符
     QFrame *separator2 = new QFrame();
     separator2->setFrameShape(QFrame::VLine);
@@ -192,6 +263,13 @@ void ChartWidget::setupToolbar()
     
     toolLayout->addStretch();
     
+    // 后台细化提示：大数据量曲线先显示预览，完整数据就绪前显示
+    m_refineLabel = new QLabel("细化中…");
+    m_refineLabel->setToolTip("正在后台构建完整精度的曲线或时频图，当前显示的是预览");
+    m_refineLabel->setStyleSheet("color: gray;");
+    m_refineLabel->hide();
+    toolLayout->addWidget(m_refineLabel);
+    
     m_layout->addWidget(m_toolbar);
 }
 
@@ -201,73 +279,493 @@ void ChartWidget::addSeries(const QString &name,
                             const QColor &color,
                             const SeriesStyle &style)
 {
-    if (xData.isEmpty() || yData.isEmpty()) {
+    if (yData.isEmpty()) {
         return;
     }
     
-    int count = qMin(xData.size(), yData.size());
+    SeriesSpec spec;
+    spec.name = name;
+    spec.xData = xData;
+    spec.yData = yData;
+    spec.style = style;
     
     // 根据样式过滤和准备数据
-    QVector<double> filteredX, filteredY;
-    for (int i = 0; i < count; ++i) {
-        double y = yData[i];
-        
-        // 区间过滤
-        if (style.filterByRange) {
-            if (y < style.minValue || y > style.maxValue) {
-                continue;  // 跳过超出区间的点
+    prepareGeometry(spec);
+    if (spec.filteredY.isEmpty()) {
+        return;  // 过滤后没有数据
+    }
+    
+    // 确定使用的颜色
+    spec.color = color.isValid() ? color : getNextColor();
+    
+    // 创建图表对象并绑定坐标轴
+    buildChartSeries(spec);
+    attachYAxis(spec, m_seriesSpecs.size());
+    m_seriesSpecs.append(spec);
+    updateRefineIndicator();
+    
+    // 收集曲线统计信息
+    SeriesMarkerInfo markerInfo;
+    markerInfo.seriesName = name;
+    markerInfo.color = spec.color;
+    markerInfo.yMin = spec.yMin;
+    markerInfo.yMax = spec.yMax;
+    markerInfo.xMin = spec.xMin;
+    markerInfo.xMax = spec.xMax;
+    m_markerInfos.append(markerInfo);
+    
+    m_seriesCount++;
+    
+    // 更新坐标轴范围
+    updateAxisRanges();
+    scheduleDensityUpdate();
+}
+
+bool ChartWidget::setSeriesStyle(const QString &name, const SeriesStyle &style)
+{
+    int index = findSeriesSpec(name);
+    if (index < 0) {
+        return false;
+    }
+    
+    SeriesSpec &spec = m_seriesSpecs[index];
+    SeriesStyle oldStyle = spec.style;
+    spec.style = style;
+    
+    bool geometryChanged = oldStyle.displayMode != style.displayMode ||
+                           oldStyle.filterByRange != style.filterByRange ||
+                           (style.displayMode == SeriesDisplayMode::Envelope &&
+                            oldStyle.showMeanLine != style.showMeanLine) ||
+                           (style.filterByRange && (oldStyle.minValue != style.minValue ||
+                                                    oldStyle.maxValue != style.maxValue));
+    bool axisChanged = m_multiAxisMode && oldStyle.yAxisGroup != style.yAxisGroup;
+    
+    if (!geometryChanged) {
+        // 时频图参数只影响热力图层，按当前视图重新计算即可
+        if (style.displayMode == SeriesDisplayMode::Spectrogram &&
+            oldStyle.spectral != style.spectral) {
+            scheduleDensityUpdate();
+        }
+        // 只更新画笔和散点大小，不触碰数据
+        for (QAbstractSeries *series : spec.chartSeries) {
+            QScatterSeries *scatterSeries = qobject_cast<QScatterSeries*>(series);
+            QLineSeries *lineSeries = qobject_cast<QLineSeries*>(series);
+            if (scatterSeries) {
+                scatterSeries->setMarkerSize(style.scatterSize);
+            } else if (lineSeries) {
+                QPen pen = lineSeries->pen();
+                pen.setWidth(style.lineWidth);
+                lineSeries->setPen(pen);
             }
         }
-        
-        filteredX.append(xData[i]);
-        filteredY.append(y);
+        if (axisChanged) {
+            rebindAxes();
+        }
+        return true;
     }
     
-    if (filteredX.isEmpty()) {
-        return;  // 过滤后没有数据
+    // 显示模式或过滤条件变化：用已有的源数据重建该曲线
+    rebuildSeries(index, axisChanged);
+    return true;
+}
+
+bool ChartWidget::setSeriesData(const QString &name,
+                                const QVector<double> &xData,
+                                const QVector<double> &yData)
+{
+    int index = findSeriesSpec(name);
+    if (index < 0) {
+        return false;
     }
     
-    // 确定使用的颜色
-    QColor seriesColor = color.isValid() ? color : getNextColor();
+    SeriesSpec &spec = m_seriesSpecs[index];
+    if (isSameBuffer(spec.xData, xData) && isSameBuffer(spec.yData, yData)) {
+        return true;  // 数据未变（共享同一份存储）
+    }
+    spec.xData = xData;
+    spec.yData = yData;
+    rebuildSeries(index, false);
+    return true;
+}
+
+bool ChartWidget::removeSeries(const QString &name)
+{
+    int index = findSeriesSpec(name);
+    if (index < 0) {
+        return false;
+    }
+    removeSeriesAt(index);
+    return true;
+}
+
+QStringList ChartWidget::seriesNames() const
+{
+    QStringList names;
+    for (const SeriesSpec &spec : m_seriesSpecs) {
+        names.append(spec.name);
+    }
+    return names;
+}
+
+void ChartWidget::rebuildSeries(int index, bool axisChanged)
+{
+    SeriesSpec &spec = m_seriesSpecs[index];
+    QValueAxis *yAxis = spec.yAxis;
+    destroyChartSeries(spec);
+    prepareGeometry(spec);
+    
+    if (spec.filteredY.isEmpty()) {
+        // 与 addSeries 一致：过滤后没有数据的曲线不保留在图表中
+        removeSeriesAt(index);
+        return;
+    }
     
-    // 确定使用的Y轴
-    QValueAxis *yAxisToUse = m_axisY;
+    buildChartSeries(spec);
+    if (axisChanged) {
+        rebindAxes();
+    } else {
+        spec.yAxis = yAxis;
+        for (QAbstractSeries *series : spec.chartSeries) {
+            series->attachAxis(yAxis);
+        }
+        updateAxisRanges();
+    }
+    
+    // 同步标记信息中的统计值
+    for (SeriesMarkerInfo &info : m_markerInfos) {
+        if (info.seriesName == spec.name) {
+            info.xMin = spec.xMin;
+            info.xMax = spec.xMax;
+            info.yMin = spec.yMin;
+            info.yMax = spec.yMax;
+            break;
+        }
+    }
+    updateMarkerLines();
+    scheduleDensityUpdate();
+}
+
+void ChartWidget::removeSeriesAt(int index)
+{
+    SeriesSpec &spec = m_seriesSpecs[index];
+    for (int i = 0; i < m_markerInfos.size(); ++i) {
+        if (m_markerInfos[i].seriesName == spec.name) {
+            m_markerInfos.removeAt(i);
+            break;
+        }
+    }
+    cancelRefinement(spec);
+    destroyChartSeries(spec);
+    m_seriesSpecs.removeAt(index);
+    
+    if (m_seriesSpecs.isEmpty()) {
+        clearChart();
+        return;
+    }
+    
+    // 多Y轴模式下被移除曲线的独立Y轴需要回收
     if (m_multiAxisMode) {
-        // 多Y轴模式：根据Y轴分组决定是否共享Y轴
-        int groupId = style.yAxisGroup;
+        rebindAxes();
+    } else {
+        updateAxisRanges();
+        scheduleDensityUpdate();
+    }
+    updateMarkerLines();
+}
+
+void ChartWidget::prepareGeometry(SeriesSpec &spec)
+{
+    const int count = XValues::count(spec.xData, spec.yData);
+    const SeriesStyle &style = spec.style;
+    
+    // 新的几何数据取代尚未完成的后台构建
+    cancelRefinement(spec);
+    
+    // 相同数据和过滤条件已处理过时直接复用（切换X轴、重新应用预设等）
+    GeometryCache &cache = GeometryCache::instance();
+    PreparedGeometry geometry;
+    if (cache.find(spec.xData, spec.yData, style.filterByRange,
+                   style.minValue, style.maxValue, geometry)) {
+        applyGeometry(spec, geometry);
+        return;
+    }
+    
+    if (count >= kProgressiveMinPoints) {
+        // 大数据量：先显示抽样预览，完整几何数据在后台构建完成后替换
+        geometry = GeometryCache::buildPreview(spec.xData, spec.yData, style.filterByRange,
+                                               style.minValue, style.maxValue, kPreviewPoints);
+        if (!geometry.filteredY.isEmpty()) {
+            applyGeometry(spec, geometry);
+            startRefinement(spec);
+            return;
+        }
+        // 预览被全部过滤掉时无法判断完整数据是否为空，退回同步构建
+    }
+    
+    geometry = GeometryCache::build(spec.xData, spec.yData, style.filterByRange,
+                                    style.minValue, style.maxValue);
+    cache.insert(spec.xData, spec.yData, style.filterByRange,
+                 style.minValue, style.maxValue, geometry);
+    applyGeometry(spec, geometry);
+}
+
+void ChartWidget::applyGeometry(SeriesSpec &spec, const PreparedGeometry &geometry)
+{
+    spec.filteredX = geometry.filteredX;
+    spec.filteredY = geometry.filteredY;
+    spec.breakCount = geometry.breakCount;
+    spec.xMin = geometry.xMin;
+    spec.xMax = geometry.xMax;
+    spec.yMin = geometry.yMin;
+    spec.yMax = geometry.yMax;
+    spec.xSorted = geometry.xSorted;
+    spec.lod = geometry.lod;
+    
+    // 时频图的Y轴为频率：0 到奈奎斯特频率
+    if (spec.style.displayMode == SeriesDisplayMode::Spectrogram) {
+        spec.sampleRate = SpectralAnalyzer::sampleRate(spec.xData, spec.yData.size());
+        spec.yMin = 0;
+        spec.yMax = spec.sampleRate > 0 ? spec.sampleRate / 2 : 1;
+    }
+}
+
+void ChartWidget::startRefinement(SeriesSpec &spec)
+{
+    QSharedPointer<QAtomicInt> cancel(new QAtomicInt(0));
+    spec.refineToken = cancel;
+    spec.refinedGeometry.reset();
+    
+    QPointer<ChartWidget> self(this);
+    const QVector<double> xData = spec.xData;
+    const QVector<double> yData = spec.yData;
+    const bool filterByRange = spec.style.filterByRange;
+    const double minValue = spec.style.minValue;
+    const double maxValue = spec.style.maxValue;
+    QThreadPool::globalInstance()->start([=]() {
+        if (cancel->loadAcquire()) {
+            return;
+        }
+        QSharedPointer<PreparedGeometry> geometry(new PreparedGeometry(
+            GeometryCache::build(xData, yData, filterByRange, minValue, maxValue, cancel.data())));
+        if (cancel->loadAcquire()) {
+            return;
+        }
+        // 回到GUI线程替换预览
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, cancel, geometry]() {
+            if (self && !cancel->loadAcquire()) {
+                self->onRefinementReady(cancel, geometry);
+            }
+        }, Qt::QueuedConnection);
+    });
+    updateRefineIndicator();
+}
+
+void ChartWidget::cancelRefinement(SeriesSpec &spec)
+{
+    if (spec.refineToken) {
+        spec.refineToken->storeRelease(1);
+        spec.refineToken.reset();
+        spec.refinedGeometry.reset();
+        updateRefineIndicator();
+    }
+}
+
+void ChartWidget::onRefinementReady(const QSharedPointer<QAtomicInt> &token,
+                                    const QSharedPointer<PreparedGeometry> &geometry)
+{
+    for (SeriesSpec &spec : m_seriesSpecs) {
+        if (spec.refineToken == token) {
+            spec.refinedGeometry = geometry;
+            break;
+        }
+    }
+    
+    // 拖拽/缩放进行中不重建曲线，交互结束后再替换
+    if (!m_chartView->isInteracting()) {
+        applyRefinedGeometry();
+    }
+}
+
+void ChartWidget::applyRefinedGeometry()
+{
+    // 视图仍为数据全范围时，替换后按完整数据重新计算坐标轴范围；用户已缩放则保持视图
+    bool viewAtDataExtent = m_axisX->min() == m_originalXMin && m_axisX->max() == m_originalXMax &&
+                            (m_multiAxisMode || (m_axisY->min() == m_originalYMin &&
+                                                 m_axisY->max() == m_originalYMax));
+    bool changed = false;
+    
+    for (int i = m_seriesSpecs.size() - 1; i >= 0; --i) {
+        SeriesSpec &spec = m_seriesSpecs[i];
+        if (!spec.refineToken || !spec.refinedGeometry) {
+            continue;
+        }
+        const PreparedGeometry geometry = *spec.refinedGeometry;
+        spec.refineToken.reset();
+        spec.refinedGeometry.reset();
+        GeometryCache::instance().insert(spec.xData, spec.yData, spec.style.filterByRange,
+                                         spec.style.minValue, spec.style.maxValue, geometry);
         
-        if (groupId == 0) {
-            // 组号为0表示独立Y轴，为每个系列创建新的Y轴
-            yAxisToUse = new QValueAxis();
-            yAxisToUse->setTitleText(name);
-            yAxisToUse->setLinePenColor(seriesColor);
-            yAxisToUse->setLabelsColor(seriesColor);
-            
-            // 交替使用左右两侧
-            Qt::Alignment alignment = (m_seriesCount % 2 == 0) ? Qt::AlignLeft : Qt::AlignRight;
-            m_chart->addAxis(yAxisToUse, alignment);
-            
-            m_extraYAxes.append(yAxisToUse);
+        if (geometry.filteredY.isEmpty()) {
+            removeSeriesAt(i);
+            continue;
+        }
+        
+        QValueAxis *yAxis = spec.yAxis;
+        destroyChartSeries(spec);
+        applyGeometry(spec, geometry);
+        buildChartSeries(spec);
+        spec.yAxis = yAxis;
+        for (QAbstractSeries *series : spec.chartSeries) {
+            series->attachAxis(yAxis);
+        }
+        
+        for (SeriesMarkerInfo &info : m_markerInfos) {
+            if (info.seriesName == spec.name) {
+                info.xMin = spec.xMin;
+                info.xMax = spec.xMax;
+                info.yMin = spec.yMin;
+                info.yMax = spec.yMax;
+                break;
+            }
+        }
+        changed = true;
+    }
+    
+    if (changed) {
+        if (viewAtDataExtent) {
+            updateAxisRanges();
         } else {
-            // 非0组号：查找是否已有相同组号的Y轴
-            if (m_yAxisGroups.contains(groupId)) {
-                // 使用已存在的组Y轴
-                yAxisToUse = m_yAxisGroups[groupId];
-            } else {
-                // 创建新的组Y轴
-                yAxisToUse = new QValueAxis();
-                yAxisToUse->setTitleText(QString("[组%1] %2").arg(groupId).arg(name));
-                yAxisToUse->setLinePenColor(seriesColor);
-                yAxisToUse->setLabelsColor(seriesColor);
-                
-                // 交替使用左右两侧
-                Qt::Alignment alignment = (m_yAxisGroups.size() % 2 == 0) ? Qt::AlignLeft : Qt::AlignRight;
-                m_chart->addAxis(yAxisToUse, alignment);
-                
-                m_extraYAxes.append(yAxisToUse);
-                m_yAxisGroups[groupId] = yAxisToUse;
+            updateOverview();
+        }
+        updateMarkerLines();
+        scheduleLodUpdate();
+        scheduleDensityUpdate();
+    }
+    updateRefineIndicator();
+}
+
+void ChartWidget::updateRefineIndicator()
+{
+    bool refining = false;
+    for (const SeriesSpec &spec : m_seriesSpecs) {
+        if (spec.refineToken || spec.spectrogramToken) {
+            refining = true;
+            break;
+        }
+    }
+    m_refineLabel->setVisible(refining);
+}
+
+void ChartWidget::startSpectrogram(SeriesSpec &spec, const QRectF &plotArea, int width, int height)
+{
+    cancelSpectrogram(spec);
+    if (width <= 0 || height <= 0 || spec.sampleRate <= 0) {
+        spec.densityItem->setImage(QImage(), plotArea);
+        return;
+    }
+    
+    QSharedPointer<QAtomicInt> cancel(new QAtomicInt(0));
+    spec.spectrogramToken = cancel;
+    
+    QPointer<ChartWidget> self(this);
+    const QVector<double> xData = spec.xData;
+    const QVector<double> yData = spec.yData;
+    const SpectralSettings settings = spec.style.spectral;
+    const double xMin = m_axisX->min();
+    const double xMax = m_axisX->max();
+    const double fMin = spec.yAxis->min();
+    const double fMax = spec.yAxis->max();
+    QThreadPool::globalInstance()->start([=]() {
+        // 第一遍每列只取一段，缩小视图时也能很快出图；第二遍每列平均更多段
+        const int framesPerColumn[] = {1, kSpectrogramFramesPerColumn};
+        for (int pass = 0; pass < 2; ++pass) {
+            bool exhaustive = false;
+            QImage image = SpectrogramRenderer::render(xData, yData, settings, xMin, xMax, fMin, fMax,
+                                                       width, height, framesPerColumn[pass],
+                                                       &exhaustive, cancel.data());
+            if (cancel->loadAcquire()) {
+                return;
             }
+            // 第一遍已覆盖全部段时无需细化
+            const bool finished = pass == 1 || exhaustive;
+            QMetaObject::invokeMethod(QCoreApplication::instance(),
+                                      [self, cancel, image, plotArea, finished]() {
+                if (self && !cancel->loadAcquire()) {
+                    self->onSpectrogramReady(cancel, image, plotArea, finished);
+                }
+            }, Qt::QueuedConnection);
+            if (finished) {
+                return;
+            }
+        }
+    });
+    updateRefineIndicator();
+}
+
+void ChartWidget::cancelSpectrogram(SeriesSpec &spec)
+{
+    if (spec.spectrogramToken) {
+        spec.spectrogramToken->storeRelease(1);
+        spec.spectrogramToken.reset();
+        updateRefineIndicator();
+    }
+}
+
+void ChartWidget::onSpectrogramReady(const QSharedPointer<QAtomicInt> &token, const QImage &image,
+                                     const QRectF &plotArea, bool finished)
+{
+    for (SeriesSpec &spec : m_seriesSpecs) {
+        if (spec.spectrogramToken != token) {
+            continue;
+        }
+        if (spec.densityItem) {
+            spec.densityItem->setImage(image, plotArea);
+        }
+        if (finished) {
+            spec.spectrogramToken.reset();
+            updateRefineIndicator();
         }
+        break;
+    }
+}
+
+void ChartWidget::buildChartSeries(SeriesSpec &spec)
+{
+    const SeriesStyle &style = spec.style;
+    const QColor &seriesColor = spec.color;
+    
+    // 一次性批量填充，避免逐点 append 触发信号
+    // 折线保留分隔点（由 applyLinePoints 断开），散点去掉分隔点
+    const XValues px(spec.filteredX);
+    const int pointCount = spec.filteredY.size();
+    QVector<QPointF> linePoints;
+    bool needLinePoints = (style.displayMode == SeriesDisplayMode::Line ||
+                           style.displayMode == SeriesDisplayMode::LineAndScatter) && !usesLod(spec);
+    bool needScatterPoints = style.displayMode == SeriesDisplayMode::Scatter ||
+                             style.displayMode == SeriesDisplayMode::LineAndScatter;
+    if (needLinePoints || (needScatterPoints && spec.breakCount == 0)) {
+        linePoints.resize(pointCount);
+        for (int i = 0; i < pointCount; ++i) {
+            linePoints[i] = QPointF(px[i], spec.filteredY[i]);
+        }
+    }
+    QVector<QPointF> points;
+    if (needScatterPoints) {
+        if (spec.breakCount == 0) {
+            points = linePoints;
+        } else {
+            points.reserve(pointCount - spec.breakCount);
+            for (int i = 0; i < pointCount; ++i) {
+                if (!RangeFilter::isBreak(spec.filteredY[i])) {
+                    points.append(QPointF(px[i], spec.filteredY[i]));
+                }
+            }
+        }
+    }
+    
+    // 大数据量折线只放入按视图降采样的点，视图变化后由 updateLodSeries 更新
+    if (usesLod(spec)) {
+        linePoints = spec.lod->envelope(spec.xMin, spec.xMax, kLodInitialColumns);
     }
     
     // 根据显示模式创建不同类型的Series
@@ -275,41 +773,29 @@ void ChartWidget::addSeries(const QString &name,
         case SeriesDisplayMode::Line: {
             // 连线模式
             QLineSeries *series = new QLineSeries();
-            series->setName(name);
-            
-            for (int i = 0; i < filteredX.size(); ++i) {
-                series->append(filteredX[i], filteredY[i]);
-            }
-            
+            series->setName(spec.name);
             series->setColor(seriesColor);
             
             QPen pen = series->pen();
             pen.setWidth(style.lineWidth);
             series->setPen(pen);
             
-            m_chart->addSeries(series);
-            series->attachAxis(m_axisX);
-            series->attachAxis(yAxisToUse);
+            spec.chartSeries.append(series);
+            applyLinePoints(spec, linePoints);
             break;
         }
         
         case SeriesDisplayMode::Scatter: {
             // 散点模式
             QScatterSeries *series = new QScatterSeries();
-            series->setName(name);
-            
-            for (int i = 0; i < filteredX.size(); ++i) {
-                series->append(filteredX[i], filteredY[i]);
-            }
-            
+            series->setName(spec.name);
+            series->replace(points);
             series->setColor(seriesColor);
             series->setMarkerSize(style.scatterSize);
             series->setMarkerShape(QScatterSeries::MarkerShapeCircle);
             series->setBorderColor(seriesColor);
             
-            m_chart->addSeries(series);
-            series->attachAxis(m_axisX);
-            series->attachAxis(yAxisToUse);
+            spec.chartSeries.append(series);
             break;
         }
         
@@ -317,174 +803,529 @@ void ChartWidget::addSeries(const QString &name,
             // 连线+散点模式
             // 先添加连线
             QLineSeries *lineSeries = new QLineSeries();
-            lineSeries->setName(name);
-            
-            for (int i = 0; i < filteredX.size(); ++i) {
-                lineSeries->append(filteredX[i], filteredY[i]);
-            }
-            
+            lineSeries->setName(spec.name);
             lineSeries->setColor(seriesColor);
             
             QPen pen = lineSeries->pen();
             pen.setWidth(style.lineWidth);
             lineSeries->setPen(pen);
             
-            m_chart->addSeries(lineSeries);
-            lineSeries->attachAxis(m_axisX);
-            lineSeries->attachAxis(yAxisToUse);
-            
             // 再添加散点（不显示在图例中）
             QScatterSeries *scatterSeries = new QScatterSeries();
-            scatterSeries->setName(name + " (点)");
-            
-            for (int i = 0; i < filteredX.size(); ++i) {
-                scatterSeries->append(filteredX[i], filteredY[i]);
-            }
-            
+            scatterSeries->setName(spec.name + " (点)");
+            scatterSeries->replace(points);
             scatterSeries->setColor(seriesColor);
             scatterSeries->setMarkerSize(style.scatterSize);
             scatterSeries->setMarkerShape(QScatterSeries::MarkerShapeCircle);
             scatterSeries->setBorderColor(seriesColor);
             
-            m_chart->addSeries(scatterSeries);
-            scatterSeries->attachAxis(m_axisX);
-            scatterSeries->attachAxis(yAxisToUse);
+            spec.chartSeries.append(lineSeries);
+            spec.chartSeries.append(scatterSeries);
+            applyLinePoints(spec, linePoints);
+            break;
+        }
+        
+        case SeriesDisplayMode::Density: {
+            // 密度热力图模式：图例使用没有数据点的占位系列，
+            // 实际内容由绘图区域内的热力图项按屏幕分辨率分箱绘制
+            QScatterSeries *series = new QScatterSeries();
+            series->setName(spec.name);
+            series->setColor(seriesColor);
+            series->setBorderColor(seriesColor);
+            
+            spec.densityItem = new DensityMapItem(m_chart);
+            spec.densityItem->setZValue(0.5);  // 位于绘图区背景之上、网格线之下
+            
+            spec.chartSeries.append(series);
+            break;
+        }
+        
+        case SeriesDisplayMode::Spectrogram: {
+            // 时频图模式：与密度模式相同，使用占位系列显示图例，
+            // 热力图层按视图在后台计算（X为时间，Y为频率）
+            QScatterSeries *series = new QScatterSeries();
+            series->setName(spec.name);
+            series->setColor(seriesColor);
+            series->setBorderColor(seriesColor);
+            
+            spec.densityItem = new DensityMapItem(m_chart);
+            spec.densityItem->setZValue(0.5);
             
-            // 隐藏散点的图例
-            m_chart->legend()->markers(scatterSeries).first()->setVisible(false);
+            spec.chartSeries.append(series);
             break;
         }
+        
+        case SeriesDisplayMode::Envelope: {
+            // 包络带模式：上下边界为每个像素列的最大/最小值，
+            // 由LOD金字塔按视图生成，绘制开销只与绘图区宽度有关
+            QAreaSeries *area = new QAreaSeries();
+            area->setName(spec.name);
+            area->setUpperSeries(new QLineSeries(area));
+            area->setLowerSeries(new QLineSeries(area));
+            QColor fillColor = seriesColor;
+            fillColor.setAlpha(90);
+            area->setColor(fillColor);
+            area->setBorderColor(seriesColor);
+            spec.chartSeries.append(area);
+            
+            if (style.showMeanLine) {
+                QLineSeries *meanSeries = new QLineSeries();
+                meanSeries->setName(spec.name + " (均值)");
+                meanSeries->setColor(seriesColor.darker(150));
+                QPen pen = meanSeries->pen();
+                pen.setWidth(style.lineWidth);
+                meanSeries->setPen(pen);
+                spec.chartSeries.append(meanSeries);
+            }
+            
+            if (spec.lod) {
+                applyLodGeometry(spec, spec.xMin, spec.xMax, kLodInitialColumns);
+            } else {
+                // X无序时无法按列聚合，退化为上下边界重合的折线
+                QVector<QPointF> rawPoints(pointCount);
+                for (int i = 0; i < pointCount; ++i) {
+                    rawPoints[i] = QPointF(px[i], spec.filteredY[i]);
+                }
+                area->upperSeries()->replace(rawPoints);
+                area->lowerSeries()->replace(rawPoints);
+            }
+            break;
+        }
+    }
+    
+    for (QAbstractSeries *series : spec.chartSeries) {
+        m_chart->addSeries(series);
+        series->attachAxis(m_axisX);
+    }
+    
+    // 附属系列（如连线+散点中的散点）不显示图例
+    for (int i = 1; i < spec.chartSeries.size(); ++i) {
+        auto markers = m_chart->legend()->markers(spec.chartSeries[i]);
+        if (!markers.isEmpty()) {
+            markers.first()->setVisible(false);
+        }
+    }
+}
+
+void ChartWidget::destroyChartSeries(SeriesSpec &spec)
+{
+    for (QAbstractSeries *series : spec.chartSeries) {
+        m_chart->removeSeries(series);
+        delete series;
+    }
+    spec.chartSeries.clear();
+    spec.segmentSeries.clear();
+    
+    cancelSpectrogram(spec);
+    delete spec.densityItem;
+    spec.densityItem = nullptr;
+    spec.yAxis = nullptr;
+}
+
+void ChartWidget::attachYAxis(SeriesSpec &spec, int index)
+{
+    // 确定使用的Y轴
+    QValueAxis *yAxisToUse = m_axisY;
+    if (m_multiAxisMode) {
+        // 多Y轴模式：根据Y轴分组决定是否共享Y轴
+        int groupId = spec.style.yAxisGroup;
+        
+        if (groupId == 0) {
+            // 组号为0表示独立Y轴，为每个系列创建新的Y轴
+            yAxisToUse = new QValueAxis();
+            yAxisToUse->setTitleText(spec.name);
+            yAxisToUse->setLinePenColor(spec.color);
+            yAxisToUse->setLabelsColor(spec.color);
+            
+            // 交替使用左右两侧
+            Qt::Alignment alignment = (index % 2 == 0) ? Qt::AlignLeft : Qt::AlignRight;
+            m_chart->addAxis(yAxisToUse, alignment);
+            
+            m_extraYAxes.append(yAxisToUse);
+        } else if (m_yAxisGroups.contains(groupId)) {
+            // 使用已存在的组Y轴
+            yAxisToUse = m_yAxisGroups[groupId];
+        } else {
+            // 创建新的组Y轴
+            yAxisToUse = new QValueAxis();
+            yAxisToUse->setTitleText(QString("[组%1] %2").arg(groupId).arg(spec.name));
+            yAxisToUse->setLinePenColor(spec.color);
+            yAxisToUse->setLabelsColor(spec.color);
+            
+            // 交替使用左右两侧
+            Qt::Alignment alignment = (m_yAxisGroups.size() % 2 == 0) ? Qt::AlignLeft : Qt::AlignRight;
+            m_chart->addAxis(yAxisToUse, alignment);
+            
+            m_extraYAxes.append(yAxisToUse);
+            m_yAxisGroups[groupId] = yAxisToUse;
+        }
+        
+        // 密度图层需要随独立Y轴的范围变化重新分箱
+        connect(yAxisToUse, &QValueAxis::rangeChanged,
+                this, &ChartWidget::scheduleDensityUpdate, Qt::UniqueConnection);
+    }
+    
+    spec.yAxis = yAxisToUse;
+    for (QAbstractSeries *series : spec.chartSeries) {
+        series->attachAxis(yAxisToUse);
+    }
+}
+
+void ChartWidget::rebindAxes()
+{
+    // 移除所有额外的Y轴（移除时会自动与系列解除绑定）
+    for (QValueAxis *axis : m_extraYAxes) {
+        m_chart->removeAxis(axis);
+        delete axis;
+    }
+    m_extraYAxes.clear();
+    m_yAxisGroups.clear();
+    
+    for (int i = 0; i < m_seriesSpecs.size(); ++i) {
+        SeriesSpec &spec = m_seriesSpecs[i];
+        if (spec.yAxis == m_axisY) {
+            for (QAbstractSeries *series : spec.chartSeries) {
+                series->detachAxis(m_axisY);
+            }
+        }
+        attachYAxis(spec, i);
+    }
+    
+    updateAxisRanges();
+    scheduleDensityUpdate();
+}
+
+void ChartWidget::rebuildAxisInfos()
+{
+    m_seriesAxisInfos.clear();
+    
+    for (const SeriesSpec &spec : m_seriesSpecs) {
+        bool merged = false;
+        for (SeriesAxisInfo &info : m_seriesAxisInfos) {
+            if (info.yAxis == spec.yAxis) {
+                // 同组系列共享Y轴，取范围的并集
+                info.yMin = qMin(info.yMin, spec.yMin);
+                info.yMax = qMax(info.yMax, spec.yMax);
+                merged = true;
+                break;
+            }
+        }
+        
+        if (!merged) {
+            SeriesAxisInfo info;
+            info.seriesName = spec.name;
+            info.yAxis = spec.yAxis;
+            info.yMin = spec.yMin;
+            info.yMax = spec.yMax;
+            m_seriesAxisInfos.append(info);
+        }
+    }
+}
+
+int ChartWidget::findSeriesSpec(const QString &name) const
+{
+    for (int i = 0; i < m_seriesSpecs.size(); ++i) {
+        if (m_seriesSpecs[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool ChartWidget::usesLod(const SeriesSpec &spec) const
+{
+    if (!spec.lod) {
+        return false;
+    }
+    if (spec.style.displayMode == SeriesDisplayMode::Envelope) {
+        return true;  // 包络带始终按列聚合
+    }
+    if (!spec.xSorted || spec.lod->size() <= kLodMinPoints) {
+        return false;  // X无序的折线按原顺序连接，不能按X列聚合
+    }
+    return spec.style.displayMode == SeriesDisplayMode::Line ||
+           spec.style.displayMode == SeriesDisplayMode::LineAndScatter;
+}
+
+void ChartWidget::applyLodGeometry(SeriesSpec &spec, double xMin, double xMax, int columns)
+{
+    if (!spec.lod || spec.chartSeries.isEmpty()) {
+        return;
     }
     
-    // 收集曲线统计信息
-    SeriesMarkerInfo markerInfo;
-    markerInfo.seriesName = name;
-    markerInfo.color = seriesColor;
-    markerInfo.yMin = std::numeric_limits<double>::max();
-    markerInfo.yMax = std::numeric_limits<double>::lowest();
-    markerInfo.xMin = std::numeric_limits<double>::max();
-    markerInfo.xMax = std::numeric_limits<double>::lowest();
+    if (spec.style.displayMode != SeriesDisplayMode::Envelope) {
+        applyLinePoints(spec, spec.lod->envelope(xMin, xMax, columns));
+        return;
+    }
     
-    for (int i = 0; i < filteredX.size(); ++i) {
-        markerInfo.xMin = qMin(markerInfo.xMin, filteredX[i]);
-        markerInfo.xMax = qMax(markerInfo.xMax, filteredX[i]);
-        markerInfo.yMin = qMin(markerInfo.yMin, filteredY[i]);
-        markerInfo.yMax = qMax(markerInfo.yMax, filteredY[i]);
+    QAreaSeries *area = qobject_cast<QAreaSeries*>(spec.chartSeries.first());
+    if (!area) {
+        return;
+    }
+    QLineSeries *meanSeries = spec.chartSeries.size() > 1
+                              ? qobject_cast<QLineSeries*>(spec.chartSeries[1]) : nullptr;
+    
+    const QVector<LodPyramid::Column> cols = spec.lod->aggregate(xMin, xMax, columns, true);
+    QVector<QPointF> upper, lower, mean;
+    upper.reserve(cols.size());
+    lower.reserve(cols.size());
+    if (meanSeries) {
+        mean.reserve(cols.size());
+    }
+    for (const LodPyramid::Column &c : cols) {
+        if (c.count == 0) {
+            continue;
+        }
+        upper.append(QPointF(c.x, c.max));
+        lower.append(QPointF(c.x, c.min));
+        if (meanSeries) {
+            mean.append(QPointF(c.x, c.mean()));
+        }
+    }
+    area->upperSeries()->replace(upper);
+    area->lowerSeries()->replace(lower);
+    if (meanSeries) {
+        meanSeries->replace(mean);
+    }
+}
+
+void ChartWidget::applyLinePoints(SeriesSpec &spec, const QVector<QPointF> &points)
+{
+    QLineSeries *primary = spec.chartSeries.isEmpty()
+                           ? nullptr : qobject_cast<QLineSeries*>(spec.chartSeries.first());
+    if (!primary) {
+        return;
     }
     
-    m_markerInfos.append(markerInfo);
+    if (spec.breakCount == 0 && spec.segmentSeries.isEmpty()) {
+        primary->replace(points);  // 没有间断：直接整体替换
+        return;
+    }
     
-    // 保存系列轴信息
-    if (m_multiAxisMode) {
-        SeriesAxisInfo axisInfo;
-        axisInfo.seriesName = name;
-        axisInfo.yAxis = yAxisToUse;
-        axisInfo.yMin = markerInfo.yMin;
-        axisInfo.yMax = markerInfo.yMax;
-        m_seriesAxisInfos.append(axisInfo);
+    const QList<QVector<QPointF>> segments = RangeFilter::splitSegments(points, kMaxLineSegments);
+    primary->replace(segments.isEmpty() ? QVector<QPointF>() : segments.first());
+    
+    for (int i = 1; i < segments.size(); ++i) {
+        if (i - 1 >= spec.segmentSeries.size()) {
+            // 按需创建附加段，外观和坐标轴与主折线一致
+            QLineSeries *segment = new QLineSeries();
+            segment->setName(spec.name);
+            segment->setColor(primary->color());
+            segment->setPen(primary->pen());
+            spec.segmentSeries.append(segment);
+            spec.chartSeries.append(segment);
+            if (primary->chart()) {
+                m_chart->addSeries(segment);
+                for (QAbstractAxis *axis : primary->attachedAxes()) {
+                    segment->attachAxis(axis);
+                }
+                auto markers = m_chart->legend()->markers(segment);
+                if (!markers.isEmpty()) {
+                    markers.first()->setVisible(false);
+                }
+            }
+        }
+        spec.segmentSeries[i - 1]->replace(segments[i]);
     }
     
-    m_seriesCount++;
+    // 多余的段清空保留，视图再次变化时复用
+    for (int i = qMax(0, segments.size() - 1); i < spec.segmentSeries.size(); ++i) {
+        if (spec.segmentSeries[i]->count() > 0) {
+            spec.segmentSeries[i]->clear();
+        }
+    }
+}
+
+bool ChartWidget::valueAt(const SeriesSpec &spec, double x, double &y) const
+{
+    const int n = spec.filteredY.size();
+    if (n == 0 || !spec.lod) {
+        return false;
+    }
     
-    // 更新坐标轴范围
-    updateAxisRanges();
+    if (!spec.xSorted) {
+        // X无序：在排序后的副本上二分查找X最接近的点
+        const QVector<double> &sortedX = spec.lod->xData();
+        const int right = static_cast<int>(spec.lod->lowerBound(x));
+        int nearest = qMin(right, sortedX.size() - 1);
+        if (right > 0 && (right >= sortedX.size() || x - sortedX[right - 1] <= sortedX[right] - x)) {
+            nearest = right - 1;
+        }
+        y = spec.lod->yData()[nearest];
+        return true;
+    }
+    
+    const XValues px(spec.filteredX);
+    const double *py = spec.filteredY.constData();
+    int right = static_cast<int>(spec.lod->lowerBound(x));
+    if (right <= 0 || right >= n) {
+        int edge = qBound(0, right, n - 1);
+        y = py[edge];
+        return !RangeFilter::isBreak(y);
+    }
+    int left = right - 1;
+    if (RangeFilter::isBreak(py[left]) || RangeFilter::isBreak(py[right])) {
+        return false;  // 位于间断内
+    }
+    double span = px[right] - px[left];
+    double t = span > 0 ? (x - px[left]) / span : 0.0;
+    y = py[left] + t * (py[right] - py[left]);
+    return true;
+}
+
+ChartWidget::BucketQuery ChartWidget::queryBucket(QAbstractSeries *series, double xValue,
+                                                  LodPyramid::Column &column) const
+{
+    for (const SeriesSpec &spec : m_seriesSpecs) {
+        int index = spec.chartSeries.indexOf(series);
+        if (index < 0) {
+            continue;
+        }
+        if (spec.segmentSeries.contains(qobject_cast<QLineSeries*>(series))) {
+            return BucketQuery::Hidden;  // 折线的后续段由主折线统一显示
+        }
+        // X无序的曲线在排序后的副本上按像素列统计，图表中的点按原顺序排列，不能二分查找
+        bool columnQuery = usesLod(spec) || (!spec.xSorted && spec.lod);
+        if (!columnQuery) {
+            // 有间断的折线：在完整数据上插值，主折线只持有第一段
+            bool isLine = index == 0 && (spec.style.displayMode == SeriesDisplayMode::Line ||
+                                         spec.style.displayMode == SeriesDisplayMode::LineAndScatter);
+            if (!isLine || spec.segmentSeries.isEmpty()) {
+                return BucketQuery::NotAggregated;
+            }
+            double y = 0.0;
+            if (!valueAt(spec, xValue, y)) {
+                return BucketQuery::Hidden;
+            }
+            column = LodPyramid::Column();
+            column.x = xValue;
+            column.min = column.max = column.sum = y;
+            column.count = 1;
+            column.firstIndex = column.lastIndex = 0;
+            return BucketQuery::Aggregated;
+        }
+        if (index > 0) {
+            // 包络带的均值线、连线+散点中的散点由主系列统一显示
+            return spec.style.displayMode == SeriesDisplayMode::Envelope || !spec.xSorted
+                   ? BucketQuery::Hidden : BucketQuery::NotAggregated;
+        }
+        
+        // 鼠标所在的一个物理像素列对应的X区间
+        double plotWidth = m_chart->plotArea().width() * devicePixelRatioF();
+        if (plotWidth <= 0) {
+            return BucketQuery::NotAggregated;
+        }
+        double halfWidth = (m_axisX->max() - m_axisX->min()) / plotWidth / 2;
+        column = spec.lod->summarize(spec.lod->lowerBound(xValue - halfWidth),
+                                     spec.lod->upperBound(xValue + halfWidth));
+        if (column.count == 0) {
+            // 像素列内没有点时取最近的点
+            qint64 nearest = qMin(spec.lod->lowerBound(xValue), spec.lod->size() - 1);
+            column = spec.lod->summarize(nearest, nearest + 1);
+            if (column.count == 0) {
+                return BucketQuery::Hidden;  // 位于间断内
+            }
+        }
+        return BucketQuery::Aggregated;
+    }
+    return BucketQuery::NotAggregated;
+}
+
+void ChartWidget::updateOverview()
+{
+    QList<OverviewSeries> overviewSeries;
+    for (const SeriesSpec &spec : m_seriesSpecs) {
+        if (!spec.lod) {
+            continue;
+        }
+        OverviewSeries series;
+        series.lod = spec.lod;
+        series.color = spec.color;
+        series.yMin = spec.yMin;
+        series.yMax = spec.yMax;
+        if (spec.style.displayMode == SeriesDisplayMode::Spectrogram) {
+            // 时频图的Y范围是频率，概览条仍按信号幅值绘制
+            const LodPyramid::Column all = spec.lod->summarize(0, spec.lod->size());
+            if (all.count == 0) {
+                continue;
+            }
+            series.yMin = all.min;
+            series.yMax = all.max;
+        }
+        overviewSeries.append(series);
+    }
+    m_overview->setSeries(overviewSeries);
+    m_overview->setDataRange(m_originalXMin, m_originalXMax);
+    m_overview->setViewRange(m_axisX->min(), m_axisX->max());
 }
 
 void ChartWidget::updateAxisRanges()
 {
-    if (m_chart->series().isEmpty()) {
+    if (m_seriesSpecs.isEmpty()) {
         return;
     }
     
+    // 直接使用规格中已统计的范围，无需遍历数据点
+    double xMin = std::numeric_limits<double>::max();
+    double xMax = std::numeric_limits<double>::lowest();
+    double yMin = std::numeric_limits<double>::max();
+    double yMax = std::numeric_limits<double>::lowest();
+    
+    for (const SeriesSpec &spec : m_seriesSpecs) {
+        xMin = qMin(xMin, spec.xMin);
+        xMax = qMax(xMax, spec.xMax);
+        yMin = qMin(yMin, spec.yMin);
+        yMax = qMax(yMax, spec.yMax);
+    }
+    
+    // 添加一点边距
+    double xMargin = (xMax - xMin) * 0.02;
+    if (xMargin == 0) xMargin = 1;
+    m_suppressXRangeSignal = true;
+    m_axisX->setRange(xMin - xMargin, xMax + xMargin);
+    m_suppressXRangeSignal = false;
+    
+    // 保存原始范围用于重置
+    m_originalXMin = xMin - xMargin;
+    m_originalXMax = xMax + xMargin;
+    
     if (m_multiAxisMode) {
-        // 多Y轴模式：为每个Y轴单独设置范围
-        double xMin = std::numeric_limits<double>::max();
-        double xMax = std::numeric_limits<double>::lowest();
-        
-        // 计算X轴范围
-        for (QAbstractSeries *abstractSeries : m_chart->series()) {
-            QLineSeries *lineSeries = qobject_cast<QLineSeries*>(abstractSeries);
-            QScatterSeries *scatterSeries = qobject_cast<QScatterSeries*>(abstractSeries);
-            
-            if (lineSeries) {
-                for (const QPointF &point : lineSeries->points()) {
-                    xMin = qMin(xMin, point.x());
-                    xMax = qMax(xMax, point.x());
-                }
-            } else if (scatterSeries) {
-                for (const QPointF &point : scatterSeries->points()) {
-                    xMin = qMin(xMin, point.x());
-                    xMax = qMax(xMax, point.x());
-                }
-            }
-        }
-        
-        double xMargin = (xMax - xMin) * 0.02;
-        if (xMargin == 0) xMargin = 1;
-        m_axisX->setRange(xMin - xMargin, xMax + xMargin);
-        m_originalXMin = xMin - xMargin;
-        m_originalXMax = xMax + xMargin;
-        
-        // 为每个独立的Y轴设置范围
+        // 多Y轴模式：为每个独立的Y轴设置范围
+        rebuildAxisInfos();
         for (const SeriesAxisInfo &axisInfo : m_seriesAxisInfos) {
-            double yMin = axisInfo.yMin;
-            double yMax = axisInfo.yMax;
-            double yMargin = (yMax - yMin) * 0.05;
-            if (yMargin == 0) yMargin = qAbs(yMin) * 0.1;
+            double axisYMin = axisInfo.yMin;
+            double axisYMax = axisInfo.yMax;
+            double yMargin = (axisYMax - axisYMin) * 0.05;
+            if (yMargin == 0) yMargin = qAbs(axisYMin) * 0.1;
             if (yMargin == 0) yMargin = 1;
             
-            axisInfo.yAxis->setRange(yMin - yMargin, yMax + yMargin);
+            axisInfo.yAxis->setRange(axisYMin - yMargin, axisYMax + yMargin);
         }
     } else {
         // 单Y轴模式：所有系列使用相同的Y轴范围
-        double xMin = std::numeric_limits<double>::max();
-        double xMax = std::numeric_limits<double>::lowest();
-        double yMin = std::numeric_limits<double>::max();
-        double yMax = std::numeric_limits<double>::lowest();
-        
-        for (QAbstractSeries *abstractSeries : m_chart->series()) {
-            QLineSeries *lineSeries = qobject_cast<QLineSeries*>(abstractSeries);
-            QScatterSeries *scatterSeries = qobject_cast<QScatterSeries*>(abstractSeries);
-            
-            if (lineSeries) {
-                for (const QPointF &point : lineSeries->points()) {
-                    xMin = qMin(xMin, point.x());
-                    xMax = qMax(xMax, point.x());
-                    yMin = qMin(yMin, point.y());
-                    yMax = qMax(yMax, point.y());
-                }
-            } else if (scatterSeries) {
-                for (const QPointF &point : scatterSeries->points()) {
-                    xMin = qMin(xMin, point.x());
-                    xMax = qMax(xMax, point.x());
-                    yMin = qMin(yMin, point.y());
-                    yMax = qMax(yMax, point.y());
-                }
-            }
-        }
-        
-        // 添加一点边距
-        double xMargin = (xMax - xMin) * 0.02;
         double yMargin = (yMax - yMin) * 0.05;
-        
-        if (xMargin == 0) xMargin = 1;
         if (yMargin == 0) yMargin = 1;
         
-        m_axisX->setRange(xMin - xMargin, xMax + xMargin);
         m_axisY->setRange(yMin - yMargin, yMax + yMargin);
-        
-        // 保存原始范围用于重置
-        m_originalXMin = xMin - xMargin;
-        m_originalXMax = xMax + xMargin;
         m_originalYMin = yMin - yMargin;
         m_originalYMax = yMax + yMargin;
     }
+    
+    updateOverview();
 }
 
 void ChartWidget::clearChart()
 {
     clearMarkerLines();
     m_markerInfos.clear();
+    
+    for (SeriesSpec &spec : m_seriesSpecs) {
+        cancelRefinement(spec);
+        destroyChartSeries(spec);
+    }
+    m_seriesSpecs.clear();
+    m_densityTimer->stop();
+    m_refineLabel->hide();
     m_chart->removeAllSeries();
     
     // 清除额外的Y轴
@@ -498,8 +1339,103 @@ void ChartWidget::clearChart()
     
     m_seriesCount = 0;
     
+    m_suppressXRangeSignal = true;
     m_axisX->setRange(0, 1);
+    m_suppressXRangeSignal = false;
     m_axisY->setRange(0, 1);
+    
+    m_lodTimer->stop();
+    m_originalXMin = 0;
+    m_originalXMax = 1;
+    updateOverview();
+}
+
+void ChartWidget::scheduleDensityUpdate()
+{
+    for (const SeriesSpec &spec : m_seriesSpecs) {
+        if (spec.densityItem) {
+            // 交互进行中节流，结束后由 onInteractionFinished 按最终视图再更新一次
+            if (m_chartView->isInteracting()) {
+                if (!m_densityTimer->isActive()) {
+                    m_densityTimer->start(kInteractiveRefreshMs);
+                }
+            } else {
+                m_densityTimer->start(0);
+            }
+            return;
+        }
+    }
+}
+
+void ChartWidget::updateDensityLayers()
+{
+    QRectF plotArea = m_chart->plotArea();
+    
+    // 按设备像素分箱，高DPI屏幕上每个箱对应一个物理像素
+    qreal dpr = devicePixelRatioF();
+    int width = qRound(plotArea.width() * dpr);
+    int height = qRound(plotArea.height() * dpr);
+    
+    for (SeriesSpec &spec : m_seriesSpecs) {
+        if (!spec.densityItem || !spec.yAxis) {
+            continue;
+        }
+        if (spec.style.displayMode == SeriesDisplayMode::Spectrogram) {
+            startSpectrogram(spec, plotArea, width, height);
+            continue;
+        }
+        DensityBinner::Grid grid = DensityBinner::bin(spec.filteredX, spec.filteredY,
+                                                      m_axisX->min(), m_axisX->max(),
+                                                      spec.yAxis->min(), spec.yAxis->max(),
+                                                      width, height);
+        spec.densityItem->setImage(DensityBinner::colorize(grid), plotArea);
+    }
+}
+
+void ChartWidget::scheduleLodUpdate()
+{
+    for (const SeriesSpec &spec : m_seriesSpecs) {
+        if (usesLod(spec)) {
+            if (m_chartView->isInteracting()) {
+                if (!m_lodTimer->isActive()) {
+                    m_lodTimer->start(kInteractiveRefreshMs);
+                }
+            } else {
+                m_lodTimer->start(0);
+            }
+            return;
+        }
+    }
+}
+
+void ChartWidget::onInteractionFinished()
+{
+    // 交互期间完成的后台构建此时替换预览
+    applyRefinedGeometry();
+    scheduleLodUpdate();
+    scheduleDensityUpdate();
+}
+
+void ChartWidget::updateLodSeries()
+{
+    // 每个物理像素列取一次最小/最大值，显示点数只与绘图区宽度有关
+    int columns = qRound(m_chart->plotArea().width() * devicePixelRatioF());
+    if (columns <= 0) {
+        columns = kLodInitialColumns;
+    }
+    
+    for (SeriesSpec &spec : m_seriesSpecs) {
+        if (usesLod(spec)) {
+            applyLodGeometry(spec, m_axisX->min(), m_axisX->max(), columns);
+        }
+    }
+}
+
+void ChartWidget::updateOverviewMargins()
+{
+    QRectF plotArea = m_chart->plotArea();
+    m_overview->setPlotMargins(qRound(plotArea.left()),
+                               qMax(0, m_chartView->width() - qRound(plotArea.right())));
 }
 
 void ChartWidget::setChartTitle(const QString &title)
@@ -525,12 +1461,55 @@ void ChartWidget::setLegendVisible(bool visible)
 void ChartWidget::autoScale()
 {
     updateAxisRanges();
+    
+    // 用户主动的自动缩放需要同步到联动组
+    emit xRangeChanged(m_axisX->min(), m_axisX->max());
 }
 
-bool ChartWidget::saveAsImage(const QString &filePath)
+ChartSnapshot ChartWidget::snapshot() const
 {
-    QPixmap pixmap = m_chartView->grab();
-    return pixmap.save(filePath);
+    ChartSnapshot snap;
+    snap.title = m_chart->title();
+    snap.xAxisLabel = m_axisX->titleText();
+    snap.yAxisLabel = m_axisY->titleText();
+    snap.xMin = m_axisX->min();
+    snap.xMax = m_axisX->max();
+    snap.yMin = m_axisY->min();
+    snap.yMax = m_axisY->max();
+    snap.multiAxisMode = m_multiAxisMode;
+    
+    for (const SeriesSpec &spec : m_seriesSpecs) {
+        ChartSnapshot::Series series;
+        series.name = spec.name;
+        // 隐式共享，不复制数据；时频图按源信号计算（不做区间过滤）
+        if (spec.style.displayMode == SeriesDisplayMode::Spectrogram) {
+            series.xData = spec.xData;
+            series.yData = spec.yData;
+            series.lod = spec.lod;
+        } else if (spec.refinedGeometry) {
+            // 已在后台构建完成、尚未替换预览
+            series.xData = spec.refinedGeometry->filteredX;
+            series.yData = spec.refinedGeometry->filteredY;
+            series.lod = spec.refinedGeometry->lod;
+        } else if (spec.refineToken) {
+            // 仍在显示预览：交给导出线程构建完整几何数据，不在GUI线程等待
+            series.xData = spec.xData;
+            series.yData = spec.yData;
+            series.prepared = false;
+        } else {
+            series.xData = spec.filteredX;
+            series.yData = spec.filteredY;
+            series.lod = spec.lod;
+        }
+        series.color = spec.color;
+        series.style = spec.style;
+        QValueAxis *axis = spec.yAxis ? spec.yAxis : m_axisY;
+        series.axisTitle = axis->titleText();
+        series.yMin = axis->min();
+        series.yMax = axis->max();
+        snap.series.append(series);
+    }
+    return snap;
 }
 
 void ChartWidget::setMultiAxisMode(bool enabled)
@@ -559,6 +1538,41 @@ void ChartWidget::setViewRange(double xMin, double xMax, double yMin, double yMa
     }
 }
 
+void ChartWidget::applyLinkedXRange(double xMin, double xMax)
+{
+    if (!isVisible()) {
+        // 隐藏的标签页只记录最新范围，避免无效重绘
+        m_hasPendingXRange = true;
+        m_pendingXMin = xMin;
+        m_pendingXMax = xMax;
+        return;
+    }
+    
+    m_hasPendingXRange = false;
+    if (m_axisX->min() == xMin && m_axisX->max() == xMax) {
+        return;
+    }
+    m_suppressXRangeSignal = true;
+    m_axisX->setRange(xMin, xMax);
+    m_suppressXRangeSignal = false;
+}
+
+void ChartWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    
+    if (m_hasPendingXRange) {
+        applyLinkedXRange(m_pendingXMin, m_pendingXMax);
+    }
+}
+
+void ChartWidget::onXAxisRangeChanged(qreal min, qreal max)
+{
+    if (!m_suppressXRangeSignal) {
+        emit xRangeChanged(min, max);
+    }
+}
+
 void ChartWidget::zoomIn()
 {
     m_chart->zoomIn();
@@ -668,6 +1682,19 @@ QColor ChartWidget::getNextColor()
         QColor(23, 190, 207)    // 青色
     };
     
+    // 优先使用当前图表中尚未使用的颜色，增删曲线时其余曲线的颜色保持不变
+    for (const QColor &color : colors) {
+        bool used = false;
+        for (const SeriesSpec &spec : m_seriesSpecs) {
+            if (spec.color == color) {
+                used = true;
+                break;
+            }
+        }
+        if (!used) {
+            return color;
+        }
+    }
     return colors[m_seriesCount % colors.size()];
 }
 
@@ -894,10 +1921,22 @@ void ChartWidget::updateMarkerLines()
 
 InteractiveChartView::InteractiveChartView(QChart *chart, QWidget *parent)
     : QChartView(chart, parent)
+    , m_owner(nullptr)
     , m_axisX(nullptr)
     , m_axisY(nullptr)
     , m_isDragging(false)
+    , m_externalDragging(false)
     , m_lastMousePos()
+    , m_pendingPan()
+    , m_pendingZoomX(1.0)
+    , m_pendingZoomY(1.0)
+    , m_zoomAnchor()
+    , m_hoverPending(false)
+    , m_hoverPos()
+    , m_crosshairPos()
+    , m_hasPendingXRange(false)
+    , m_pendingXMin(0.0)
+    , m_pendingXMax(0.0)
     , m_verticalLine(nullptr)
     , m_horizontalLine(nullptr)
     , m_tooltipBg(nullptr)
@@ -905,6 +1944,27 @@ InteractiveChartView::InteractiveChartView(QChart *chart, QWidget *parent)
 {
     setMouseTracking(true);
     
+    // 帧节拍：同一帧内的鼠标事件只记录意图，到期后统一应用
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &InteractiveChartView::applyPendingFrame);
+    
+    // 提示框内容（逐系列查值、生成HTML）节流重建
+    m_tooltipTimer = new QTimer(this);
+    m_tooltipTimer->setSingleShot(true);
+    m_tooltipTimer->setInterval(kTooltipRefreshMs);
+    connect(m_tooltipTimer, &QTimer::timeout, this, &InteractiveChartView::refreshTooltip);
+    
+    m_interactionTimer = new QTimer(this);
+    m_interactionTimer->setSingleShot(true);
+    m_interactionTimer->setInterval(kInteractionIdleMs);
+    connect(m_interactionTimer, &QTimer::timeout, this, [this]() {
+        if (!m_isDragging && !m_externalDragging) {
+            emit interactionFinished();
+        }
+    });
+    
     // 创建垂直虚线
     QPen dashedPen(Qt::gray);
     dashedPen.setStyle(Qt::DashLine);
@@ -950,6 +2010,111 @@ void InteractiveChartView::setAxes(QValueAxis *axisX, QValueAxis *axisY)
     m_axisY = axisY;
 }
 
+bool InteractiveChartView::isInteracting() const
+{
+    return m_isDragging || m_externalDragging || m_interactionTimer->isActive();
+}
+
+void InteractiveChartView::requestXRange(double xMin, double xMax)
+{
+    m_hasPendingXRange = true;
+    m_pendingXMin = xMin;
+    m_pendingXMax = xMax;
+    requestFrame();
+}
+
+void InteractiveChartView::setExternalDragging(bool dragging)
+{
+    if (m_externalDragging == dragging) {
+        return;
+    }
+    m_externalDragging = dragging;
+    if (dragging) {
+        hideCrosshair();
+        return;
+    }
+    // 松开前的最后一个范围立即生效
+    m_frameTimer->stop();
+    applyPendingFrame();
+    m_interactionTimer->start(0);
+}
+
+void InteractiveChartView::requestFrame()
+{
+    if (m_frameTimer->isActive()) {
+        return;
+    }
+    // 距上一帧不足一个帧间隔时等到下一帧；否则在处理完已排队的事件后立即应用
+    qint64 elapsed = m_frameClock.isValid() ? m_frameClock.elapsed() : kFrameIntervalMs;
+    m_frameTimer->start(static_cast<int>(qMax<qint64>(0, kFrameIntervalMs - elapsed)));
+}
+
+void InteractiveChartView::applyPendingFrame()
+{
+    m_frameClock.restart();
+    
+    // 外部请求的X轴范围是绝对值，先于本帧的平移和缩放应用
+    if (m_hasPendingXRange && m_axisX) {
+        m_hasPendingXRange = false;
+        if (m_pendingXMin != m_axisX->min() || m_pendingXMax != m_axisX->max()) {
+            m_axisX->setRange(m_pendingXMin, m_pendingXMax);
+        }
+        m_interactionTimer->start();
+    }
+    
+    bool hasPan = !m_pendingPan.isNull();
+    bool hasZoom = m_pendingZoomX != 1.0 || m_pendingZoomY != 1.0;
+    if ((hasPan || hasZoom) && m_axisX && m_axisY) {
+        QRectF plotArea = chart()->plotArea();
+        if (plotArea.width() > 0 && plotArea.height() > 0) {
+            double xMin = m_axisX->min();
+            double xMax = m_axisX->max();
+            double yMin = m_axisY->min();
+            double yMax = m_axisY->max();
+            
+            // 平移：像素位移换算为数据偏移（向左拖动，数据向右移动；Y轴方向相反）
+            double xOffset = -m_pendingPan.x() * (xMax - xMin) / plotArea.width();
+            double yOffset = m_pendingPan.y() * (yMax - yMin) / plotArea.height();
+            xMin += xOffset;
+            xMax += xOffset;
+            yMin += yOffset;
+            yMax += yOffset;
+            
+            // 缩放：以鼠标位置为中心，保持该位置的数据坐标不变
+            double anchorX = xMin + (m_zoomAnchor.x() - plotArea.left()) / plotArea.width() * (xMax - xMin);
+            double anchorY = yMax - (m_zoomAnchor.y() - plotArea.top()) / plotArea.height() * (yMax - yMin);
+            xMin = anchorX - (anchorX - xMin) * m_pendingZoomX;
+            xMax = anchorX + (xMax - anchorX) * m_pendingZoomX;
+            yMin = anchorY - (anchorY - yMin) * m_pendingZoomY;
+            yMax = anchorY + (yMax - anchorY) * m_pendingZoomY;
+            
+            // 每个轴每帧只设置一次范围，只触发一次重新布局
+            if (xMin != m_axisX->min() || xMax != m_axisX->max()) {
+                m_axisX->setRange(xMin, xMax);
+            }
+            if (yMin != m_axisY->min() || yMax != m_axisY->max()) {
+                m_axisY->setRange(yMin, yMax);
+            }
+        }
+        
+        m_pendingPan = QPointF();
+        m_pendingZoomX = 1.0;
+        m_pendingZoomY = 1.0;
+        m_interactionTimer->start();
+        
+        // 缩放后十字线下的数值已变化
+        if (!m_hoverPending && m_verticalLine->isVisible()) {
+            m_hoverPending = true;
+            m_hoverPos = m_crosshairPos;
+        }
+    }
+    
+    if (m_hoverPending) {
+        m_hoverPending = false;
+        updateCrosshair(m_hoverPos);
+    }
+}
+
 void InteractiveChartView::mousePressEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
@@ -974,43 +2139,28 @@ void InteractiveChartView::mouseMoveEvent(QMouseEvent *event)
 #endif
 
     if (m_isDragging && m_axisX && m_axisY) {
-        // 计算鼠标移动的像素差
-        QPointF delta = currentPos - m_lastMousePos;
+        // 累积鼠标移动的像素差，下一帧统一换算并平移
+        m_pendingPan += currentPos - m_lastMousePos;
         m_lastMousePos = currentPos;
-        
-        // 获取当前轴范围
-        double xMin = m_axisX->min();
-        double xMax = m_axisX->max();
-        double yMin = m_axisY->min();
-        double yMax = m_axisY->max();
-        
-        // 获取图表绑定区域
-        QRectF plotArea = chart()->plotArea();
-        
-        // 计算像素到数据的比例
-        double xScale = (xMax - xMin) / plotArea.width();
-        double yScale = (yMax - yMin) / plotArea.height();
-        
-        // 计算数据偏移量（向左拖动，数据向右移动，所以取负）
-        double xOffset = -delta.x() * xScale;
-        double yOffset = delta.y() * yScale;  // Y轴方向相反
-        
-        // 更新轴范围
-        m_axisX->setRange(xMin + xOffset, xMax + xOffset);
-        m_axisY->setRange(yMin + yOffset, yMax + yOffset);
     } else {
-        // 非拖拽模式，更新十字线
-        updateCrosshair(currentPos);
+        // 非拖拽模式，下一帧更新十字线
+        m_hoverPending = true;
+        m_hoverPos = currentPos;
     }
+    requestFrame();
     
     QChartView::mouseMoveEvent(event);
 }
 
 void InteractiveChartView::mouseReleaseEvent(QMouseEvent *event)
 {
-    if (event->button() == Qt::LeftButton) {
+    if (event->button() == Qt::LeftButton && m_isDragging) {
+        // 松开前的最后一段位移立即生效
+        m_frameTimer->stop();
+        applyPendingFrame();
         m_isDragging = false;
         setCursor(Qt::ArrowCursor);
+        m_interactionTimer->start(0);
     }
     QChartView::mouseReleaseEvent(event);
 }
@@ -1018,10 +2168,14 @@ void InteractiveChartView::mouseReleaseEvent(QMouseEvent *event)
 void InteractiveChartView::leaveEvent(QEvent *event)
 {
     QChartView::leaveEvent(event);
+    m_hoverPending = false;
     hideCrosshair();
     if (m_isDragging) {
+        m_frameTimer->stop();
+        applyPendingFrame();
         m_isDragging = false;
         setCursor(Qt::ArrowCursor);
+        m_interactionTimer->start(0);
     }
 }
 
@@ -1038,28 +2192,21 @@ void InteractiveChartView::wheelEvent(QWheelEvent *event)
 #else
     int delta = event->delta();
 #endif
+    if (delta == 0) {
+        event->accept();
+        return;
+    }
     
     // 缩放因子
     double factor = delta > 0 ? 0.8 : 1.25;
     
-    // 获取鼠标位置对应的图表坐标
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    QPointF mousePos = event->position();
-    Qt::KeyboardModifiers modifiers = event->modifiers();
-#elif QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    // 获取鼠标位置
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
     QPointF mousePos = event->position();
-    Qt::KeyboardModifiers modifiers = event->modifiers();
 #else
     QPointF mousePos = event->posF();
-    Qt::KeyboardModifiers modifiers = event->modifiers();
 #endif
-    QPointF chartPos = chart()->mapToValue(mousePos.toPoint());
-    
-    // 获取当前轴范围
-    double xMin = m_axisX->min();
-    double xMax = m_axisX->max();
-    double yMin = m_axisY->min();
-    double yMax = m_axisY->max();
+    Qt::KeyboardModifiers modifiers = event->modifiers();
     
     // 判断缩放模式：
     // Shift键：只缩放Y轴
@@ -1068,25 +2215,15 @@ void InteractiveChartView::wheelEvent(QWheelEvent *event)
     bool zoomX = !(modifiers & Qt::ShiftModifier);
     bool zoomY = !(modifiers & Qt::ControlModifier);
     
-    // 以鼠标位置为中心进行缩放
-    double xRange = (xMax - xMin) * factor;
-    double yRange = (yMax - yMin) * factor;
-    
-    // 计算新的范围，保持鼠标位置不变
-    double xRatio = (chartPos.x() - xMin) / (xMax - xMin);
-    double yRatio = (chartPos.y() - yMin) / (yMax - yMin);
-    
-    double newXMin = chartPos.x() - xRange * xRatio;
-    double newXMax = chartPos.x() + xRange * (1 - xRatio);
-    double newYMin = chartPos.y() - yRange * yRatio;
-    double newYMax = chartPos.y() + yRange * (1 - yRatio);
-    
+    // 同一帧内的多次滚动合并为一次缩放，以最后的鼠标位置为中心
     if (zoomX) {
-        m_axisX->setRange(newXMin, newXMax);
+        m_pendingZoomX *= factor;
     }
     if (zoomY) {
-        m_axisY->setRange(newYMin, newYMax);
+        m_pendingZoomY *= factor;
     }
+    m_zoomAnchor = mousePos;
+    requestFrame();
     
     event->accept();
 }
@@ -1106,11 +2243,7 @@ void InteractiveChartView::updateCrosshair(const QPoint &pos)
         hideCrosshair();
         return;
     }
-    
-    // 将像素坐标转换为图表坐标
-    QPointF chartPos = chart()->mapToValue(pos);
-    double xValue = chartPos.x();
-    double yValue = chartPos.y();
+    m_crosshairPos = pos;
     
     // 绘制垂直虚线
     m_verticalLine->setLine(pos.x(), plotArea.top(), pos.x(), plotArea.bottom());
@@ -1120,10 +2253,34 @@ void InteractiveChartView::updateCrosshair(const QPoint &pos)
     m_horizontalLine->setLine(plotArea.left(), pos.y(), plotArea.right(), pos.y());
     m_horizontalLine->setVisible(true);
     
+    // 提示框先跟随鼠标移动，内容稍后重建
+    if (m_tooltipBg->isVisible()) {
+        placeTooltip(pos);
+    }
+    if (!m_tooltipTimer->isActive()) {
+        m_tooltipTimer->start();
+    }
+}
+
+void InteractiveChartView::refreshTooltip()
+{
+    if (!m_verticalLine->isVisible()) {
+        return;
+    }
+    
+    // 将像素坐标转换为图表坐标
+    QPointF chartPos = chart()->mapToValue(m_crosshairPos);
+    
     // 构建提示文本
-    QString tooltipStr = buildTooltipText(xValue, yValue);
-    m_tooltipText->setHtml(tooltipStr);
+    m_tooltipText->setHtml(buildTooltipText(chartPos.x(), chartPos.y()));
+    placeTooltip(m_crosshairPos);
     
+    m_tooltipText->setVisible(true);
+    m_tooltipBg->setVisible(true);
+}
+
+void InteractiveChartView::placeTooltip(const QPoint &pos)
+{
     // 计算提示框位置和大小
     QRectF textRect = m_tooltipText->boundingRect();
     double tooltipX = pos.x() + 15;
@@ -1142,13 +2299,11 @@ void InteractiveChartView::updateCrosshair(const QPoint &pos)
     
     m_tooltipText->setPos(tooltipX + 5, tooltipY + 3);
     m_tooltipBg->setRect(tooltipX, tooltipY, textRect.width() + 10, textRect.height() + 6);
-    
-    m_tooltipText->setVisible(true);
-    m_tooltipBg->setVisible(true);
 }
 
 void InteractiveChartView::hideCrosshair()
 {
+    m_tooltipTimer->stop();
     m_verticalLine->setVisible(false);
     m_horizontalLine->setVisible(false);
     m_tooltipBg->setVisible(false);
@@ -1161,6 +2316,43 @@ QString InteractiveChartView::buildTooltipText(double xValue, double yValue)
     html += "<table cellspacing='2'>";
     
     for (QAbstractSeries *abstractSeries : chart()->series()) {
+        // 降采样显示的曲线：报告鼠标所在像素列内的 最小/最大/均值
+        if (m_owner) {
+            LodPyramid::Column bucket;
+            ChartWidget::BucketQuery query = m_owner->queryBucket(abstractSeries, xValue, bucket);
+            if (query == ChartWidget::BucketQuery::Hidden) {
+                continue;
+            }
+            if (query == ChartWidget::BucketQuery::Aggregated) {
+                QColor color = abstractSeries->type() == QAbstractSeries::SeriesTypeArea
+                               ? static_cast<QAreaSeries*>(abstractSeries)->borderColor()
+                               : static_cast<QXYSeries*>(abstractSeries)->color();
+                if (bucket.count <= 1) {
+                    html += QString("<tr>"
+                                    "<td><font color='%1'>●</font></td>"
+                                    "<td>%2:</td>"
+                                    "<td><b>%3</b></td>"
+                                    "</tr>")
+                            .arg(color.name())
+                            .arg(abstractSeries->name())
+                            .arg(bucket.mean(), 0, 'f', 4);
+                } else {
+                    html += QString("<tr>"
+                                    "<td><font color='%1'>●</font></td>"
+                                    "<td>%2:</td>"
+                                    "<td><b>%3</b> &nbsp;[%4, %5] &nbsp;n=%6</td>"
+                                    "</tr>")
+                            .arg(color.name())
+                            .arg(abstractSeries->name())
+                            .arg(bucket.mean(), 0, 'f', 4)
+                            .arg(bucket.min, 0, 'f', 4)
+                            .arg(bucket.max, 0, 'f', 4)
+                            .arg(bucket.count);
+                }
+                continue;
+            }
+        }
+        
         // 尝试作为 QLineSeries
         QLineSeries *lineSeries = qobject_cast<QLineSeries*>(abstractSeries);
         if (lineSeries) {
@@ -1181,6 +2373,11 @@ QString InteractiveChartView::buildTooltipText(double xValue, double yValue)
         // 尝试作为 QScatterSeries
         QScatterSeries *scatterSeries = qobject_cast<QScatterSeries*>(abstractSeries);
         if (scatterSeries) {
+            // 密度图的占位系列没有数据点
+            if (scatterSeries->count() == 0) {
+                continue;
+            }
+            
             // 对于散点图，找最近的点
             double yValue = interpolateYScatter(scatterSeries, xValue);
             QColor color = scatterSeries->color();
@@ -1202,7 +2399,7 @@ QString InteractiveChartView::buildTooltipText(double xValue, double yValue)
 
 double InteractiveChartView::interpolateY(QLineSeries *series, double xValue)
 {
-    QList<QPointF> points = series->points();
+    const QVector<QPointF> points = seriesPoints(series);
     if (points.isEmpty()) {
         return 0;
     }
@@ -1244,7 +2441,7 @@ double InteractiveChartView::interpolateY(QLineSeries *series, double xValue)
 
 double InteractiveChartView::interpolateYScatter(QScatterSeries *series, double xValue)
 {
-    QList<QPointF> points = series->points();
+    const QVector<QPointF> points = seriesPoints(series);
     if (points.isEmpty()) {
         return 0;
     }
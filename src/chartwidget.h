@@ -11,7 +11,15 @@
 #include <QGraphicsLineItem>
 #include <QGraphicsTextItem>
 #include <QCheckBox>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "seriesstyledialog.h"
+#include "densitymap.h"
+#include "chartexporter.h"
+#include "lodpyramid.h"
+#include "overviewwidget.h"
+#include "rangefilter.h"
+#include "geometrycache.h"
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 using namespace Qt;
@@ -24,12 +32,12 @@ QT_CHARTS_USE_NAMESPACE
 class InteractiveChartView;
 
 /**
- * @brief 系列Y轴信息
+ * @brief Y轴信息（多Y轴模式下每个独立的Y轴一条）
  */
 struct SeriesAxisInfo {
     QString seriesName;
     QValueAxis *yAxis;  // 该系列使用的Y轴
-    double yMin;
+    double yMin;        // 共享该轴的所有系列的Y值范围
     double yMax;
 };
 
@@ -55,6 +63,48 @@ struct SeriesMarkerInfo {
     QLineSeries *xMaxLine = nullptr;
 };
 
+/**
+ * @brief 系列规格
+ * 记录一条曲线的数据来源和样式。切换多Y轴模式、修改样式时据此
+ * 重新绑定坐标轴或重建图表对象，无需再从图表中拷贝数据点
+ */
+struct SeriesSpec {
+    QString name;
+    QVector<double> xData;          // 源数据（隐式共享，不复制），为空表示X为行索引
+    QVector<double> yData;
+    QColor color;
+    SeriesStyle style;
+    
+    // 按样式过滤后的几何数据（未启用过滤时与源数据共享，点数以 filteredY 为准）
+    // 连续段之间以Y为NaN的分隔点隔开，见 RangeFilter
+    QVector<double> filteredX;
+    QVector<double> filteredY;
+    int breakCount = 0;             // 分隔点/无效点个数
+    double xMin = 0;
+    double xMax = 0;
+    double yMin = 0;
+    double yMax = 0;
+    
+    // LOD金字塔，用于主图按视图降采样、十字线查询和概览条
+    // X无序时建立在按X排序后的副本上：折线仍按原顺序连接，不使用它降采样
+    bool xSorted = true;
+    QSharedPointer<const LodPyramid> lod;
+    
+    // 大数据量曲线先显示抽样预览，完整几何数据在后台构建
+    QSharedPointer<QAtomicInt> refineToken;                 // 非空表示正在细化，置1取消
+    QSharedPointer<PreparedGeometry> refinedGeometry;       // 已构建完成、等待替换预览
+    
+    // 图表对象
+    QList<QAbstractSeries*> chartSeries;    // 第一个系列显示图例
+    QList<QLineSeries*> segmentSeries;      // 折线在间断处拆出的后续段（同时在 chartSeries 中）
+    QValueAxis *yAxis = nullptr;
+    DensityMapItem *densityItem = nullptr;  // 密度模式/时频图的热力图层
+    
+    // 时频图：按X估计的采样率，以及正在后台计算的时频图（置1取消）
+    double sampleRate = 0;
+    QSharedPointer<QAtomicInt> spectrogramToken;
+};
+
 /**
  * @brief 图表组件类
  * 用于显示和管理图表，支持缩放和鼠标悬停显示
@@ -69,6 +119,7 @@ public:
     
     /**
      * @brief 添加一条数据线
+     * @param xData 为空时以行号 0..N-1 为X（隐式索引，不生成数组）
      */
     void addSeries(const QString &name, 
                    const QVector<double> &xData, 
@@ -76,6 +127,32 @@ public:
                    const QColor &color = QColor(),
                    const SeriesStyle &style = SeriesStyle());
     
+    /**
+     * @brief 修改已有曲线的样式
+     * 仅当显示模式或区间过滤变化时重建该曲线，Y轴分组变化只重新绑定坐标轴
+     * @return 图表中是否存在该曲线
+     */
+    bool setSeriesStyle(const QString &name, const SeriesStyle &style);
+    
+    /**
+     * @brief 替换已有曲线的数据（如X轴切换），保留颜色、样式和Y轴
+     * 新数据与原数据共享同一份存储时不做任何处理
+     * @return 图表中是否存在该曲线
+     */
+    bool setSeriesData(const QString &name,
+                       const QVector<double> &xData,
+                       const QVector<double> &yData);
+    
+    /**
+     * @brief 移除一条数据线，其余曲线不受影响
+     */
+    bool removeSeries(const QString &name);
+    
+    /**
+     * @brief 图表中所有曲线的名称（按添加顺序）
+     */
+    QStringList seriesNames() const;
+    
     /**
      * @brief 清除所有数据线
      */
@@ -107,9 +184,11 @@ public:
     void autoScale();
     
     /**
-     * @brief 保存图表为图片
+     * @brief 采集当前图表的快照（标题、视图范围和全分辨率数据）
+     * 用于在后台线程中高分辨率导出；不等待后台细化，仍在预览的曲线
+     * 以源数据标记为待构建（见 ChartExporter::prepareGeometry）
      */
-    bool saveAsImage(const QString &filePath);
+    ChartSnapshot snapshot() const;
     
     /**
      * @brief 获取/设置多Y轴模式
@@ -126,6 +205,35 @@ public:
      * @brief 设置视图范围
      */
     void setViewRange(double xMin, double xMax, double yMin, double yMax);
+    
+    /**
+     * @brief 悬停提示的查询结果
+     */
+    enum class BucketQuery {
+        NotAggregated,  // 普通系列，按显示点插值
+        Aggregated,     // 降采样系列，已给出像素桶内的统计
+        Hidden          // 附属系列（如包络带的均值线），不单独显示
+    };
+    
+    /**
+     * @brief 查询鼠标所在像素列内某曲线的 最小/最大/均值
+     * @param series 图表中的系列
+     * @param xValue 鼠标处的X值
+     */
+    BucketQuery queryBucket(QAbstractSeries *series, double xValue, LodPyramid::Column &column) const;
+    
+    /**
+     * @brief 应用联动组同步来的X轴范围（不再向外发出xRangeChanged）
+     * 图表不可见时仅记录，显示时再应用
+     */
+    void applyLinkedXRange(double xMin, double xMax);
+
+signals:
+    /**
+     * @brief 用户缩放、平移或设置视图导致X轴范围变化
+     * 添加数据后的自动适配和联动同步不会发出该信号
+     */
+    void xRangeChanged(double xMin, double xMax);
 
 public slots:
     void zoomIn();
@@ -145,12 +253,143 @@ public slots:
      */
     void showMarkerSettings();
 
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private slots:
+    /**
+     * @brief X轴范围变化，按需转发为xRangeChanged
+     */
+    void onXAxisRangeChanged(qreal min, qreal max);
+    
+    /**
+     * @brief 合并缩放/平移引起的密度图重新分箱请求
+     */
+    void scheduleDensityUpdate();
+    
+    /**
+     * @brief 按当前可见范围和绘图区域重新分箱所有密度图层，并重新计算时频图
+     */
+    void updateDensityLayers();
+    
+    /**
+     * @brief 合并X范围或绘图区域变化引起的LOD重采样请求
+     */
+    void scheduleLodUpdate();
+    
+    /**
+     * @brief 按当前视图从LOD金字塔重新生成大数据量折线的显示点
+     */
+    void updateLodSeries();
+    
+    /**
+     * @brief 拖拽/缩放结束后按最终视图立即重采样
+     */
+    void onInteractionFinished();
+    
+    /**
+     * @brief 同步概览条与主图绘图区域的左右边距
+     */
+    void updateOverviewMargins();
+
 private:
     void setupToolbar();
     QColor getNextColor();
     void updateAxisRanges();
     void updateMarkerLines();
     void clearMarkerLines();
+    
+    /**
+     * @brief 按样式过滤源数据并统计范围
+     */
+    void prepareGeometry(SeriesSpec &spec);
+    void applyGeometry(SeriesSpec &spec, const PreparedGeometry &geometry);
+    
+    /**
+     * @brief 后台构建完整几何数据，完成后替换预览
+     */
+    void startRefinement(SeriesSpec &spec);
+    void cancelRefinement(SeriesSpec &spec);
+    void onRefinementReady(const QSharedPointer<QAtomicInt> &token,
+                           const QSharedPointer<PreparedGeometry> &geometry);
+    
+    /**
+     * @brief 用已构建完成的完整几何数据重建对应曲线
+     */
+    void applyRefinedGeometry();
+    void updateRefineIndicator();
+    
+    /**
+     * @brief 后台按当前视图计算时频图：先每列一段快速预览，再平均更多段细化
+     */
+    void startSpectrogram(SeriesSpec &spec, const QRectF &plotArea, int width, int height);
+    void cancelSpectrogram(SeriesSpec &spec);
+    void onSpectrogramReady(const QSharedPointer<QAtomicInt> &token, const QImage &image,
+                            const QRectF &plotArea, bool finished);
+    
+    /**
+     * @brief 创建系列的图表对象并绑定X轴
+     */
+    void buildChartSeries(SeriesSpec &spec);
+    
+    /**
+     * @brief 删除系列的图表对象（保留规格）
+     */
+    void destroyChartSeries(SeriesSpec &spec);
+    
+    /**
+     * @brief 为系列分配并绑定Y轴
+     * @param index 系列序号，用于交替选择左右两侧
+     */
+    void attachYAxis(SeriesSpec &spec, int index);
+    
+    /**
+     * @brief 按当前模式重新为所有系列分配Y轴
+     */
+    void rebindAxes();
+    
+    /**
+     * @brief 汇总多Y轴模式下每个Y轴的数据范围
+     */
+    void rebuildAxisInfos();
+    
+    int findSeriesSpec(const QString &name) const;
+    
+    /**
+     * @brief 用规格中的源数据重新过滤并重建一条曲线，保留其Y轴
+     */
+    void rebuildSeries(int index, bool axisChanged);
+    
+    /**
+     * @brief 移除一条曲线并更新坐标轴范围和标记线
+     */
+    void removeSeriesAt(int index);
+    
+    /**
+     * @brief 按X范围和列数从LOD金字塔更新降采样折线或包络带的显示点
+     */
+    void applyLodGeometry(SeriesSpec &spec, double xMin, double xMax, int columns);
+    
+    /**
+     * @brief 设置折线的显示点，在分隔点处拆分为多个段
+     * 第一段放入主折线，其余段放入按需创建的附加系列（与主折线共享坐标轴，不显示图例）
+     */
+    void applyLinePoints(SeriesSpec &spec, const QVector<QPointF> &points);
+    
+    /**
+     * @brief 在过滤后的数据上插值X处的Y值，X位于间断内时返回false
+     */
+    bool valueAt(const SeriesSpec &spec, double x, double &y) const;
+    
+    /**
+     * @brief 该曲线的折线是否按视图从LOD金字塔降采样显示
+     */
+    bool usesLod(const SeriesSpec &spec) const;
+    
+    /**
+     * @brief 用当前曲线和数据范围刷新概览条
+     */
+    void updateOverview();
 
 private:
     QChart *m_chart;
@@ -170,6 +409,8 @@ private:
     QToolButton *m_zoomOutYBtn;  // Y轴缩小
     QToolButton *m_markerBtn;
     QCheckBox *m_multiAxisCheckBox;  // 多Y轴模式开关
+    QCheckBox *m_overviewCheckBox;   // 概览条开关
+    QLabel *m_refineLabel;           // 后台细化进行中的提示
     
     int m_seriesCount;
     
@@ -179,16 +420,36 @@ private:
     
     // 多Y轴模式
     bool m_multiAxisMode;
-    QList<SeriesAxisInfo> m_seriesAxisInfos;  // 每个系列的Y轴信息
+    QList<SeriesAxisInfo> m_seriesAxisInfos;  // 每个Y轴的信息
     QList<QValueAxis*> m_extraYAxes;  // 额外的Y轴列表
     QMap<int, QValueAxis*> m_yAxisGroups;  // Y轴组映射（组号 -> Y轴）
     
     // 曲线标记信息
     QList<SeriesMarkerInfo> m_markerInfos;
+    
+    // 系列规格注册表（按添加顺序）
+    QList<SeriesSpec> m_seriesSpecs;
+    
+    // 密度热力图重新分箱的合并定时器
+    QTimer *m_densityTimer;
+    
+    // LOD重采样的合并定时器
+    QTimer *m_lodTimer;
+    
+    // 概览条
+    OverviewWidget *m_overview;
+    
+    // X轴联动
+    bool m_suppressXRangeSignal;    // 程序内部调整X轴时不发出xRangeChanged
+    bool m_hasPendingXRange;        // 隐藏期间收到的联动范围
+    double m_pendingXMin;
+    double m_pendingXMax;
 };
 
 /**
  * @brief 自定义ChartView，支持鼠标悬停显示垂直线和数值，以及拖拽平移
+ * 鼠标事件只记录平移/缩放/悬停意图，每帧最多应用一次；
+ * 提示框内容的生成推迟到鼠标停顿时进行
  */
 class InteractiveChartView : public QChartView
 {
@@ -199,6 +460,32 @@ public:
     ~InteractiveChartView();
     
     void setAxes(QValueAxis *axisX, QValueAxis *axisY);
+    
+    /**
+     * @brief 设置所属的图表组件（用于查询降采样曲线的像素桶统计）
+     */
+    void setOwner(ChartWidget *owner) { m_owner = owner; }
+    
+    /**
+     * @brief 是否正在拖拽或刚刚缩放（期间耗时的重采样可以降低频率）
+     */
+    bool isInteracting() const;
+    
+    /**
+     * @brief 请求设置X轴范围（如概览条的刷选框），与鼠标交互一样在下一帧应用，同一帧内以最后一次为准
+     */
+    void requestXRange(double xMin, double xMax);
+    
+    /**
+     * @brief 外部控件（概览条）开始/结束拖动，期间视为正在交互；结束时立即应用最后的范围
+     */
+    void setExternalDragging(bool dragging);
+
+signals:
+    /**
+     * @brief 拖拽/缩放结束，视图稳定下来
+     */
+    void interactionFinished();
 
 protected:
     void mousePressEvent(QMouseEvent *event) override;
@@ -208,20 +495,51 @@ protected:
     void wheelEvent(QWheelEvent *event) override;
 
 private:
+    /**
+     * @brief 请求在下一帧应用累积的交互意图
+     */
+    void requestFrame();
+    
+    /**
+     * @brief 一次性应用本帧累积的平移、缩放和悬停
+     */
+    void applyPendingFrame();
+    
     void updateCrosshair(const QPoint &pos);
     void hideCrosshair();
+    void refreshTooltip();
+    void placeTooltip(const QPoint &pos);
     QString buildTooltipText(double xValue, double yValue);
     double interpolateY(QLineSeries *series, double xValue);
     double interpolateYScatter(QScatterSeries *series, double xValue);
 
 private:
+    ChartWidget *m_owner;
     QValueAxis *m_axisX;
     QValueAxis *m_axisY;
     
     // 拖拽相关
     bool m_isDragging;
+    bool m_externalDragging;    // 概览条正在拖动刷选框
     QPoint m_lastMousePos;
     
+    // 本帧累积的交互意图
+    QPointF m_pendingPan;       // 拖拽位移（像素）
+    double m_pendingZoomX;      // 缩放倍数，1 表示不缩放
+    double m_pendingZoomY;
+    QPointF m_zoomAnchor;       // 缩放中心（像素）
+    bool m_hoverPending;
+    QPoint m_hoverPos;
+    QPoint m_crosshairPos;      // 当前十字线位置
+    bool m_hasPendingXRange;    // 外部请求的X轴范围
+    double m_pendingXMin;
+    double m_pendingXMax;
+    
+    QTimer *m_frameTimer;       // 帧节拍：合并同一帧内的事件
+    QElapsedTimer m_frameClock; // 距上一帧的时间
+    QTimer *m_tooltipTimer;     // 提示框内容节流
+    QTimer *m_interactionTimer; // 缩放/平移停止后发出 interactionFinished
+    
     // 垂直虚线
     QGraphicsLineItem *m_verticalLine;
     // 水平虚线
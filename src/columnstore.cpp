@@ -0,0 +1,105 @@
+#include "columnstore.h"
+#include "csvparser.h"
+#include "geometrycache.h"
+#include "sortindex.h"
+#include "derivedcache.h"
+
+ColumnStore::ColumnStore(QObject *parent)
+    : QObject(parent)
+    , m_rowCount(0)
+    , m_nextId(1)
+{
+}
+
+ColumnHandle ColumnStore::makeColumn(const QString &name, const QVector<double> &values, bool derived)
+{
+    ColumnData *data = new ColumnData;
+    data->name = name;
+    data->values = values;
+    data->derived = derived;
+    data->id = m_nextId++;
+    return ColumnHandle(data);
+}
+
+void ColumnStore::loadSource(const CsvParser &parser)
+{
+    m_source.clear();
+    m_sourceOrder.clear();
+    // 旧文件的几何缓存和排序下标不会再命中，及时释放其持有的数据
+    GeometryCache::instance().clear();
+    SortIndex::clearCache();
+    DerivedCache::instance().clearColumnHashes();
+    m_rowCount = parser.getRowCount();
+
+    const QStringList names = parser.getColumnNames();
+    for (int i = 0; i < names.size(); ++i) {
+        if (!parser.isNumericColumn(i)) {
+            continue;
+        }
+        m_source.insert(names[i], makeColumn(names[i], parser.getColumnData(i), false));
+        m_sourceOrder.append(names[i]);
+    }
+}
+
+ColumnHandle ColumnStore::setDerivedColumn(const QString &name, const QVector<double> &values)
+{
+    // 被替换的列不会再作为脚本输入，释放其内容哈希记录持有的数据
+    if (ColumnHandle previous = m_derived.value(name)) {
+        DerivedCache::instance().releaseColumnHash(previous->values);
+    }
+    ColumnHandle handle = makeColumn(name, values, true);
+    m_derived.insert(name, handle);
+    emit derivedColumnsChanged();
+    return handle;
+}
+
+bool ColumnStore::removeDerivedColumn(const QString &name)
+{
+    ColumnHandle handle = m_derived.take(name);
+    if (!handle) {
+        return false;
+    }
+    DerivedCache::instance().releaseColumnHash(handle->values);
+    emit derivedColumnsChanged();
+    return true;
+}
+
+void ColumnStore::clearDerivedColumns()
+{
+    if (m_derived.isEmpty()) {
+        return;
+    }
+    for (const ColumnHandle &handle : m_derived) {
+        DerivedCache::instance().releaseColumnHash(handle->values);
+    }
+    m_derived.clear();
+    emit derivedColumnsChanged();
+}
+
+ColumnHandle ColumnStore::column(const QString &name) const
+{
+    ColumnHandle handle = m_source.value(name);
+    return handle ? handle : m_derived.value(name);
+}
+
+ColumnHandle ColumnStore::derivedColumn(const QString &name) const
+{
+    return m_derived.value(name);
+}
+
+bool ColumnStore::contains(const QString &name) const
+{
+    return m_source.contains(name) || m_derived.contains(name);
+}
+
+qint64 ColumnStore::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for (const ColumnHandle &handle : m_source) {
+        bytes += qint64(handle->values.size()) * sizeof(double);
+    }
+    for (const ColumnHandle &handle : m_derived) {
+        bytes += qint64(handle->values.size()) * sizeof(double);
+    }
+    return bytes;
+}
@@ -0,0 +1,91 @@
+#ifndef COLUMNSTORE_H
+#define COLUMNSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QSharedPointer>
+
+class CsvParser;
+
+/**
+ * @brief 不可变的数据列
+ * 创建后内容不再改变，可在多个Canvas、脚本和导出线程之间直接共享
+ */
+struct ColumnData
+{
+    QString name;
+    QVector<double> values;     // 隐式共享，读取时不复制
+    bool derived = false;       // 是否为脚本生成的派生列
+    quint64 id = 0;             // 全局唯一编号，同名列重新生成后编号改变
+};
+
+/**
+ * @brief 数据列句柄（引用计数）
+ * 持有句柄期间列数据保持有效，即使该列已从存储中移除或被替换
+ */
+typedef QSharedPointer<const ColumnData> ColumnHandle;
+
+/**
+ * @brief 数据列存储
+ * 集中保存CSV源数据列和脚本派生列，每列只占用一份内存，
+ * CsvParser、ScriptEngine、CanvasPanel 和 ChartWidget 都通过句柄读取同一份数据
+ */
+class ColumnStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ColumnStore(QObject *parent = nullptr);
+
+    /**
+     * @brief 从解析器载入所有数值列（与解析器共享数据），派生列保持不变
+     */
+    void loadSource(const CsvParser &parser);
+
+    /**
+     * @brief 添加或替换派生列
+     */
+    ColumnHandle setDerivedColumn(const QString &name, const QVector<double> &values);
+
+    bool removeDerivedColumn(const QString &name);
+    void clearDerivedColumns();
+
+    /**
+     * @brief 按名称查找列（源数据列优先），不存在时返回空句柄
+     */
+    ColumnHandle column(const QString &name) const;
+    ColumnHandle derivedColumn(const QString &name) const;
+
+    bool contains(const QString &name) const;
+    bool isSourceColumn(const QString &name) const { return m_source.contains(name); }
+
+    QStringList sourceColumnNames() const { return m_sourceOrder; }
+    QStringList derivedColumnNames() const { return m_derived.keys(); }
+
+    int rowCount() const { return m_rowCount; }
+
+    /**
+     * @brief 所有列数据占用的内存（字节）
+     */
+    qint64 memoryUsage() const;
+
+signals:
+    /**
+     * @brief 派生列被添加、替换或删除
+     */
+    void derivedColumnsChanged();
+
+private:
+    ColumnHandle makeColumn(const QString &name, const QVector<double> &values, bool derived);
+
+    QMap<QString, ColumnHandle> m_source;
+    QStringList m_sourceOrder;                  // 源数据列按文件中的顺序
+    QMap<QString, ColumnHandle> m_derived;
+    int m_rowCount;
+    quint64 m_nextId;
+};
+
+#endif // COLUMNSTORE_H
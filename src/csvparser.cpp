@@ -5,6 +5,7 @@
 #include <QRegularExpression>
 
 CsvParser::CsvParser()
+    : m_rowCount(0)
 {
 }
 
@@ -69,18 +70,26 @@ bool CsvParser::parseFile(const QString &filePath)
     file.close();
     
     // 预处理数值列
+    m_rowCount = m_rawData.size();
+    m_numericFlags.resize(m_columnNames.size());
     for (int col = 0; col < m_columnNames.size(); ++col) {
-        if (isNumericColumn(col)) {
-            QVector<double> numericCol;
-            for (int row = 0; row < m_rawData.size(); ++row) {
+        m_numericFlags[col] = detectNumericColumn(col);
+        if (m_numericFlags[col]) {
+            QVector<double> numericCol(m_rowCount);
+            double *out = numericCol.data();
+            for (int row = 0; row < m_rowCount; ++row) {
                 bool ok;
                 double value = toDouble(m_rawData[row][col], &ok);
-                numericCol.append(ok ? value : 0.0);
+                out[row] = ok ? value : 0.0;
             }
             m_numericData[m_columnNames[col]] = numericCol;
         }
     }
     
+    // 数值列已转换完毕，释放原始字符串（通常是数值数据的数倍大小）
+    m_rawData.clear();
+    m_rawData.squeeze();
+    
     return true;
 }
 
@@ -107,7 +116,7 @@ QVector<double> CsvParser::getColumnData(int columnIndex) const
 
 int CsvParser::getRowCount() const
 {
-    return m_rawData.size();
+    return m_rowCount;
 }
 
 int CsvParser::getColumnCount() const
@@ -116,6 +125,14 @@ int CsvParser::getColumnCount() const
 }
 
 bool CsvParser::isNumericColumn(int columnIndex) const
+{
+    if (columnIndex < 0 || columnIndex >= m_numericFlags.size()) {
+        return false;
+    }
+    return m_numericFlags[columnIndex];
+}
+
+bool CsvParser::detectNumericColumn(int columnIndex) const
 {
     if (columnIndex < 0 || columnIndex >= m_columnNames.size()) {
         return false;
@@ -157,6 +174,8 @@ void CsvParser::clear()
     m_columnNames.clear();
     m_rawData.clear();
     m_numericData.clear();
+    m_numericFlags.clear();
+    m_rowCount = 0;
     m_lastError.clear();
 }
 
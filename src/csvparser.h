@@ -31,7 +31,7 @@ public:
     /**
      * @brief 获取指定列的数据
      * @param columnName 列名
-     * @return 该列的所有数据
+     * @return 该列的所有数据（与解析器隐式共享，不复制）
      */
     QVector<double> getColumnData(const QString &columnName) const;
     
@@ -74,8 +74,10 @@ public:
 
 private:
     QStringList m_columnNames;                      // 列名列表
-    QVector<QVector<QString>> m_rawData;            // 原始字符串数据
+    QVector<QVector<QString>> m_rawData;            // 原始字符串数据（仅解析期间保留）
     QMap<QString, QVector<double>> m_numericData;   // 数值数据缓存
+    QVector<bool> m_numericFlags;                   // 每列是否为数值列（解析时确定）
+    int m_rowCount;                                 // 数据行数
     QString m_lastError;                            // 错误信息
     
     /**
@@ -85,6 +87,11 @@ private:
      */
     QStringList parseLine(const QString &line);
     
+    /**
+     * @brief 根据前100行判断某列是否为数值列（解析期间调用）
+     */
+    bool detectNumericColumn(int columnIndex) const;
+    
     /**
      * @brief 尝试将字符串转换为数值
      * @param str 字符串
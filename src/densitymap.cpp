@@ -0,0 +1,202 @@
+#include "densitymap.h"
+#include "parallelutils.h"
+#include "xvalues.h"
+#include <QPainter>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// 每个线程至少处理的点数 / 合并时每块至少处理的箱数
+const qint64 kMinPointsPerChunk = 256 * 1024;
+const qint64 kMinCellsPerChunk = 64 * 1024;
+
+// 所有线程局部直方图的总箱数上限（约64MB），用于限制线程数
+const qint64 kMaxHistogramCells = 16 * 1024 * 1024;
+
+/**
+ * @brief 生成256级的感知均匀调色板（近似viridis）
+ */
+QVector<QRgb> buildPalette()
+{
+    struct Stop { double pos; int r, g, b; };
+    static const Stop stops[] = {
+        {0.00,  68,   1,  84},
+        {0.25,  59,  82, 139},
+        {0.50,  33, 145, 140},
+        {0.75,  94, 201,  98},
+        {1.00, 253, 231,  37}
+    };
+    const int stopCount = sizeof(stops) / sizeof(stops[0]);
+
+    QVector<QRgb> palette(256);
+    for (int i = 0; i < 256; ++i) {
+        double t = i / 255.0;
+        int s = 0;
+        while (s < stopCount - 2 && t > stops[s + 1].pos) {
+            ++s;
+        }
+        double f = (t - stops[s].pos) / (stops[s + 1].pos - stops[s].pos);
+        int r = qRound(stops[s].r + f * (stops[s + 1].r - stops[s].r));
+        int g = qRound(stops[s].g + f * (stops[s + 1].g - stops[s].g));
+        int b = qRound(stops[s].b + f * (stops[s + 1].b - stops[s].b));
+        palette[i] = qRgb(r, g, b);
+    }
+    return palette;
+}
+
+} // namespace
+
+// ==================== DensityBinner ====================
+
+DensityBinner::Grid DensityBinner::bin(const QVector<double> &xData,
+                                       const QVector<double> &yData,
+                                       double xMin, double xMax,
+                                       double yMin, double yMax,
+                                       int width, int height)
+{
+    Grid grid;
+    const qint64 count = XValues::count(xData, yData);
+    if (width <= 0 || height <= 0 || count == 0 || !(xMax > xMin) || !(yMax > yMin)) {
+        return grid;
+    }
+
+    grid.width = width;
+    grid.height = height;
+    const qint64 cells = qint64(width) * height;
+
+    // 每个线程一份局部直方图，避免原子操作；线程数受内存预算限制
+    const int maxThreads = static_cast<int>(qMax<qint64>(1, kMaxHistogramCells / cells));
+    const int chunks = ParallelUtils::chunkCount(count, kMinPointsPerChunk, maxThreads);
+    std::vector<std::vector<quint32>> partials(chunks);
+
+    // X为空时为隐式行索引
+    const double *px = xData.isEmpty() ? nullptr : xData.constData();
+    const double *py = yData.constData();
+    const double sx = width / (xMax - xMin);
+    const double sy = height / (yMax - yMin);
+    const double w = width;
+    const double h = height;
+
+    ParallelUtils::forChunks(count, kMinPointsPerChunk, maxThreads,
+                             [&](qint64 begin, qint64 end, int chunk) {
+        std::vector<quint32> &hist = partials[chunk];
+        hist.assign(cells, 0);
+        auto accumulate = [&](auto xAt) {
+            for (qint64 i = begin; i < end; ++i) {
+                const double fx = (xAt(i) - xMin) * sx;
+                const double fy = (yMax - py[i]) * sy;
+                // 取反的比较同时过滤掉NaN
+                if (!(fx >= 0.0 && fx < w && fy >= 0.0 && fy < h)) {
+                    continue;
+                }
+                hist[qint64(fy) * width + qint64(fx)]++;
+            }
+        };
+        if (px) {
+            accumulate([px](qint64 i) { return px[i]; });
+        } else {
+            accumulate([](qint64 i) { return static_cast<double>(i); });
+        }
+    });
+
+    // 按箱并行合并局部直方图
+    grid.counts.resize(static_cast<int>(cells));
+    quint32 *out = grid.counts.data();
+    const int mergeChunks = ParallelUtils::chunkCount(cells, kMinCellsPerChunk);
+    std::vector<quint32> maxima(mergeChunks, 0);
+
+    ParallelUtils::forChunks(cells, kMinCellsPerChunk, 0,
+                             [&](qint64 begin, qint64 end, int chunk) {
+        quint32 localMax = 0;
+        for (qint64 i = begin; i < end; ++i) {
+            quint32 sum = 0;
+            for (const std::vector<quint32> &hist : partials) {
+                if (!hist.empty()) {
+                    sum += hist[i];
+                }
+            }
+            out[i] = sum;
+            localMax = qMax(localMax, sum);
+        }
+        maxima[chunk] = localMax;
+    });
+
+    for (quint32 m : maxima) {
+        grid.maxCount = qMax(grid.maxCount, m);
+    }
+    return grid;
+}
+
+QImage DensityBinner::colorize(const Grid &grid)
+{
+    if (grid.width <= 0 || grid.height <= 0) {
+        return QImage();
+    }
+
+    QImage image(grid.width, grid.height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    if (grid.maxCount == 0) {
+        return image;
+    }
+
+    const QVector<QRgb> &palette = DensityBinner::palette();
+    const double scale = 255.0 / std::log1p(static_cast<double>(grid.maxCount));
+
+    // 在进入并行区之前取得像素指针，避免多线程中触发隐式共享的分离
+    uchar *bits = image.bits();
+    const qint64 bytesPerLine = image.bytesPerLine();
+
+    ParallelUtils::forChunks(grid.height, 64, 0, [&](qint64 begin, qint64 end, int) {
+        for (qint64 row = begin; row < end; ++row) {
+            QRgb *line = reinterpret_cast<QRgb *>(bits + row * bytesPerLine);
+            const quint32 *src = grid.counts.constData() + row * grid.width;
+            for (int col = 0; col < grid.width; ++col) {
+                if (src[col] == 0) {
+                    continue;  // 空箱透明
+                }
+                int index = static_cast<int>(std::log1p(static_cast<double>(src[col])) * scale);
+                line[col] = palette[qBound(0, index, 255)];
+            }
+        }
+    });
+    return image;
+}
+
+const QVector<QRgb> &DensityBinner::palette()
+{
+    static const QVector<QRgb> instance = buildPalette();
+    return instance;
+}
+
+// ==================== DensityMapItem ====================
+
+DensityMapItem::DensityMapItem(QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+{
+}
+
+void DensityMapItem::setImage(const QImage &image, const QRectF &targetRect)
+{
+    prepareGeometryChange();
+    m_image = image;
+    m_targetRect = targetRect;
+    update();
+}
+
+QRectF DensityMapItem::boundingRect() const
+{
+    return m_targetRect;
+}
+
+void DensityMapItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                           QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    if (m_image.isNull() || m_targetRect.isEmpty()) {
+        return;
+    }
+    painter->drawImage(m_targetRect, m_image);
+}
@@ -0,0 +1,74 @@
+#ifndef DENSITYMAP_H
+#define DENSITYMAP_H
+
+#include <QGraphicsItem>
+#include <QImage>
+#include <QVector>
+#include <QRectF>
+
+/**
+ * @brief 二维直方图分箱器
+ * 按屏幕分辨率将散点分箱，用于大数据量散点的密度热力图显示
+ */
+class DensityBinner
+{
+public:
+    /**
+     * @brief 分箱结果
+     * counts 按行优先存储，第0行对应Y轴最大值（屏幕顶部）
+     */
+    struct Grid {
+        int width = 0;
+        int height = 0;
+        QVector<quint32> counts;
+        quint32 maxCount = 0;
+    };
+
+    /**
+     * @brief 多线程分箱
+     * 每个线程累加独立的直方图，最后按箱并行合并
+     * @param xData 为空时X为行索引
+     * @param xMin/xMax/yMin/yMax 当前可见的数据范围
+     * @param width/height 绘图区域的像素尺寸
+     */
+    static Grid bin(const QVector<double> &xData,
+                    const QVector<double> &yData,
+                    double xMin, double xMax,
+                    double yMin, double yMax,
+                    int width, int height);
+
+    /**
+     * @brief 按对数刻度着色，空箱保持透明
+     */
+    static QImage colorize(const Grid &grid);
+
+    /**
+     * @brief 256级的感知均匀调色板（近似viridis），时频图等热力图共用
+     */
+    static const QVector<QRgb> &palette();
+};
+
+/**
+ * @brief 密度热力图图层
+ * 作为QChart的子项，将分箱图像绘制在绘图区域内
+ */
+class DensityMapItem : public QGraphicsItem
+{
+public:
+    explicit DensityMapItem(QGraphicsItem *parent = nullptr);
+
+    /**
+     * @brief 设置图像及其在图表坐标系中的目标区域
+     */
+    void setImage(const QImage &image, const QRectF &targetRect);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget = nullptr) override;
+
+private:
+    QImage m_image;
+    QRectF m_targetRect;
+};
+
+#endif // DENSITYMAP_H
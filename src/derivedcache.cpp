@@ -0,0 +1,281 @@
+#include "derivedcache.h"
+#include "parallelutils.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <limits>
+
+namespace {
+// 默认磁盘占用上限（MB）
+const int kDefaultLimitMB = 2048;
+// 列内容哈希记录的上限（MB，记录的数据大多与数据列共享）
+const int kHashMemoLimitMB = 1024;
+// 内容哈希的分块大小（元素数），与线程数无关，保证同一数据的哈希不变
+const qint64 kHashBlock = 1 << 20;
+
+// 文件格式：头部 + 原生字节序的 double 数组
+const quint32 kMagic = 0x4C504443;      // "LPDC"
+const quint32 kFormatVersion = 1;
+const char *const kFileSuffix = ".ldc";
+
+void addString(QCryptographicHash &hash, const QString &text)
+{
+    const QByteArray utf8 = text.toUtf8();
+    hash.addData(QByteArray::number(utf8.size()) + ':');
+    hash.addData(utf8);
+}
+}
+
+DerivedCache& DerivedCache::instance()
+{
+    static DerivedCache cache;
+    return cache;
+}
+
+DerivedCache::DerivedCache()
+    : m_directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/derived")
+    , m_sizeLimit(qint64(kDefaultLimitMB) * 1024 * 1024)
+    , m_usage(-1)
+{
+    m_hashes.setMaxCost(kHashMemoLimitMB * 1024);
+}
+
+QString DerivedCache::filePath(const QByteArray &key) const
+{
+    return m_directory + "/" + QString::fromLatin1(key.toHex()) + kFileSuffix;
+}
+
+QByteArray DerivedCache::columnHash(const QVector<double> &values)
+{
+    const QPair<quintptr, int> memoKey(reinterpret_cast<quintptr>(values.constData()), values.size());
+    {
+        QMutexLocker locker(&m_mutex);
+        if (HashEntry *entry = m_hashes.object(memoKey)) {
+            return entry->hash;
+        }
+    }
+
+    // 各块分别求哈希（并行），再对块哈希序列求总哈希
+    const qint64 count = values.size();
+    const qint64 blocks = (count + kHashBlock - 1) / kHashBlock;
+    QVector<QByteArray> digests(static_cast<int>(blocks));
+    ParallelUtils::forChunks(blocks, 1, 0, [&](qint64 begin, qint64 end, int) {
+        for (qint64 b = begin; b < end; ++b) {
+            const qint64 first = b * kHashBlock;
+            const qint64 n = qMin(kHashBlock, count - first);
+            const QByteArray raw = QByteArray::fromRawData(
+                reinterpret_cast<const char *>(values.constData() + first),
+                static_cast<int>(n * sizeof(double)));
+            digests[static_cast<int>(b)] = QCryptographicHash::hash(raw, QCryptographicHash::Sha256);
+        }
+    });
+
+    QCryptographicHash total(QCryptographicHash::Sha256);
+    total.addData(QByteArray::number(count) + ':');
+    for (const QByteArray &digest : digests) {
+        total.addData(digest);
+    }
+    const QByteArray hash = total.result();
+
+    HashEntry *entry = new HashEntry;
+    entry->values = values;
+    entry->hash = hash;
+    const int cost = qMax(1, static_cast<int>(count * sizeof(double) / 1024));
+    QMutexLocker locker(&m_mutex);
+    m_hashes.insert(memoKey, entry, cost);
+    return hash;
+}
+
+QByteArray DerivedCache::makeKey(const QString &script, bool legacyArrays, const QStringList &inputs,
+                                 const QMap<QString, QVector<double>> &columns)
+{
+    // 每次执行结果可能不同的脚本不缓存
+    static const QRegularExpression volatilePattern(R"(\bMath\s*\.\s*random\b|\bDate\b|\bperformance\b)");
+    if (sizeLimit() == 0 || script.contains(volatilePattern)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArray("LogParser derived column\n"));
+    hash.addData(QByteArray::number(kEngineVersion) + ':' + QT_VERSION_STR + '\n');
+    if (legacyArrays) {
+        hash.addData(QByteArray("legacy arrays\n"));
+    }
+    addString(hash, script);
+    for (const QString &name : inputs) {
+        addString(hash, name);
+        auto it = columns.constFind(name);
+        if (it == columns.constEnd()) {
+            hash.addData(QByteArray("-"));
+        } else {
+            hash.addData(QByteArray("+") + columnHash(it.value()));
+        }
+    }
+    return hash.result();
+}
+
+bool DerivedCache::load(const QByteArray &key, QVector<double> &values)
+{
+    if (key.isEmpty()) {
+        return false;
+    }
+
+    // 读写方式打开，命中后才能更新修改时间（Windows 需要写权限）
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint8 byteOrder = 0;
+    qint64 count = -1;
+    QByteArray storedKey(key.size(), Qt::Uninitialized);
+    in >> magic >> version >> byteOrder;
+    in.readRawData(storedKey.data(), storedKey.size());
+    in >> count;
+
+    const qint64 headerSize = file.pos();
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kFormatVersion ||
+        byteOrder != static_cast<quint8>(QSysInfo::ByteOrder) || storedKey != key ||
+        count <= 0 || count > std::numeric_limits<int>::max() ||
+        file.size() != headerSize + count * qint64(sizeof(double))) {
+        return false;
+    }
+
+    values.resize(static_cast<int>(count));
+    const qint64 bytes = count * qint64(sizeof(double));
+    if (file.read(reinterpret_cast<char *>(values.data()), bytes) != bytes) {
+        values.clear();
+        return false;
+    }
+
+    // 修改时间即最近使用时间，淘汰时按此排序
+    file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+void DerivedCache::store(const QByteArray &key, const QVector<double> &values)
+{
+    if (key.isEmpty() || values.isEmpty()) {
+        return;
+    }
+    // 单个结果超过上限的一半时不缓存，避免一次写入淘汰全部缓存
+    const qint64 bytes = values.size() * qint64(sizeof(double));
+    {
+        QMutexLocker locker(&m_mutex);
+        if (bytes > m_sizeLimit / 2) {
+            return;
+        }
+    }
+
+    QDir().mkpath(m_directory);
+    QSaveFile file(filePath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out << kMagic << kFormatVersion << static_cast<quint8>(QSysInfo::ByteOrder);
+    out.writeRawData(key.constData(), key.size());
+    out << qint64(values.size());
+    file.write(reinterpret_cast<const char *>(values.constData()), bytes);
+    const qint64 written = file.pos();
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    scanLocked();
+    m_usage += written;
+    if (m_usage > m_sizeLimit) {
+        evictLocked();
+    }
+}
+
+void DerivedCache::scanLocked()
+{
+    if (m_usage >= 0) {
+        return;
+    }
+    m_usage = 0;
+    const QFileInfoList files = QDir(m_directory).entryInfoList(
+        QStringList() << QString("*") + kFileSuffix, QDir::Files);
+    for (const QFileInfo &info : files) {
+        m_usage += info.size();
+    }
+}
+
+void DerivedCache::evictLocked()
+{
+    // 从最久未使用的开始删除，降到上限的90%以下，避免每次写入都触发淘汰
+    const QFileInfoList files = QDir(m_directory).entryInfoList(
+        QStringList() << QString("*") + kFileSuffix, QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 usage = 0;
+    for (const QFileInfo &info : files) {
+        usage += info.size();
+    }
+    const qint64 target = m_sizeLimit / 10 * 9;
+    for (const QFileInfo &info : files) {
+        if (usage <= target) {
+            break;
+        }
+        if (QFile::remove(info.filePath())) {
+            usage -= info.size();
+        }
+    }
+    m_usage = usage;
+}
+
+void DerivedCache::setSizeLimit(int megabytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_sizeLimit = qint64(qMax(0, megabytes)) * 1024 * 1024;
+    scanLocked();
+    if (m_usage > m_sizeLimit) {
+        evictLocked();
+    }
+}
+
+int DerivedCache::sizeLimit() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_sizeLimit / (1024 * 1024));
+}
+
+qint64 DerivedCache::diskUsage()
+{
+    QMutexLocker locker(&m_mutex);
+    scanLocked();
+    return m_usage;
+}
+
+void DerivedCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    QDir dir(m_directory);
+    for (const QString &name : dir.entryList(QStringList() << QString("*") + kFileSuffix, QDir::Files)) {
+        dir.remove(name);
+    }
+    m_usage = 0;
+}
+
+void DerivedCache::clearColumnHashes()
+{
+    QMutexLocker locker(&m_mutex);
+    m_hashes.clear();
+}
+
+void DerivedCache::releaseColumnHash(const QVector<double> &values)
+{
+    const QPair<quintptr, int> memoKey(reinterpret_cast<quintptr>(values.constData()), values.size());
+    QMutexLocker locker(&m_mutex);
+    m_hashes.remove(memoKey);
+}
@@ -0,0 +1,103 @@
+#ifndef DERIVEDCACHE_H
+#define DERIVEDCACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QPair>
+
+/**
+ * @brief 派生列结果的磁盘缓存（跨会话，按内容寻址）
+ * 键为 (引擎版本, 脚本文本, 所读取各列的列名和内容哈希) 的 SHA-256，
+ * 同一文件重新打开并应用相同预设时，脚本结果直接从缓存读取。
+ * 每个结果保存为缓存目录下的一个二进制文件，总大小超出上限时删除最久未使用的文件。
+ * 可在多个线程中同时使用
+ */
+class DerivedCache
+{
+public:
+    static DerivedCache& instance();
+
+    DerivedCache(const DerivedCache&) = delete;
+    DerivedCache& operator=(const DerivedCache&) = delete;
+
+    /**
+     * @brief 计算脚本结果的缓存键
+     * @param legacyArrays 脚本按旧版数组接口执行（同一脚本的结果可能不同，分开缓存）
+     * @param inputs 脚本读取的列，不在 columns 中的列按缺失处理
+     * @return 脚本结果不确定（如使用 Math.random、Date）时返回空
+     */
+    QByteArray makeKey(const QString &script, bool legacyArrays, const QStringList &inputs,
+                       const QMap<QString, QVector<double>> &columns);
+
+    /**
+     * @brief 读取缓存的结果，命中时将其标记为最近使用
+     */
+    bool load(const QByteArray &key, QVector<double> &values);
+
+    /**
+     * @brief 保存结果，超出大小上限时淘汰最久未使用的项
+     */
+    void store(const QByteArray &key, const QVector<double> &values);
+
+    /**
+     * @brief 设置/获取磁盘占用上限（MB），0 表示禁用缓存
+     */
+    void setSizeLimit(int megabytes);
+    int sizeLimit() const;
+
+    /**
+     * @brief 当前缓存占用的磁盘空间（字节）
+     */
+    qint64 diskUsage();
+
+    /**
+     * @brief 删除所有缓存文件
+     */
+    void clear();
+
+    /**
+     * @brief 释放列内容哈希的内存记录（载入新文件时调用，不再持有旧数据）
+     */
+    void clearColumnHashes();
+
+    /**
+     * @brief 释放一列数据的内容哈希记录（列存储替换或删除该列时调用）
+     */
+    void releaseColumnHash(const QVector<double> &values);
+
+    /**
+     * @brief 数据列内容的 SHA-256（按固定大小分块并行计算，结果与线程数无关）
+     * 同一份数据的哈希会被记住，不重复计算
+     */
+    QByteArray columnHash(const QVector<double> &values);
+
+    /**
+     * @brief 计算结果的版本：修改 math 函数或表达式求值的数值结果时递增，使旧缓存失效
+     */
+    static const int kEngineVersion = 4;
+
+private:
+    DerivedCache();
+
+    QString filePath(const QByteArray &key) const;
+    void scanLocked();
+    void evictLocked();
+
+    struct HashEntry {
+        QVector<double> values;     // 持有数据，保证键中的地址不被其他数据复用
+        QByteArray hash;
+    };
+
+    QString m_directory;
+    mutable QMutex m_mutex;         // 保护以下成员
+    QCache<QPair<quintptr, int>, HashEntry> m_hashes;    // (数据地址, 长度) -> 哈希，代价单位为KB
+    qint64 m_sizeLimit;             // 字节
+    qint64 m_usage;                 // 字节，-1 表示尚未扫描缓存目录
+};
+
+#endif // DERIVEDCACHE_H
@@ -0,0 +1,749 @@
+#include "expressionplan.h"
+#include "parallelutils.h"
+#include <QtMath>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// 每块求值的元素数（所有暂存块都留在一级/二级缓存内）
+const int kBlockSize = 512;
+// 每个线程至少处理的元素数
+const qint64 kMinPointsPerChunk = 64 * 1024;
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+inline bool truthy(double v)
+{
+    return v != 0 && v == v;
+}
+
+// ==================== 词法分析 ====================
+
+struct Token {
+    enum Type { Number, Identifier, String, Punct, End };
+    Type type = End;
+    QString text;
+    double number = 0.0;
+    bool newlineBefore = false;     // 与前一个记号之间有换行
+};
+
+bool isIdentifierStart(QChar c)
+{
+    return c.isLetter() || c == QLatin1Char('_') || c == QLatin1Char('$');
+}
+
+bool isIdentifierPart(QChar c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char('_') || c == QLatin1Char('$');
+}
+
+bool tokenize(const QString &text, QVector<Token> &tokens)
+{
+    static const char *const puncts[] = {
+        "===", "!==", "**", "<=", ">=", "==", "!=", "&&", "||",
+        "+", "-", "*", "/", "%", "(", ")", ",", ".", "[", "]", "?", ":", "<", ">", "!", ";"
+    };
+
+    const int n = text.size();
+    int pos = 0;
+    bool newline = false;
+    while (true) {
+        // 空白和注释
+        while (pos < n) {
+            const QChar c = text.at(pos);
+            if (c == QLatin1Char('\n')) {
+                newline = true;
+                ++pos;
+            } else if (c.isSpace()) {
+                ++pos;
+            } else if (c == QLatin1Char('/') && pos + 1 < n && text.at(pos + 1) == QLatin1Char('/')) {
+                while (pos < n && text.at(pos) != QLatin1Char('\n')) ++pos;
+            } else if (c == QLatin1Char('/') && pos + 1 < n && text.at(pos + 1) == QLatin1Char('*')) {
+                const int close = text.indexOf(QLatin1String("*/"), pos + 2);
+                if (close < 0) return false;
+                if (text.mid(pos, close - pos).contains(QLatin1Char('\n'))) newline = true;
+                pos = close + 2;
+            } else {
+                break;
+            }
+        }
+
+        Token token;
+        token.newlineBefore = newline;
+        newline = false;
+        if (pos >= n) {
+            tokens.append(token);
+            return true;
+        }
+
+        const QChar c = text.at(pos);
+        const int start = pos;
+        if (c.isDigit() || (c == QLatin1Char('.') && pos + 1 < n && text.at(pos + 1).isDigit())) {
+            while (pos < n && text.at(pos).isDigit()) ++pos;
+            if (pos < n && text.at(pos) == QLatin1Char('.')) {
+                ++pos;
+                while (pos < n && text.at(pos).isDigit()) ++pos;
+            }
+            if (pos < n && (text.at(pos) == QLatin1Char('e') || text.at(pos) == QLatin1Char('E'))) {
+                ++pos;
+                if (pos < n && (text.at(pos) == QLatin1Char('+') || text.at(pos) == QLatin1Char('-'))) ++pos;
+                if (pos >= n || !text.at(pos).isDigit()) return false;
+                while (pos < n && text.at(pos).isDigit()) ++pos;
+            }
+            // 十六进制、数字后紧跟标识符等形式不支持
+            if (pos < n && isIdentifierPart(text.at(pos))) return false;
+            bool ok = false;
+            token.type = Token::Number;
+            token.number = text.mid(start, pos - start).toDouble(&ok);
+            if (!ok) return false;
+        } else if (isIdentifierStart(c)) {
+            while (pos < n && isIdentifierPart(text.at(pos))) ++pos;
+            token.type = Token::Identifier;
+            token.text = text.mid(start, pos - start);
+        } else if (c == QLatin1Char('"') || c == QLatin1Char('\'')) {
+            // 只用于 data["列名"]，不支持转义
+            ++pos;
+            while (pos < n && text.at(pos) != c) {
+                if (text.at(pos) == QLatin1Char('\\') || text.at(pos) == QLatin1Char('\n')) return false;
+                ++pos;
+            }
+            if (pos >= n) return false;
+            token.type = Token::String;
+            token.text = text.mid(start + 1, pos - start - 1);
+            ++pos;
+        } else {
+            token.type = Token::Punct;
+            for (const char *p : puncts) {
+                const QLatin1String punct(p);
+                if (text.mid(pos, punct.size()) == punct) {
+                    token.text = punct;
+                    break;
+                }
+            }
+            if (token.text.isEmpty()) return false;
+            pos += token.text.size();
+        }
+        tokens.append(token);
+    }
+}
+
+// ==================== 语法分析 ====================
+
+struct Node {
+    enum Type { Const, Column, Unary, Binary, Select };
+    Type type;
+    ExpressionPlan::Op op = ExpressionPlan::Neg;
+    double value = 0.0;
+    int column = 0;
+    int child[3] = {-1, -1, -1};
+};
+
+class Parser
+{
+public:
+    Parser(const QVector<Token> &tokens, QStringList &columns)
+        : m_tokens(tokens), m_columns(columns)
+    {
+    }
+
+    const QVector<Node> &nodes() const { return m_nodes; }
+
+    /**
+     * @brief 解析整个脚本：[return] 表达式 [;]
+     */
+    int parseScript()
+    {
+        if (peekIdentifier("return")) {
+            ++m_pos;
+            // return 后换行会被JS自动补分号，返回 undefined
+            if (m_tokens[m_pos].newlineBefore) return -1;
+        }
+        const int root = parseConditional();
+        if (root < 0) return -1;
+        while (peekPunct(";")) ++m_pos;
+        return m_tokens[m_pos].type == Token::End ? root : -1;
+    }
+
+private:
+    bool peekPunct(const char *punct) const
+    {
+        const Token &t = m_tokens[m_pos];
+        return t.type == Token::Punct && t.text == QLatin1String(punct);
+    }
+
+    bool peekIdentifier(const char *name) const
+    {
+        const Token &t = m_tokens[m_pos];
+        return t.type == Token::Identifier && t.text == QLatin1String(name);
+    }
+
+    bool expect(const char *punct)
+    {
+        if (!peekPunct(punct)) return false;
+        ++m_pos;
+        return true;
+    }
+
+    int makeConst(double value)
+    {
+        Node node;
+        node.type = Node::Const;
+        node.value = value;
+        m_nodes.append(node);
+        return m_nodes.size() - 1;
+    }
+
+    // 操作数均为常量时直接折叠
+    int makeUnary(ExpressionPlan::Op op, int a)
+    {
+        if (a < 0) return -1;
+        if (m_nodes[a].type == Node::Const) {
+            return makeConst(ExpressionPlan::applyUnary(op, m_nodes[a].value));
+        }
+        Node node;
+        node.type = Node::Unary;
+        node.op = op;
+        node.child[0] = a;
+        m_nodes.append(node);
+        return m_nodes.size() - 1;
+    }
+
+    int makeBinary(ExpressionPlan::Op op, int a, int b)
+    {
+        if (a < 0 || b < 0) return -1;
+        if (m_nodes[a].type == Node::Const && m_nodes[b].type == Node::Const) {
+            return makeConst(ExpressionPlan::applyBinary(op, m_nodes[a].value, m_nodes[b].value));
+        }
+        Node node;
+        node.type = Node::Binary;
+        node.op = op;
+        node.child[0] = a;
+        node.child[1] = b;
+        m_nodes.append(node);
+        return m_nodes.size() - 1;
+    }
+
+    int makeSelect(int condition, int a, int b)
+    {
+        if (condition < 0 || a < 0 || b < 0) return -1;
+        if (m_nodes[condition].type == Node::Const) {
+            return truthy(m_nodes[condition].value) ? a : b;
+        }
+        Node node;
+        node.type = Node::Select;
+        node.op = ExpressionPlan::Select;
+        node.child[0] = condition;
+        node.child[1] = a;
+        node.child[2] = b;
+        m_nodes.append(node);
+        return m_nodes.size() - 1;
+    }
+
+    int parseConditional()
+    {
+        const int condition = parseBinary(0);
+        if (condition < 0 || !peekPunct("?")) return condition;
+        ++m_pos;
+        const int a = parseConditional();
+        if (!expect(":")) return -1;
+        const int b = parseConditional();
+        return makeSelect(condition, a, b);
+    }
+
+    // 二元运算按优先级逐层解析（均为左结合）
+    int parseBinary(int level)
+    {
+        struct Level { const char *puncts[4]; ExpressionPlan::Op ops[4]; };
+        static const Level levels[] = {
+            {{"||"}, {ExpressionPlan::Or}},
+            {{"&&"}, {ExpressionPlan::And}},
+            {{"===", "!==", "==", "!="}, {ExpressionPlan::Eq, ExpressionPlan::Ne, ExpressionPlan::Eq, ExpressionPlan::Ne}},
+            {{"<=", ">=", "<", ">"}, {ExpressionPlan::Le, ExpressionPlan::Ge, ExpressionPlan::Lt, ExpressionPlan::Gt}},
+            {{"+", "-"}, {ExpressionPlan::Add, ExpressionPlan::Sub}},
+            {{"*", "/", "%"}, {ExpressionPlan::Mul, ExpressionPlan::Div, ExpressionPlan::Mod}}
+        };
+        const int levelCount = sizeof(levels) / sizeof(levels[0]);
+        if (level >= levelCount) {
+            return parseUnary();
+        }
+
+        int left = parseBinary(level + 1);
+        while (left >= 0) {
+            int matched = -1;
+            for (int i = 0; i < 4 && levels[level].puncts[i]; ++i) {
+                if (peekPunct(levels[level].puncts[i])) {
+                    matched = i;
+                    break;
+                }
+            }
+            if (matched < 0) break;
+            ++m_pos;
+            left = makeBinary(levels[level].ops[matched], left, parseBinary(level + 1));
+        }
+        return left;
+    }
+
+    int parseUnary()
+    {
+        if (peekPunct("-")) {
+            ++m_pos;
+            return makeUnary(ExpressionPlan::Neg, parseUnary());
+        }
+        if (peekPunct("+")) {
+            ++m_pos;
+            return parseUnary();
+        }
+        if (peekPunct("!")) {
+            ++m_pos;
+            return makeUnary(ExpressionPlan::Not, parseUnary());
+        }
+        const int base = parsePrimary();
+        if (base >= 0 && peekPunct("**")) {
+            ++m_pos;
+            // ** 为右结合
+            return makeBinary(ExpressionPlan::Pow, base, parseUnary());
+        }
+        return base;
+    }
+
+    int parsePrimary()
+    {
+        const Token &t = m_tokens[m_pos];
+        if (t.type == Token::Number) {
+            ++m_pos;
+            return makeConst(t.number);
+        }
+        if (expect("(")) {
+            const int inner = parseConditional();
+            return expect(")") ? inner : -1;
+        }
+        if (t.type != Token::Identifier) {
+            return -1;
+        }
+        ++m_pos;
+        if (t.text == QLatin1String("NaN")) {
+            return makeConst(kNaN);
+        }
+        if (t.text == QLatin1String("Infinity")) {
+            return makeConst(std::numeric_limits<double>::infinity());
+        }
+        if (t.text == QLatin1String("data")) {
+            return parseColumn();
+        }
+        if (t.text == QLatin1String("Math")) {
+            return parseMath();
+        }
+        return -1;
+    }
+
+    int parseColumn()
+    {
+        QString name;
+        if (expect(".")) {
+            if (m_tokens[m_pos].type != Token::Identifier) return -1;
+            name = m_tokens[m_pos++].text;
+        } else if (expect("[")) {
+            if (m_tokens[m_pos].type != Token::String) return -1;
+            name = m_tokens[m_pos++].text;
+            if (!expect("]")) return -1;
+        } else {
+            return -1;
+        }
+        // 列之后不能再有成员访问或下标（如 data.X[i]、data.X.length）
+        if (peekPunct(".") || peekPunct("[") || peekPunct("(")) return -1;
+
+        int index = m_columns.indexOf(name);
+        if (index < 0) {
+            m_columns.append(name);
+            index = m_columns.size() - 1;
+        }
+        Node node;
+        node.type = Node::Column;
+        node.column = index;
+        m_nodes.append(node);
+        return m_nodes.size() - 1;
+    }
+
+    int parseMath()
+    {
+        struct Constant { const char *name; double value; };
+        static const Constant constants[] = {
+            {"PI", M_PI}, {"E", M_E}, {"LN2", M_LN2}, {"LN10", M_LN10},
+            {"LOG2E", M_LOG2E}, {"LOG10E", M_LOG10E}, {"SQRT2", M_SQRT2}, {"SQRT1_2", M_SQRT1_2}
+        };
+        struct Function { const char *name; ExpressionPlan::Op op; int arity; };    // arity < 0 表示可变参数
+        static const Function functions[] = {
+            {"abs", ExpressionPlan::Abs, 1}, {"sqrt", ExpressionPlan::Sqrt, 1},
+            {"cbrt", ExpressionPlan::Cbrt, 1}, {"exp", ExpressionPlan::Exp, 1},
+            {"log", ExpressionPlan::Log, 1}, {"log10", ExpressionPlan::Log10, 1},
+            {"log2", ExpressionPlan::Log2, 1}, {"sin", ExpressionPlan::Sin, 1},
+            {"cos", ExpressionPlan::Cos, 1}, {"tan", ExpressionPlan::Tan, 1},
+            {"asin", ExpressionPlan::Asin, 1}, {"acos", ExpressionPlan::Acos, 1},
+            {"atan", ExpressionPlan::Atan, 1}, {"sinh", ExpressionPlan::Sinh, 1},
+            {"cosh", ExpressionPlan::Cosh, 1}, {"tanh", ExpressionPlan::Tanh, 1},
+            {"floor", ExpressionPlan::Floor, 1}, {"ceil", ExpressionPlan::Ceil, 1},
+            {"round", ExpressionPlan::Round, 1}, {"trunc", ExpressionPlan::Trunc, 1},
+            {"sign", ExpressionPlan::Sign, 1}, {"pow", ExpressionPlan::Pow, 2},
+            {"atan2", ExpressionPlan::Atan2, 2}, {"min", ExpressionPlan::Min, -1},
+            {"max", ExpressionPlan::Max, -1}, {"hypot", ExpressionPlan::Hypot, -1}
+        };
+
+        if (!expect(".") || m_tokens[m_pos].type != Token::Identifier) return -1;
+        const QString name = m_tokens[m_pos++].text;
+
+        for (const Constant &constant : constants) {
+            if (name == QLatin1String(constant.name)) {
+                return makeConst(constant.value);
+            }
+        }
+
+        const Function *function = nullptr;
+        for (const Function &f : functions) {
+            if (name == QLatin1String(f.name)) {
+                function = &f;
+                break;
+            }
+        }
+        if (!function || !expect("(")) return -1;
+
+        QVector<int> args;
+        if (!peekPunct(")")) {
+            do {
+                const int arg = parseConditional();
+                if (arg < 0) return -1;
+                args.append(arg);
+            } while (expect(","));
+        }
+        if (!expect(")")) return -1;
+
+        if (function->arity >= 0) {
+            if (args.size() != function->arity) return -1;
+            return function->arity == 1 ? makeUnary(function->op, args[0])
+                                        : makeBinary(function->op, args[0], args[1]);
+        }
+
+        // 可变参数：两两折叠
+        if (args.isEmpty()) {
+            switch (function->op) {
+            case ExpressionPlan::Min: return makeConst(std::numeric_limits<double>::infinity());
+            case ExpressionPlan::Max: return makeConst(-std::numeric_limits<double>::infinity());
+            default: return makeConst(0.0);
+            }
+        }
+        int result = function->op == ExpressionPlan::Hypot ? makeUnary(ExpressionPlan::Abs, args[0]) : args[0];
+        for (int i = 1; i < args.size(); ++i) {
+            result = makeBinary(function->op, result, args[i]);
+        }
+        return result;
+    }
+
+    const QVector<Token> &m_tokens;
+    QStringList &m_columns;
+    QVector<Node> m_nodes;
+    int m_pos = 0;
+};
+
+// ==================== 代码生成 ====================
+
+class CodeGenerator
+{
+public:
+    CodeGenerator(const QVector<Node> &nodes, QVector<ExpressionPlan::Instruction> &code)
+        : m_nodes(nodes), m_code(code)
+    {
+    }
+
+    int slotCount() const { return m_maxSlots; }
+
+    // 暂存块按栈分配：子表达式的结果在父节点运算后立即释放，结果可写回操作数所在的块
+    ExpressionPlan::Operand generate(int index)
+    {
+        const Node &node = m_nodes[index];
+        ExpressionPlan::Operand operand;
+        switch (node.type) {
+        case Node::Const:
+            operand.kind = ExpressionPlan::Operand::Const;
+            operand.value = node.value;
+            return operand;
+        case Node::Column:
+            operand.kind = ExpressionPlan::Operand::Column;
+            operand.index = node.column;
+            return operand;
+        default:
+            break;
+        }
+
+        ExpressionPlan::Instruction instruction;
+        instruction.op = node.op;
+        ExpressionPlan::Operand *operands[3] = {&instruction.a, &instruction.b, &instruction.c};
+        int childCount = 0;
+        for (int i = 0; i < 3 && node.child[i] >= 0; ++i) {
+            *operands[i] = generate(node.child[i]);
+            ++childCount;
+        }
+        for (int i = childCount - 1; i >= 0; --i) {
+            if (operands[i]->kind == ExpressionPlan::Operand::Slot) {
+                --m_nextSlot;
+            }
+        }
+        instruction.dst = m_nextSlot++;
+        m_maxSlots = qMax(m_maxSlots, m_nextSlot);
+        m_code.append(instruction);
+
+        operand.kind = ExpressionPlan::Operand::Slot;
+        operand.index = instruction.dst;
+        return operand;
+    }
+
+private:
+    const QVector<Node> &m_nodes;
+    QVector<ExpressionPlan::Instruction> &m_code;
+    int m_nextSlot = 0;
+    int m_maxSlots = 0;
+};
+
+// ==================== 按块执行 ====================
+
+struct Frame {
+    const double *const *columns;
+    double *scratch;
+    qint64 offset;
+
+    const double *pointer(const ExpressionPlan::Operand &operand) const
+    {
+        return operand.kind == ExpressionPlan::Operand::Column
+            ? columns[operand.index] + offset
+            : scratch + qint64(operand.index) * kBlockSize;
+    }
+
+    double at(const ExpressionPlan::Operand &operand, int j) const
+    {
+        return operand.kind == ExpressionPlan::Operand::Const ? operand.value : pointer(operand)[j];
+    }
+};
+
+template <typename Fn>
+void unaryBlock(double *dst, const double *a, int len, Fn fn)
+{
+    for (int j = 0; j < len; ++j) {
+        dst[j] = fn(a[j]);
+    }
+}
+
+// 常量操作数不展开成数组，单独生成循环便于编译器向量化
+template <typename Fn>
+void binaryBlock(double *dst, const ExpressionPlan::Instruction &ins, const Frame &frame, int len, Fn fn)
+{
+    if (ins.a.kind == ExpressionPlan::Operand::Const) {
+        const double a = ins.a.value;
+        const double *b = frame.pointer(ins.b);
+        for (int j = 0; j < len; ++j) dst[j] = fn(a, b[j]);
+    } else if (ins.b.kind == ExpressionPlan::Operand::Const) {
+        const double *a = frame.pointer(ins.a);
+        const double b = ins.b.value;
+        for (int j = 0; j < len; ++j) dst[j] = fn(a[j], b);
+    } else {
+        const double *a = frame.pointer(ins.a);
+        const double *b = frame.pointer(ins.b);
+        for (int j = 0; j < len; ++j) dst[j] = fn(a[j], b[j]);
+    }
+}
+
+void execute(const ExpressionPlan::Instruction &ins, double *dst, const Frame &frame, int len)
+{
+    typedef ExpressionPlan P;
+    switch (ins.op) {
+    case P::Neg:
+        unaryBlock(dst, frame.pointer(ins.a), len, [](double x) { return -x; });
+        return;
+    case P::Abs:
+        unaryBlock(dst, frame.pointer(ins.a), len, [](double x) { return std::fabs(x); });
+        return;
+    case P::Sqrt:
+        unaryBlock(dst, frame.pointer(ins.a), len, [](double x) { return std::sqrt(x); });
+        return;
+    case P::Add:
+        binaryBlock(dst, ins, frame, len, [](double x, double y) { return x + y; });
+        return;
+    case P::Sub:
+        binaryBlock(dst, ins, frame, len, [](double x, double y) { return x - y; });
+        return;
+    case P::Mul:
+        binaryBlock(dst, ins, frame, len, [](double x, double y) { return x * y; });
+        return;
+    case P::Div:
+        binaryBlock(dst, ins, frame, len, [](double x, double y) { return x / y; });
+        return;
+    case P::Lt:
+        binaryBlock(dst, ins, frame, len, [](double x, double y) { return x < y ? 1.0 : 0.0; });
+        return;
+    case P::Le:
+        binaryBlock(dst, ins, frame, len, [](double x, double y) { return x <= y ? 1.0 : 0.0; });
+        return;
+    case P::Gt:
+        binaryBlock(dst, ins, frame, len, [](double x, double y) { return x > y ? 1.0 : 0.0; });
+        return;
+    case P::Ge:
+        binaryBlock(dst, ins, frame, len, [](double x, double y) { return x >= y ? 1.0 : 0.0; });
+        return;
+    case P::Select:
+        for (int j = 0; j < len; ++j) {
+            dst[j] = truthy(frame.at(ins.a, j)) ? frame.at(ins.b, j) : frame.at(ins.c, j);
+        }
+        return;
+    default:
+        break;
+    }
+
+    // 其余运算（超越函数等）逐元素调用标量实现
+    if (ins.op < P::Add) {
+        const P::Op op = ins.op;
+        unaryBlock(dst, frame.pointer(ins.a), len, [op](double x) { return P::applyUnary(op, x); });
+    } else {
+        const P::Op op = ins.op;
+        binaryBlock(dst, ins, frame, len, [op](double x, double y) { return P::applyBinary(op, x, y); });
+    }
+}
+
+} // namespace
+
+// ==================== ExpressionPlan ====================
+
+double ExpressionPlan::applyUnary(Op op, double a)
+{
+    switch (op) {
+    case Neg: return -a;
+    case Not: return truthy(a) ? 0.0 : 1.0;
+    case Abs: return std::fabs(a);
+    case Sqrt: return std::sqrt(a);
+    case Cbrt: return std::cbrt(a);
+    case Exp: return std::exp(a);
+    case Log: return std::log(a);
+    case Log10: return std::log10(a);
+    case Log2: return std::log2(a);
+    case Sin: return std::sin(a);
+    case Cos: return std::cos(a);
+    case Tan: return std::tan(a);
+    case Asin: return std::asin(a);
+    case Acos: return std::acos(a);
+    case Atan: return std::atan(a);
+    case Sinh: return std::sinh(a);
+    case Cosh: return std::cosh(a);
+    case Tanh: return std::tanh(a);
+    case Floor: return std::floor(a);
+    case Ceil: return std::ceil(a);
+    case Trunc: return std::trunc(a);
+    case Round: {
+        // JS 的 Math.round：.5 向正无穷取整
+        const double r = std::floor(a);
+        return (a - r >= 0.5) ? r + 1 : r;
+    }
+    case Sign: return a > 0 ? 1.0 : (a < 0 ? -1.0 : a);
+    default: return kNaN;
+    }
+}
+
+double ExpressionPlan::applyBinary(Op op, double a, double b)
+{
+    switch (op) {
+    case Add: return a + b;
+    case Sub: return a - b;
+    case Mul: return a * b;
+    case Div: return a / b;
+    case Mod: return std::fmod(a, b);
+    case Pow:
+        // JS 中 1 的 NaN/无穷次幂为 NaN
+        if (std::isnan(b) || (std::fabs(a) == 1 && std::isinf(b))) return kNaN;
+        return std::pow(a, b);
+    case Atan2: return std::atan2(a, b);
+    case Min: return (std::isnan(a) || std::isnan(b)) ? kNaN : (a < b ? a : b);
+    case Max: return (std::isnan(a) || std::isnan(b)) ? kNaN : (a > b ? a : b);
+    case Hypot: return std::hypot(a, b);
+    case Lt: return a < b ? 1.0 : 0.0;
+    case Le: return a <= b ? 1.0 : 0.0;
+    case Gt: return a > b ? 1.0 : 0.0;
+    case Ge: return a >= b ? 1.0 : 0.0;
+    case Eq: return a == b ? 1.0 : 0.0;
+    case Ne: return a != b ? 1.0 : 0.0;
+    case And: return truthy(a) ? b : a;
+    case Or: return truthy(a) ? a : b;
+    default: return kNaN;
+    }
+}
+
+bool ExpressionPlan::compile(const QString &script)
+{
+    m_columns.clear();
+    m_code.clear();
+    m_root = Operand();
+    m_slotCount = 0;
+
+    QVector<Token> tokens;
+    if (!tokenize(script, tokens)) {
+        return false;
+    }
+
+    QStringList columns;
+    Parser parser(tokens, columns);
+    const int root = parser.parseScript();
+    // 不引用任何列的表达式不是逐元素公式
+    if (root < 0 || columns.isEmpty() || parser.nodes()[root].type == Node::Const) {
+        return false;
+    }
+
+    CodeGenerator generator(parser.nodes(), m_code);
+    m_root = generator.generate(root);
+    m_slotCount = generator.slotCount();
+    m_columns = columns;
+    return true;
+}
+
+bool ExpressionPlan::evaluate(const QMap<QString, QVector<double>> &columns, QVector<double> &result) const
+{
+    if (!isValid()) {
+        return false;
+    }
+
+    QVector<const double *> pointers;
+    int count = -1;
+    for (const QString &name : m_columns) {
+        auto it = columns.constFind(name);
+        if (it == columns.constEnd()) {
+            return false;
+        }
+        pointers.append(it.value().constData());
+        count = count < 0 ? it.value().size() : qMin(count, it.value().size());
+    }
+
+    // 公式只是单独一列：直接共享该列
+    if (m_root.kind == Operand::Column) {
+        const QVector<double> &source = columns.value(m_columns[m_root.index]);
+        result = source.size() == count ? source : source.mid(0, count);
+        return true;
+    }
+
+    result.resize(count);
+    double *out = result.data();
+    const double *const *columnPointers = pointers.constData();
+    const int slotCount = m_slotCount;
+    const QVector<Instruction> &code = m_code;
+    ParallelUtils::forChunks(count, kMinPointsPerChunk, 0, [&](qint64 begin, qint64 end, int) {
+        std::vector<double> scratch(qMax(1, slotCount) * kBlockSize);
+        Frame frame = {columnPointers, scratch.data(), 0};
+        for (qint64 offset = begin; offset < end; offset += kBlockSize) {
+            const int len = static_cast<int>(qMin<qint64>(kBlockSize, end - offset));
+            frame.offset = offset;
+            for (int i = 0; i < code.size(); ++i) {
+                // 最后一条指令直接写入结果
+                double *dst = (i == code.size() - 1)
+                    ? out + offset
+                    : scratch.data() + qint64(code[i].dst) * kBlockSize;
+                execute(code[i], dst, frame, len);
+            }
+        }
+    });
+    return true;
+}
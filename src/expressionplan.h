@@ -0,0 +1,78 @@
+#ifndef EXPRESSIONPLAN_H
+#define EXPRESSIONPLAN_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+
+/**
+ * @brief 逐元素公式的原生求值计划
+ * 识别 "return 表达式;" 形式的纯公式脚本，例如 (data.P1 - data.P2) * 0.001 + data.Offset，
+ * 把其中的数据列视为逐元素运算，编译为指令序列后按小块多线程求值：
+ * 各步运算在缓存内的小块上融合执行，不生成整列长度的中间数组。
+ * 支持的语法：
+ *   - 数字、NaN、Infinity，data.列名 / data["列名"]
+ *   - 运算符 + - * / % **、比较 < <= > >= == != === !==、! && ||、三元 ?:
+ *   - Math 常量（PI、E 等）和常用函数（abs、sqrt、exp、log、sin、pow、min、max、atan2 等）
+ * 其他脚本编译失败，由 QJSEngine 执行
+ */
+class ExpressionPlan
+{
+public:
+    /**
+     * @brief 编译脚本，不是受支持的公式时返回 false
+     */
+    bool compile(const QString &script);
+
+    bool isValid() const { return m_root.kind != Operand::None; }
+
+    /**
+     * @brief 公式引用的数据列
+     */
+    QStringList columns() const { return m_columns; }
+
+    /**
+     * @brief 求值，结果长度取所引用列中最短者
+     * @return 引用的列不存在时返回 false
+     */
+    bool evaluate(const QMap<QString, QVector<double>> &columns, QVector<double> &result) const;
+
+    enum Op {
+        // 一元
+        Neg, Not, Abs, Sqrt, Cbrt, Exp, Log, Log10, Log2,
+        Sin, Cos, Tan, Asin, Acos, Atan, Sinh, Cosh, Tanh,
+        Floor, Ceil, Round, Trunc, Sign,
+        // 二元
+        Add, Sub, Mul, Div, Mod, Pow, Atan2, Min, Max, Hypot,
+        Lt, Le, Gt, Ge, Eq, Ne, And, Or,
+        // 三元
+        Select
+    };
+
+    struct Operand {
+        enum Kind { None, Const, Column, Slot };
+        Kind kind = None;
+        int index = 0;          // 列序号或暂存块序号
+        double value = 0.0;     // 常量值
+    };
+
+    struct Instruction {
+        Op op;
+        int dst;                // 结果写入的暂存块
+        Operand a;
+        Operand b;
+        Operand c;
+    };
+
+    static double applyUnary(Op op, double a);
+    static double applyBinary(Op op, double a, double b);
+
+private:
+    QStringList m_columns;
+    QVector<Instruction> m_code;
+    Operand m_root;
+    int m_slotCount = 0;
+};
+
+#endif // EXPRESSIONPLAN_H
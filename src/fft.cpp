@@ -0,0 +1,559 @@
+#include "fft.h"
+#include "parallelutils.h"
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+// 计划缓存的内存上限（KB）
+const int kMaxCacheKB = 256 * 1024;
+// 超过该长度时在多个线程上执行（最外层的子变换和蝶形运算）
+const int kMinParallelSize = 1 << 16;
+// 蝶形运算、逐点运算每块至少处理的点数
+const qint64 kMinPointsPerChunk = 16 * 1024;
+// 大于该值的质因数改用 Bluestein：通用蝶形的代价与基数成正比
+const int kMaxRadix = 64;
+// 较短的序列直接计算卷积
+const int kMinFftConvolve = 64;
+
+typedef QCache<int, QSharedPointer<const FftPlan>> PlanCache;
+
+QMutex &cacheMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+PlanCache &cache()
+{
+    static PlanCache instance(kMaxCacheKB);
+    return instance;
+}
+
+/**
+ * @brief 按块并行执行逐点运算
+ */
+template <typename Fn>
+void forPoints(qint64 count, Fn fn)
+{
+    ParallelUtils::forChunks(count, kMinPointsPerChunk, 0, [&](qint64 begin, qint64 end, int) {
+        fn(begin, end);
+    });
+}
+
+/**
+ * @brief 分解长度：优先 4，其次 2、3、5 及更大的质数
+ */
+std::vector<int> factorize(int n)
+{
+    std::vector<int> factors;
+    int p = 4;
+    const int floorSqrt = static_cast<int>(std::floor(std::sqrt(static_cast<double>(n))));
+    do {
+        while (n % p != 0) {
+            switch (p) {
+            case 4: p = 2; break;
+            case 2: p = 3; break;
+            default: p += 2; break;
+            }
+            if (p > floorSqrt) {
+                p = n;
+            }
+        }
+        n /= p;
+        factors.push_back(p);
+        factors.push_back(n);
+    } while (n > 1);
+    return factors;
+}
+
+/**
+ * @brief 实数变换拆分时用到的单位根 e^(-2πik/n)，k ∈ [0, n/2]
+ * 分解为 coarse[k/64]·fine[k%64]，两张小表都精确计算，误差与逐个计算相当
+ */
+class SplitTwiddles
+{
+public:
+    explicit SplitTwiddles(int n)
+        : m_fine(kFineSize), m_coarse(n / 2 / kFineSize + 1)
+    {
+        for (int k = 0; k < kFineSize; ++k) {
+            m_fine[k] = std::polar(1.0, -2.0 * kPi * k / n);
+        }
+        for (size_t k = 0; k < m_coarse.size(); ++k) {
+            m_coarse[k] = std::polar(1.0, -2.0 * kPi * static_cast<double>(k * kFineSize) / n);
+        }
+    }
+
+    Complex at(qint64 k) const { return m_coarse[k / kFineSize] * m_fine[k % kFineSize]; }
+
+private:
+    static const int kFineSize = 64;
+    std::vector<Complex> m_fine;
+    std::vector<Complex> m_coarse;
+};
+}
+
+QSharedPointer<const FftPlan> FftPlan::get(int n)
+{
+    {
+        QMutexLocker locker(&cacheMutex());
+        if (QSharedPointer<const FftPlan> *plan = cache().object(n)) {
+            return *plan;
+        }
+    }
+
+    // 创建不持锁进行；Bluestein 计划会递归获取内部计划
+    QSharedPointer<const FftPlan> plan(new FftPlan(n));
+    const int cost = static_cast<int>(plan->memoryUsage() / 1024 + 1);
+    QMutexLocker locker(&cacheMutex());
+    if (QSharedPointer<const FftPlan> *existing = cache().object(n)) {
+        return *existing;
+    }
+    cache().insert(n, new QSharedPointer<const FftPlan>(plan), cost);
+    return plan;
+}
+
+void FftPlan::clearCache()
+{
+    QMutexLocker locker(&cacheMutex());
+    cache().clear();
+}
+
+FftPlan::FftPlan(int n)
+    : m_size(qMax(1, n))
+{
+    const std::vector<int> factors = factorize(m_size);
+    int largest = 1;
+    for (size_t i = 0; i < factors.size(); i += 2) {
+        largest = qMax(largest, factors[i]);
+    }
+
+    if (largest <= kMaxRadix) {
+        m_factors = factors;
+        m_twiddles.resize(m_size);
+        Complex *twiddles = m_twiddles.data();
+        const int size = m_size;
+        forPoints(m_size, [&](qint64 begin, qint64 end) {
+            for (qint64 k = begin; k < end; ++k) {
+                twiddles[k] = std::polar(1.0, -2.0 * kPi * static_cast<double>(k) / size);
+            }
+        });
+        return;
+    }
+
+    // Bluestein：jk = (j² + k² - (k-j)²) / 2，变换化为与共轭 chirp 的循环卷积
+    int inner = 1;
+    while (inner < 2 * m_size - 1) {
+        inner <<= 1;
+    }
+    m_inner = get(inner);
+
+    m_chirp.resize(m_size);
+    const qint64 period = 2 * qint64(m_size);
+    for (qint64 k = 0; k < m_size; ++k) {
+        // k² 对 2n 取模后再换算角度，避免大 k 时的精度损失
+        const qint64 k2 = (k * k) % period;
+        m_chirp[k] = std::polar(1.0, -kPi * static_cast<double>(k2) / m_size);
+    }
+
+    std::vector<Complex> kernel(inner, Complex(0.0, 0.0));
+    kernel[0] = std::conj(m_chirp[0]);
+    for (int k = 1; k < m_size; ++k) {
+        kernel[k] = std::conj(m_chirp[k]);
+        kernel[inner - k] = kernel[k];
+    }
+    m_chirpSpectrum.resize(inner);
+    m_inner->forward(kernel.data(), m_chirpSpectrum.data());
+    const double scale = 1.0 / inner;
+    for (Complex &value : m_chirpSpectrum) {
+        value *= scale;
+    }
+}
+
+qint64 FftPlan::memoryUsage() const
+{
+    const qint64 elements = qint64(m_twiddles.size()) + qint64(m_chirp.size()) +
+                            qint64(m_chirpSpectrum.size());
+    return elements * qint64(sizeof(Complex)) + qint64(m_factors.size()) * qint64(sizeof(int));
+}
+
+void FftPlan::forward(const Complex *in, Complex *out) const
+{
+    if (in == out) {
+        const std::vector<Complex> copy(in, in + m_size);
+        transform(copy.data(), out);
+    } else {
+        transform(in, out);
+    }
+}
+
+void FftPlan::inverse(const Complex *in, Complex *out) const
+{
+    // 逆变换 = conj(正变换(conj(x)))
+    std::vector<Complex> conjugated(m_size);
+    Complex *data = conjugated.data();
+    forPoints(m_size, [&](qint64 begin, qint64 end) {
+        for (qint64 k = begin; k < end; ++k) {
+            data[k] = std::conj(in[k]);
+        }
+    });
+    transform(data, out);
+    forPoints(m_size, [&](qint64 begin, qint64 end) {
+        for (qint64 k = begin; k < end; ++k) {
+            out[k] = std::conj(out[k]);
+        }
+    });
+}
+
+void FftPlan::transform(const Complex *in, Complex *out) const
+{
+    if (m_size == 1) {
+        out[0] = in[0];
+    } else if (m_inner) {
+        bluestein(in, out);
+    } else {
+        work(out, in, 1, 0, m_size >= kMinParallelSize && ParallelUtils::threadCount() > 1);
+    }
+}
+
+void FftPlan::work(Complex *out, const Complex *in, int fstride, int stage, bool parallel) const
+{
+    // 按时间抽取：p 个子序列 in[q], in[q+p], ... 分别变换到 out 的连续段，再做基 p 蝶形
+    const int p = m_factors[2 * stage];
+    const int m = m_factors[2 * stage + 1];
+
+    if (m == 1) {
+        for (int q = 0; q < p; ++q) {
+            out[q] = in[q * fstride];
+        }
+    } else if (parallel) {
+        ParallelUtils::forChunks(p, 1, 0, [&](qint64 begin, qint64 end, int) {
+            for (qint64 q = begin; q < end; ++q) {
+                work(out + q * m, in + q * fstride, fstride * p, stage + 1, false);
+            }
+        });
+    } else {
+        for (int q = 0; q < p; ++q) {
+            work(out + q * m, in + q * fstride, fstride * p, stage + 1, false);
+        }
+    }
+
+    if (parallel) {
+        ParallelUtils::forChunks(m, kMinPointsPerChunk, 0, [&](qint64 begin, qint64 end, int) {
+            butterfly(out, fstride, p, m, static_cast<int>(begin), static_cast<int>(end));
+        });
+    } else {
+        butterfly(out, fstride, p, m, 0, m);
+    }
+}
+
+void FftPlan::butterfly(Complex *out, int fstride, int p, int m, int begin, int end) const
+{
+    const Complex *twiddles = m_twiddles.data();
+
+    if (p == 2) {
+        for (int k = begin; k < end; ++k) {
+            const Complex t = out[k + m] * twiddles[qint64(k) * fstride];
+            out[k + m] = out[k] - t;
+            out[k] += t;
+        }
+        return;
+    }
+
+    if (p == 4) {
+        for (int k = begin; k < end; ++k) {
+            const qint64 index = qint64(k) * fstride;
+            const Complex s0 = out[k + m] * twiddles[index];
+            const Complex s1 = out[k + 2 * m] * twiddles[2 * index];
+            const Complex s2 = out[k + 3 * m] * twiddles[3 * index];
+            const Complex s5 = out[k] - s1;
+            const Complex f0 = out[k] + s1;
+            const Complex s3 = s0 + s2;
+            const Complex s4 = s0 - s2;
+            out[k] = f0 + s3;
+            out[k + 2 * m] = f0 - s3;
+            // s5 ∓ i·s4
+            out[k + m] = Complex(s5.real() + s4.imag(), s5.imag() - s4.real());
+            out[k + 3 * m] = Complex(s5.real() - s4.imag(), s5.imag() + s4.real());
+        }
+        return;
+    }
+
+    if (p == 3) {
+        // e^(-2πi/3) 的虚部
+        const double sine = twiddles[qint64(fstride) * m].imag();
+        for (int k = begin; k < end; ++k) {
+            const qint64 index = qint64(k) * fstride;
+            const Complex s1 = out[k + m] * twiddles[index];
+            const Complex s2 = out[k + 2 * m] * twiddles[2 * index];
+            const Complex s3 = s1 + s2;
+            const Complex s0 = (s1 - s2) * sine;
+            const Complex base = out[k] - s3 * 0.5;
+            out[k] += s3;
+            out[k + m] = Complex(base.real() - s0.imag(), base.imag() + s0.real());
+            out[k + 2 * m] = Complex(base.real() + s0.imag(), base.imag() - s0.real());
+        }
+        return;
+    }
+
+    if (p == 5) {
+        // e^(-2πi/5) 与 e^(-4πi/5)
+        const Complex ya = twiddles[qint64(fstride) * m];
+        const Complex yb = twiddles[qint64(fstride) * 2 * m];
+        for (int k = begin; k < end; ++k) {
+            const qint64 index = qint64(k) * fstride;
+            const Complex s0 = out[k];
+            const Complex s1 = out[k + m] * twiddles[index];
+            const Complex s2 = out[k + 2 * m] * twiddles[2 * index];
+            const Complex s3 = out[k + 3 * m] * twiddles[3 * index];
+            const Complex s4 = out[k + 4 * m] * twiddles[4 * index];
+            const Complex s7 = s1 + s4;
+            const Complex s10 = s1 - s4;
+            const Complex s8 = s2 + s3;
+            const Complex s9 = s2 - s3;
+
+            out[k] = s0 + s7 + s8;
+            const Complex s5 = s0 + s7 * ya.real() + s8 * yb.real();
+            const Complex s6(s10.imag() * ya.imag() + s9.imag() * yb.imag(),
+                             -s10.real() * ya.imag() - s9.real() * yb.imag());
+            out[k + m] = s5 - s6;
+            out[k + 4 * m] = s5 + s6;
+            const Complex s11 = s0 + s7 * yb.real() + s8 * ya.real();
+            const Complex s12(-s10.imag() * yb.imag() + s9.imag() * ya.imag(),
+                              s10.real() * yb.imag() - s9.real() * ya.imag());
+            out[k + 2 * m] = s11 + s12;
+            out[k + 3 * m] = s11 - s12;
+        }
+        return;
+    }
+
+    // 通用基 p：输出 u 对应 Σ_q x_q·W^(q·(k+u·m)·fstride)
+    std::vector<Complex> scratch(p);
+    for (int k = begin; k < end; ++k) {
+        for (int q = 0; q < p; ++q) {
+            scratch[q] = out[k + q * m];
+        }
+        for (int u = 0; u < p; ++u) {
+            const int index = k + u * m;
+            const qint64 step = qint64(fstride) * index;
+            qint64 twiddle = 0;
+            Complex sum = scratch[0];
+            for (int q = 1; q < p; ++q) {
+                twiddle += step;
+                if (twiddle >= m_size) {
+                    twiddle -= m_size;
+                }
+                sum += scratch[q] * twiddles[twiddle];
+            }
+            out[index] = sum;
+        }
+    }
+}
+
+void FftPlan::bluestein(const Complex *in, Complex *out) const
+{
+    const int inner = m_inner->size();
+    const int n = m_size;
+    std::vector<Complex> buffer(inner, Complex(0.0, 0.0));
+    Complex *data = buffer.data();
+    const Complex *chirp = m_chirp.data();
+    const Complex *spectrum = m_chirpSpectrum.data();
+
+    forPoints(n, [&](qint64 begin, qint64 end) {
+        for (qint64 k = begin; k < end; ++k) {
+            data[k] = in[k] * chirp[k];
+        }
+    });
+    m_inner->forward(data, data);
+    forPoints(inner, [&](qint64 begin, qint64 end) {
+        for (qint64 k = begin; k < end; ++k) {
+            data[k] *= spectrum[k];
+        }
+    });
+    m_inner->inverse(data, data);
+    forPoints(n, [&](qint64 begin, qint64 end) {
+        for (qint64 k = begin; k < end; ++k) {
+            out[k] = data[k] * chirp[k];
+        }
+    });
+}
+
+namespace Fft {
+
+int fastSize(int n)
+{
+    if (n <= 2) {
+        return 2;
+    }
+    // 枚举 2^a·3^b·5^c（a ≥ 1）中不小于 n 的最小值
+    qint64 best = 2;
+    while (best < n) {
+        best <<= 1;
+    }
+    for (qint64 p5 = 1; p5 < best; p5 *= 5) {
+        for (qint64 p35 = p5; p35 < best; p35 *= 3) {
+            qint64 value = p35 * 2;
+            while (value < n) {
+                value <<= 1;
+            }
+            best = qMin(best, value);
+        }
+    }
+    return static_cast<int>(best);
+}
+
+void realForward(const double *in, int n, Complex *out)
+{
+    if (n <= 0) {
+        return;
+    }
+
+    if (n % 2 != 0) {
+        std::vector<Complex> data(n);
+        for (int k = 0; k < n; ++k) {
+            data[k] = Complex(in[k], 0.0);
+        }
+        FftPlan::get(n)->forward(data.data(), data.data());
+        std::copy(data.begin(), data.begin() + n / 2 + 1, out);
+        return;
+    }
+
+    // 偶数长度：z[k] = x[2k] + i·x[2k+1] 做 n/2 点复数变换，
+    // 再由 Z[k] 与 conj(Z[n/2-k]) 分离出偶、奇子序列的频谱 E[k]、O[k]，X[k] = E[k] + W^k·O[k]
+    const int half = n / 2;
+    std::vector<Complex> packed(half);
+    std::vector<Complex> spectrum(half);
+    Complex *p = packed.data();
+    forPoints(half, [&](qint64 begin, qint64 end) {
+        for (qint64 k = begin; k < end; ++k) {
+            p[k] = Complex(in[2 * k], in[2 * k + 1]);
+        }
+    });
+    FftPlan::get(half)->forward(p, spectrum.data());
+
+    const Complex *z = spectrum.data();
+    const SplitTwiddles twiddles(n);
+    out[0] = Complex(z[0].real() + z[0].imag(), 0.0);
+    out[half] = Complex(z[0].real() - z[0].imag(), 0.0);
+    forPoints(half, [&](qint64 begin, qint64 end) {
+        for (qint64 k = qMax<qint64>(begin, 1); k < end; ++k) {
+            const Complex a = z[k];
+            const Complex b = std::conj(z[half - k]);
+            const Complex even = (a + b) * 0.5;
+            const Complex odd = (a - b) * Complex(0.0, -0.5);
+            out[k] = even + twiddles.at(k) * odd;
+        }
+    });
+}
+
+void realInverse(const Complex *in, int n, double *out)
+{
+    if (n <= 0) {
+        return;
+    }
+
+    if (n % 2 != 0) {
+        // 由共轭对称补全整个频谱
+        std::vector<Complex> data(n);
+        for (int k = 0; k <= n / 2; ++k) {
+            data[k] = in[k];
+        }
+        for (int k = n / 2 + 1; k < n; ++k) {
+            data[k] = std::conj(in[n - k]);
+        }
+        FftPlan::get(n)->inverse(data.data(), data.data());
+        for (int k = 0; k < n; ++k) {
+            out[k] = data[k].real() / n;
+        }
+        return;
+    }
+
+    // realForward 的逆过程：E[k] = (X[k] + conj(X[n/2-k])) / 2，
+    // O[k] = (X[k] - conj(X[n/2-k])) / 2 · conj(W^k)，Z[k] = E[k] + i·O[k]
+    const int half = n / 2;
+    std::vector<Complex> packed(half);
+    std::vector<Complex> signal(half);
+    Complex *p = packed.data();
+    const SplitTwiddles twiddles(n);
+    forPoints(half, [&](qint64 begin, qint64 end) {
+        for (qint64 k = begin; k < end; ++k) {
+            const Complex a = in[k];
+            const Complex b = std::conj(in[half - k]);
+            const Complex even = (a + b) * 0.5;
+            const Complex odd = (a - b) * 0.5 * std::conj(twiddles.at(k));
+            p[k] = even + Complex(-odd.imag(), odd.real());
+        }
+    });
+    FftPlan::get(half)->inverse(p, signal.data());
+
+    const Complex *z = signal.data();
+    const double scale = 1.0 / half;
+    forPoints(half, [&](qint64 begin, qint64 end) {
+        for (qint64 k = begin; k < end; ++k) {
+            out[2 * k] = z[k].real() * scale;
+            out[2 * k + 1] = z[k].imag() * scale;
+        }
+    });
+}
+
+void convolve(const double *a, int na, const double *b, int nb, double *out)
+{
+    if (na <= 0 || nb <= 0) {
+        return;
+    }
+    const int length = na + nb - 1;
+
+    if (qMin(na, nb) <= kMinFftConvolve) {
+        // 短核直接计算，O(n·m) 且没有变换的舍入误差
+        forPoints(length, [&](qint64 begin, qint64 end) {
+            for (qint64 k = begin; k < end; ++k) {
+                const int first = static_cast<int>(qMax<qint64>(0, k - (nb - 1)));
+                const int last = static_cast<int>(qMin<qint64>(na - 1, k));
+                double sum = 0.0;
+                for (int i = first; i <= last; ++i) {
+                    sum += a[i] * b[k - i];
+                }
+                out[k] = sum;
+            }
+        });
+        return;
+    }
+
+    // 补零到适合FFT的长度后逐点相乘，循环卷积即线性卷积
+    const int size = fastSize(length);
+    const int bins = size / 2 + 1;
+    std::vector<double> padded(size, 0.0);
+    std::vector<Complex> spectrumA(bins);
+    std::vector<Complex> spectrumB(bins);
+
+    std::copy(a, a + na, padded.begin());
+    realForward(padded.data(), size, spectrumA.data());
+    std::fill(padded.begin(), padded.end(), 0.0);
+    std::copy(b, b + nb, padded.begin());
+    realForward(padded.data(), size, spectrumB.data());
+
+    for (int k = 0; k < bins; ++k) {
+        spectrumA[k] *= spectrumB[k];
+    }
+    realInverse(spectrumA.data(), size, padded.data());
+    std::copy(padded.begin(), padded.begin() + length, out);
+}
+
+void correlate(const double *a, int na, const double *b, int nb, double *out)
+{
+    if (na <= 0 || nb <= 0) {
+        return;
+    }
+    // Σ a[i]·b[i+lag] 即 a 反转后与 b 的卷积
+    std::vector<double> reversed(a, a + na);
+    std::reverse(reversed.begin(), reversed.end());
+    convolve(reversed.data(), na, b, nb, out);
+}
+
+} // namespace Fft
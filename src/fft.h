@@ -0,0 +1,99 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <QSharedPointer>
+#include <QtGlobal>
+#include <complex>
+#include <vector>
+
+typedef std::complex<double> Complex;
+
+/**
+ * @brief 指定长度的复数FFT计划
+ * 长度分解为 4、2、3、5 等基数做混合基变换（旋转因子表预先计算）；
+ * 含有较大质因数的长度改用 Bluestein 算法，转化为2的幂长度的卷积。
+ * 计划创建后只读，可在多个线程中同时使用；通过 get() 获取时按长度缓存复用
+ */
+class FftPlan
+{
+public:
+    /**
+     * @brief 获取（或创建并缓存）长度为 n 的计划
+     */
+    static QSharedPointer<const FftPlan> get(int n);
+
+    /**
+     * @brief 清除计划缓存（正在使用的计划不受影响）
+     */
+    static void clearCache();
+
+    explicit FftPlan(int n);
+
+    int size() const { return m_size; }
+
+    /**
+     * @brief 正变换 X[k] = Σ x[j]·e^(-2πijk/n)
+     * in 与 out 可以相同
+     */
+    void forward(const Complex *in, Complex *out) const;
+
+    /**
+     * @brief 逆变换（不除以 n）
+     */
+    void inverse(const Complex *in, Complex *out) const;
+
+    /**
+     * @brief 计划占用的内存（字节）
+     */
+    qint64 memoryUsage() const;
+
+private:
+    void transform(const Complex *in, Complex *out) const;
+    void work(Complex *out, const Complex *in, int fstride, int stage, bool parallel) const;
+    void butterfly(Complex *out, int fstride, int p, int m, int begin, int end) const;
+    void bluestein(const Complex *in, Complex *out) const;
+
+    int m_size;
+    std::vector<int> m_factors;                 // (基数 p, 子变换长度 m) 依次排列
+    std::vector<Complex> m_twiddles;            // e^(-2πik/n)
+
+    // Bluestein
+    QSharedPointer<const FftPlan> m_inner;      // 2的幂长度的内部计划
+    std::vector<Complex> m_chirp;               // e^(-iπk²/n)
+    std::vector<Complex> m_chirpSpectrum;       // 共轭chirp的频谱（已除以内部长度）
+};
+
+/**
+ * @brief 基于 FftPlan 的实数变换、卷积与相关
+ */
+namespace Fft {
+
+/**
+ * @brief 不小于 n 的、适合FFT的偶数长度（只含因子 2、3、5）
+ */
+int fastSize(int n);
+
+/**
+ * @brief 实数序列的正变换，输出 n/2+1 个非负频率分量
+ * 偶数长度通过半长复数变换完成
+ */
+void realForward(const double *in, int n, Complex *out);
+
+/**
+ * @brief realForward 的逆变换（已除以 n），输入 n/2+1 个分量，输出 n 个实数
+ */
+void realInverse(const Complex *in, int n, double *out);
+
+/**
+ * @brief 线性卷积，输出 na+nb-1 个点
+ */
+void convolve(const double *a, int na, const double *b, int nb, double *out);
+
+/**
+ * @brief 互相关 out[k] = Σ a[i]·b[i+lag]，lag = k-(na-1)，输出 na+nb-1 个点
+ */
+void correlate(const double *a, int na, const double *b, int nb, double *out);
+
+} // namespace Fft
+
+#endif // FFT_H
@@ -0,0 +1,266 @@
+#include "geometrycache.h"
+#include "rangefilter.h"
+#include "xvalues.h"
+#include "sortindex.h"
+#include <QHash>
+#include <cmath>
+#include <limits>
+
+namespace {
+// 默认内存上限（MB）
+const int kDefaultLimitMB = 512;
+}
+
+bool GeometryCache::Key::operator==(const Key &other) const
+{
+    return x == other.x && y == other.y &&
+           xSize == other.xSize && ySize == other.ySize &&
+           filterByRange == other.filterByRange &&
+           minValue == other.minValue && maxValue == other.maxValue;
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+size_t qHash(const GeometryCache::Key &key, size_t seed)
+#else
+uint qHash(const GeometryCache::Key &key, uint seed)
+#endif
+{
+    seed = qHash(reinterpret_cast<quintptr>(key.x), seed);
+    seed = qHash(reinterpret_cast<quintptr>(key.y), seed);
+    seed = qHash(key.xSize, seed);
+    seed = qHash(key.ySize, seed);
+    if (key.filterByRange) {
+        seed = qHash(key.minValue, seed);
+        seed = qHash(key.maxValue, seed);
+    }
+    return seed;
+}
+
+GeometryCache& GeometryCache::instance()
+{
+    static GeometryCache cache;
+    return cache;
+}
+
+GeometryCache::GeometryCache()
+{
+    setMemoryLimit(kDefaultLimitMB);
+}
+
+GeometryCache::Key GeometryCache::makeKey(const QVector<double> &xData, const QVector<double> &yData,
+                                          bool filterByRange, double minValue, double maxValue)
+{
+    Key key;
+    key.x = xData.constData();
+    key.y = yData.constData();
+    key.xSize = xData.size();
+    key.ySize = yData.size();
+    key.filterByRange = filterByRange;
+    // 未启用过滤时区间参数不影响结果
+    key.minValue = filterByRange ? minValue : 0.0;
+    key.maxValue = filterByRange ? maxValue : 0.0;
+    return key;
+}
+
+bool GeometryCache::find(const QVector<double> &xData, const QVector<double> &yData,
+                         bool filterByRange, double minValue, double maxValue,
+                         PreparedGeometry &geometry)
+{
+    Entry *entry = m_cache.object(makeKey(xData, yData, filterByRange, minValue, maxValue));
+    if (!entry) {
+        return false;
+    }
+    geometry = entry->geometry;
+    return true;
+}
+
+void GeometryCache::insert(const QVector<double> &xData, const QVector<double> &yData,
+                           bool filterByRange, double minValue, double maxValue,
+                           const PreparedGeometry &geometry)
+{
+    // X为空是隐式行索引（最常见的情况），仍需缓存：键中的Y地址和长度足以区分
+    if (yData.isEmpty()) {
+        return;
+    }
+
+    Entry *entry = new Entry;
+    entry->xData = xData;
+    entry->yData = yData;
+    entry->geometry = geometry;
+
+    // 保守估计：源数据 + 过滤结果（与源数据共享时不重复计算）+ 金字塔
+    qint64 bytes = (qint64(xData.size()) + yData.size()) * sizeof(double);
+    if (geometry.filteredX.constData() != xData.constData()) {
+        bytes += qint64(geometry.filteredX.size()) * sizeof(double);
+    }
+    if (geometry.filteredY.constData() != yData.constData()) {
+        bytes += qint64(geometry.filteredY.size()) * sizeof(double);
+    }
+    if (geometry.lod) {
+        bytes += geometry.lod->memoryUsage();
+        if (!geometry.xSorted) {
+            bytes += geometry.lod->size() * 2 * qint64(sizeof(double));  // 排序后的副本
+        }
+    }
+    const int cost = static_cast<int>(qMin<qint64>(bytes / 1024 + 1, std::numeric_limits<int>::max()));
+
+    // 超过上限的单项不缓存（QCache 会直接丢弃）
+    m_cache.insert(makeKey(xData, yData, filterByRange, minValue, maxValue), entry, cost);
+}
+
+void GeometryCache::setMemoryLimit(int megabytes)
+{
+    m_cache.setMaxCost(qMax(0, megabytes) * 1024);
+}
+
+int GeometryCache::memoryLimit() const
+{
+    return static_cast<int>(m_cache.maxCost() / 1024);
+}
+
+int GeometryCache::memoryUsage() const
+{
+    return static_cast<int>(m_cache.totalCost() / 1024);
+}
+
+void GeometryCache::clear()
+{
+    m_cache.clear();
+}
+
+PreparedGeometry GeometryCache::build(const QVector<double> &xData, const QVector<double> &yData,
+                                      bool filterByRange, double minValue, double maxValue,
+                                      const QAtomicInt *cancel)
+{
+    PreparedGeometry geometry;
+    const int count = XValues::count(xData, yData);
+    
+    if (filterByRange) {
+        // 区间过滤：一次遍历得到保留的点，被过滤掉的区间以分隔点断开
+        RangeFilter::Result filtered = RangeFilter::filter(xData, yData, minValue, maxValue);
+        geometry.filteredX = filtered.x;
+        geometry.filteredY = filtered.y;
+    } else if (xData.isEmpty()) {
+        // 隐式行索引：X保持为空，不生成索引数组
+        geometry.filteredY = yData;
+    } else if (xData.size() == count && yData.size() == count) {
+        // 无需过滤：直接共享源数据（源数据中的NaN同样作为分隔点）
+        geometry.filteredX = xData;
+        geometry.filteredY = yData;
+    } else {
+        geometry.filteredX = xData.mid(0, count);
+        geometry.filteredY = yData.mid(0, count);
+    }
+    if (cancel && cancel->loadAcquire()) {
+        return PreparedGeometry();
+    }
+    
+    geometry.xMin = std::numeric_limits<double>::max();
+    geometry.xMax = std::numeric_limits<double>::lowest();
+    geometry.yMin = std::numeric_limits<double>::max();
+    geometry.yMax = std::numeric_limits<double>::lowest();
+    
+    const XValues px(geometry.filteredX);
+    const double *py = geometry.filteredY.constData();
+    const int n = geometry.filteredY.size();
+    for (int i = 0; i < n; ++i) {
+        geometry.xMin = qMin(geometry.xMin, px[i]);
+        geometry.xMax = qMax(geometry.xMax, px[i]);
+        if (RangeFilter::isBreak(py[i])) {
+            geometry.breakCount++;
+            continue;
+        }
+        geometry.yMin = qMin(geometry.yMin, py[i]);
+        geometry.yMax = qMax(geometry.yMax, py[i]);
+    }
+    if (geometry.breakCount == n) {
+        // 没有有效点
+        geometry.filteredX.clear();
+        geometry.filteredY.clear();
+        geometry.breakCount = 0;
+    }
+    if (cancel && cancel->loadAcquire()) {
+        return PreparedGeometry();
+    }
+    
+    if (geometry.filteredY.isEmpty()) {
+        return geometry;
+    }
+    
+    geometry.xSorted = LodPyramid::isSorted(geometry.filteredX);
+    if (geometry.xSorted) {
+        // X单调（或为隐式行索引）：直接在过滤后的数据上构建LOD金字塔（共享存储）
+        geometry.lod.reset(new LodPyramid(geometry.filteredX, geometry.filteredY));
+        return geometry;
+    }
+    
+    // X无序：按排序下标重排一份有效点，在其上构建金字塔，供包络带、十字线查询和范围统计使用。
+    // 未过滤时X与源数据列共享存储，排序下标按列缓存
+    SortIndex::Permutation order = filterByRange
+        ? SortIndex::Permutation(new QVector<int>(SortIndex::compute(geometry.filteredX)))
+        : SortIndex::permutation(geometry.filteredX);
+    if (cancel && cancel->loadAcquire()) {
+        return PreparedGeometry();
+    }
+    QVector<double> sortedX;
+    QVector<double> sortedY;
+    SortIndex::gather(geometry.filteredX, geometry.filteredY, *order, sortedX, sortedY);
+    if (!sortedY.isEmpty()) {
+        geometry.lod.reset(new LodPyramid(sortedX, sortedY));
+    }
+    return geometry;
+}
+
+PreparedGeometry GeometryCache::buildPreview(const QVector<double> &xData, const QVector<double> &yData,
+                                             bool filterByRange, double minValue, double maxValue,
+                                             int maxPoints)
+{
+    const int count = XValues::count(xData, yData);
+    const int blockSize = qMax(1, count / qMax(1, maxPoints / 2));
+    const XValues px(xData);
+    const double *py = yData.constData();
+    
+    QVector<double> sampleX;
+    QVector<double> sampleY;
+    sampleX.reserve(maxPoints + maxPoints / 2 + 2);
+    sampleY.reserve(maxPoints + maxPoints / 2 + 2);
+    auto append = [&](int i) {
+        if (sampleX.isEmpty() || sampleX.constLast() != px[i] || sampleY.constLast() != py[i]) {
+            sampleX.append(px[i]);
+            sampleY.append(py[i]);
+        }
+    };
+    
+    for (int first = 0; first < count; first += blockSize) {
+        const int last = qMin(count, first + blockSize);
+        int minIndex = -1;
+        int maxIndex = -1;
+        bool hasInvalid = false;
+        for (int i = first; i < last; ++i) {
+            if (!std::isfinite(py[i])) {
+                hasInvalid = true;
+                continue;
+            }
+            if (minIndex < 0 || py[i] < py[minIndex]) minIndex = i;
+            if (maxIndex < 0 || py[i] > py[maxIndex]) maxIndex = i;
+        }
+        
+        // 首尾点保证X范围完整
+        if (first == 0 && minIndex != 0 && maxIndex != 0) {
+            append(0);
+        }
+        if (minIndex >= 0) {
+            append(qMin(minIndex, maxIndex));
+            append(qMax(minIndex, maxIndex));
+        }
+        if (last == count && minIndex != count - 1 && maxIndex != count - 1) {
+            append(count - 1);
+        }
+        if (hasInvalid && last < count) {
+            sampleX.append(px[last - 1]);
+            sampleY.append(std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+    
+    return build(sampleX, sampleY, filterByRange, minValue, maxValue);
+}
@@ -0,0 +1,118 @@
+#ifndef GEOMETRYCACHE_H
+#define GEOMETRYCACHE_H
+
+#include <QVector>
+#include <QCache>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include "lodpyramid.h"
+
+/**
+ * @brief 一条曲线预处理后的几何数据
+ * 区间过滤结果、统计值和LOD金字塔，与显示模式无关。
+ * 未过滤的隐式行索引曲线 filteredX 为空（见 XValues），点数以 filteredY 为准
+ */
+struct PreparedGeometry
+{
+    QVector<double> filteredX;
+    QVector<double> filteredY;
+    int breakCount = 0;
+    double xMin = 0;
+    double xMax = 0;
+    double yMin = 0;
+    double yMax = 0;
+    bool xSorted = true;                    // X是否单调（隐式行索引总是单调）
+    QSharedPointer<const LodPyramid> lod;   // X无序时建立在按X排序后的副本上
+};
+
+/**
+ * @brief 曲线几何数据的LRU缓存（所有Canvas共享，仅在GUI线程使用）
+ * 以源数据的存储地址和影响几何的样式参数（区间过滤）为键。
+ * 缓存项同时持有源数据的引用，因此键中的地址在缓存项存在期间不会被其他数据复用。
+ * 切换X轴或重新应用预设时，相同的数据和过滤条件直接复用已有结果
+ */
+class GeometryCache
+{
+public:
+    static GeometryCache& instance();
+
+    GeometryCache(const GeometryCache&) = delete;
+    GeometryCache& operator=(const GeometryCache&) = delete;
+
+    /**
+     * @brief 查找缓存，命中时写入 geometry 并将其标记为最近使用
+     */
+    bool find(const QVector<double> &xData, const QVector<double> &yData,
+              bool filterByRange, double minValue, double maxValue,
+              PreparedGeometry &geometry);
+
+    /**
+     * @brief 加入缓存，超出内存上限时淘汰最久未使用的项
+     */
+    void insert(const QVector<double> &xData, const QVector<double> &yData,
+                bool filterByRange, double minValue, double maxValue,
+                const PreparedGeometry &geometry);
+
+    /**
+     * @brief 设置/获取内存上限（MB）
+     */
+    void setMemoryLimit(int megabytes);
+    int memoryLimit() const;
+
+    /**
+     * @brief 当前缓存占用的内存估计（MB）
+     */
+    int memoryUsage() const;
+
+    void clear();
+    
+    /**
+     * @brief 按过滤条件构建完整的几何数据（可在工作线程调用）
+     * @param cancel 非空且被置为非0时尽早返回空结果
+     */
+    static PreparedGeometry build(const QVector<double> &xData, const QVector<double> &yData,
+                                  bool filterByRange, double minValue, double maxValue,
+                                  const QAtomicInt *cancel = nullptr);
+    
+    /**
+     * @brief 构建粗略预览：每块原始点只保留Y最小/最大两点（含首尾点），再按过滤条件处理
+     * 未过滤时范围统计与完整数据一致；块内含无效点时在块后插入分隔点
+     */
+    static PreparedGeometry buildPreview(const QVector<double> &xData, const QVector<double> &yData,
+                                         bool filterByRange, double minValue, double maxValue,
+                                         int maxPoints);
+
+private:
+    GeometryCache();
+
+    struct Key {
+        const double *x;
+        const double *y;
+        int xSize;
+        int ySize;
+        bool filterByRange;
+        double minValue;
+        double maxValue;
+
+        bool operator==(const Key &other) const;
+    };
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    friend size_t qHash(const Key &key, size_t seed);
+#else
+    friend uint qHash(const Key &key, uint seed);
+#endif
+
+    struct Entry {
+        QVector<double> xData;      // 持有源数据，保证键中的地址有效
+        QVector<double> yData;
+        PreparedGeometry geometry;
+    };
+
+    static Key makeKey(const QVector<double> &xData, const QVector<double> &yData,
+                       bool filterByRange, double minValue, double maxValue);
+
+    QCache<Key, Entry> m_cache;     // 代价单位为KB
+};
+
+#endif // GEOMETRYCACHE_H
@@ -0,0 +1,374 @@
+#include "lodpyramid.h"
+#include "parallelutils.h"
+#include "xvalues.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 第0级每桶点数、相邻层级的聚合倍数、最高层的最少桶数
+const qint64 kBaseBucketSize = 64;
+const qint64 kLevelFactor = 8;
+const int kMinTopBuckets = 256;
+
+// 并行构建时每块至少处理的桶数 / 判断有序时每块至少处理的点数
+const qint64 kMinBucketsPerChunk = 4096;
+const qint64 kMinPointsPerChunk = 256 * 1024;
+
+inline void resetBucket(LodPyramid::Bucket &b)
+{
+    b.min = std::numeric_limits<double>::infinity();
+    b.max = -std::numeric_limits<double>::infinity();
+    b.sum = 0.0;
+    b.count = 0;
+}
+
+inline void mergeBucket(LodPyramid::Bucket &into, const LodPyramid::Bucket &b)
+{
+    if (b.count == 0) {
+        return;
+    }
+    into.min = qMin(into.min, b.min);
+    into.max = qMax(into.max, b.max);
+    into.sum += b.sum;
+    into.count += b.count;
+}
+
+} // namespace
+
+LodPyramid::LodPyramid(const QVector<double> &xData, const QVector<double> &yData)
+    : m_x(xData)
+    , m_y(yData)
+{
+    const qint64 count = XValues::count(m_x, m_y);
+    if (!m_x.isEmpty() && m_x.size() != count) m_x.resize(static_cast<int>(count));
+    if (m_y.size() != count) m_y.resize(static_cast<int>(count));
+    if (count == 0) {
+        return;
+    }
+
+    // 第0级：直接从原始数据按块并行聚合
+    const qint64 baseCount = (count + kBaseBucketSize - 1) / kBaseBucketSize;
+    QVector<Bucket> base(static_cast<int>(baseCount));
+    Bucket *out = base.data();
+    const double *py = m_y.constData();
+
+    ParallelUtils::forChunks(baseCount, kMinBucketsPerChunk, 0,
+                             [&](qint64 begin, qint64 end, int) {
+        for (qint64 b = begin; b < end; ++b) {
+            Bucket bucket;
+            resetBucket(bucket);
+            const qint64 first = b * kBaseBucketSize;
+            const qint64 last = qMin(count, first + kBaseBucketSize);
+            for (qint64 i = first; i < last; ++i) {
+                const double y = py[i];
+                if (!std::isfinite(y)) {
+                    continue;
+                }
+                bucket.min = qMin(bucket.min, y);
+                bucket.max = qMax(bucket.max, y);
+                bucket.sum += y;
+                bucket.count++;
+            }
+            out[b] = bucket;
+        }
+    });
+    m_levels.append(base);
+
+    // 更高层级：每 kLevelFactor 个下级桶合并为一个
+    while (m_levels.last().size() > kMinTopBuckets * kLevelFactor) {
+        const QVector<Bucket> &lower = m_levels.last();
+        const int upperCount = static_cast<int>((lower.size() + kLevelFactor - 1) / kLevelFactor);
+        QVector<Bucket> upper(upperCount);
+        for (int u = 0; u < upperCount; ++u) {
+            Bucket bucket;
+            resetBucket(bucket);
+            const int first = static_cast<int>(u * kLevelFactor);
+            const int last = qMin(lower.size(), static_cast<int>(first + kLevelFactor));
+            for (int i = first; i < last; ++i) {
+                mergeBucket(bucket, lower[i]);
+            }
+            upper[u] = bucket;
+        }
+        m_levels.append(upper);
+    }
+}
+
+bool LodPyramid::isSorted(const QVector<double> &xData)
+{
+    const qint64 count = xData.size();
+    if (count < 2) {
+        return true;
+    }
+
+    // 每块检查内部及与前一块交界处的顺序；任何NaN都视为无序
+    const double *px = xData.constData();
+    std::atomic<bool> sorted(true);
+    ParallelUtils::forChunks(count, kMinPointsPerChunk, 0,
+                             [&](qint64 begin, qint64 end, int) {
+        for (qint64 i = qMax<qint64>(1, begin); i < end; ++i) {
+            if (!(px[i - 1] <= px[i])) {
+                sorted = false;
+                return;
+            }
+            if ((i & 0xFFFF) == 0 && !sorted) {
+                return;  // 其他线程已发现无序
+            }
+        }
+    });
+    return sorted;
+}
+
+QSharedPointer<const LodPyramid> LodPyramid::create(const QVector<double> &xData,
+                                                    const QVector<double> &yData)
+{
+    if (yData.isEmpty() || !isSorted(xData)) {
+        return QSharedPointer<const LodPyramid>();
+    }
+    return QSharedPointer<const LodPyramid>(new LodPyramid(xData, yData));
+}
+
+qint64 LodPyramid::lowerBound(double x) const
+{
+    if (m_x.isEmpty()) {
+        // 隐式行索引：第一个 i >= x
+        if (std::isnan(x)) return size();
+        return static_cast<qint64>(qBound(0.0, std::ceil(x), double(size())));
+    }
+    return std::lower_bound(m_x.constBegin(), m_x.constEnd(), x) - m_x.constBegin();
+}
+
+qint64 LodPyramid::upperBound(double x) const
+{
+    if (m_x.isEmpty()) {
+        // 隐式行索引：第一个 i > x
+        if (std::isnan(x)) return size();
+        return static_cast<qint64>(qBound(0.0, std::floor(x) + 1.0, double(size())));
+    }
+    return std::upper_bound(m_x.constBegin(), m_x.constEnd(), x) - m_x.constBegin();
+}
+
+qint64 LodPyramid::bucketSize(int level) const
+{
+    qint64 size = kBaseBucketSize;
+    for (int i = 0; i < level; ++i) {
+        size *= kLevelFactor;
+    }
+    return size;
+}
+
+QVector<LodPyramid::Column> LodPyramid::aggregate(double xMin, double xMax, int columns,
+                                                  bool margin) const
+{
+    QVector<Column> result;
+    if (columns <= 0 || m_y.isEmpty() || !(xMax > xMin)) {
+        return result;
+    }
+
+    qint64 begin = lowerBound(xMin);
+    qint64 end = upperBound(xMax);
+    if (margin) {
+        begin = qMax<qint64>(0, begin - 1);
+        end = qMin<qint64>(size(), end + 1);
+    }
+    if (end <= begin) {
+        return result;
+    }
+
+    // 选择桶大小不超过每列点数1/4的最高层级，列边界误差不超过1/4列
+    const qint64 perColumn = (end - begin) / columns;
+    int level = -1;
+    for (int l = m_levels.size() - 1; l >= 0; --l) {
+        if (bucketSize(l) * 4 <= perColumn) {
+            level = l;
+            break;
+        }
+    }
+
+    const XValues px(m_x);
+    const double *py = m_y.constData();
+    const double scale = columns / (xMax - xMin);
+    result.reserve(columns + 2);
+
+    int currentColumn = std::numeric_limits<int>::min();
+    auto columnOf = [&](double x) {
+        double c = std::floor((x - xMin) * scale);
+        return static_cast<int>(qBound(-1.0, c, double(columns)));
+    };
+    auto startColumn = [&](int column, qint64 index) {
+        Column c;
+        c.x = px[index];
+        c.min = std::numeric_limits<double>::infinity();
+        c.max = -std::numeric_limits<double>::infinity();
+        c.sum = 0.0;
+        c.count = 0;
+        c.firstIndex = index;
+        c.lastIndex = index;
+        result.append(c);
+        currentColumn = column;
+    };
+
+    if (level < 0) {
+        // 每列点数较少：直接聚合原始点
+        for (qint64 i = begin; i < end; ++i) {
+            int column = columnOf(px[i]);
+            if (column != currentColumn) {
+                startColumn(column, i);
+            }
+            Column &c = result.last();
+            c.lastIndex = i;
+            const double y = py[i];
+            if (std::isfinite(y)) {
+                c.min = qMin(c.min, y);
+                c.max = qMax(c.max, y);
+                c.sum += y;
+                c.count++;
+            }
+        }
+        return result;
+    }
+
+    const QVector<Bucket> &buckets = m_levels[level];
+    const qint64 span = bucketSize(level);
+    const qint64 firstBucket = begin / span;
+    const qint64 lastBucket = (end - 1) / span;
+    for (qint64 b = firstBucket; b <= lastBucket; ++b) {
+        const qint64 first = b * span;
+        int column = columnOf(px[first]);
+        if (column != currentColumn) {
+            startColumn(column, first);
+        }
+        Column &c = result.last();
+        c.lastIndex = qMin(this->size(), first + span) - 1;
+        const Bucket &bucket = buckets[static_cast<int>(b)];
+        if (bucket.count > 0) {
+            c.min = qMin(c.min, bucket.min);
+            c.max = qMax(c.max, bucket.max);
+            c.sum += bucket.sum;
+            c.count += bucket.count;
+        }
+    }
+    return result;
+}
+
+LodPyramid::Column LodPyramid::summarize(qint64 begin, qint64 end) const
+{
+    Column c;
+    c.min = std::numeric_limits<double>::infinity();
+    c.max = -std::numeric_limits<double>::infinity();
+    c.sum = 0.0;
+    c.count = 0;
+    begin = qMax<qint64>(0, begin);
+    end = qMin<qint64>(size(), end);
+    c.firstIndex = begin;
+    c.lastIndex = end - 1;
+    if (end <= begin) {
+        c.x = 0.0;
+        return c;
+    }
+    c.x = xAt(begin);
+
+    const double *py = m_y.constData();
+    auto addRaw = [&](qint64 i) {
+        const double y = py[i];
+        if (std::isfinite(y)) {
+            c.min = qMin(c.min, y);
+            c.max = qMax(c.max, y);
+            c.sum += y;
+            c.count++;
+        }
+    };
+    auto addBucket = [&](const Bucket &b) {
+        if (b.count > 0) {
+            c.min = qMin(c.min, b.min);
+            c.max = qMax(c.max, b.max);
+            c.sum += b.sum;
+            c.count += b.count;
+        }
+    };
+
+    // 两端未对齐到第0级桶边界的原始点
+    qint64 lo = begin;
+    qint64 hi = end;
+    while (lo < hi && lo % kBaseBucketSize != 0) {
+        addRaw(lo++);
+    }
+    while (hi > lo && hi % kBaseBucketSize != 0) {
+        addRaw(--hi);
+    }
+
+    // 逐级向上：先消化未对齐到上一级的桶，其余交给上一级
+    lo /= kBaseBucketSize;
+    hi /= kBaseBucketSize;
+    for (int level = 0; level < m_levels.size() && lo < hi; ++level) {
+        const QVector<Bucket> &buckets = m_levels[level];
+        const bool top = level == m_levels.size() - 1;
+        while (lo < hi && (top || lo % kLevelFactor != 0)) {
+            addBucket(buckets[static_cast<int>(lo++)]);
+        }
+        while (hi > lo && hi % kLevelFactor != 0) {
+            addBucket(buckets[static_cast<int>(--hi)]);
+        }
+        lo /= kLevelFactor;
+        hi /= kLevelFactor;
+    }
+    return c;
+}
+
+QVector<QPointF> LodPyramid::envelope(double xMin, double xMax, int columns) const
+{
+    QVector<QPointF> points;
+    if (columns <= 0 || m_y.isEmpty() || !(xMax > xMin)) {
+        return points;
+    }
+
+    qint64 begin = qMax<qint64>(0, lowerBound(xMin) - 1);
+    qint64 end = qMin<qint64>(size(), upperBound(xMax) + 1);
+    if (end - begin <= qint64(columns) * 2) {
+        // 点数不多：直接使用原始点
+        points.reserve(static_cast<int>(end - begin));
+        for (qint64 i = begin; i < end; ++i) {
+            points.append(QPointF(xAt(i), m_y[static_cast<int>(i)]));
+        }
+        return points;
+    }
+
+    QVector<Column> cols = aggregate(xMin, xMax, columns, true);
+    points.reserve(cols.size() * 2);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    bool minFirst = true;
+    for (const Column &c : cols) {
+        if (c.count == 0) {
+            // 整列都是无效点：在此断开折线
+            if (!points.isEmpty() && !std::isnan(points.last().y())) {
+                points.append(QPointF(c.x, nan));
+            }
+            continue;
+        }
+        // 交替先后顺序，使相邻列之间沿包络上下边缘连接
+        if (minFirst) {
+            points.append(QPointF(c.x, c.min));
+            points.append(QPointF(c.x, c.max));
+        } else {
+            points.append(QPointF(c.x, c.max));
+            points.append(QPointF(c.x, c.min));
+        }
+        minFirst = !minFirst;
+        if (c.count < c.lastIndex - c.firstIndex + 1) {
+            // 列内含有无效点（被过滤的区间或NaN）：列后断开
+            points.append(QPointF(c.x, nan));
+        }
+    }
+    return points;
+}
+
+qint64 LodPyramid::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for (const QVector<Bucket> &level : m_levels) {
+        bytes += qint64(level.size()) * sizeof(Bucket);
+    }
+    return bytes;
+}
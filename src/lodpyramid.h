@@ -0,0 +1,108 @@
+#ifndef LODPYRAMID_H
+#define LODPYRAMID_H
+
+#include <QVector>
+#include <QList>
+#include <QPointF>
+#include <QSharedPointer>
+
+/**
+ * @brief 多级细节（LOD）金字塔
+ * 对X单调递增的序列按固定大小分桶，逐级聚合 最小值/最大值/求和/有效点数。
+ * 任意X范围按像素列查询时只访问与列数成正比的桶，与原始点数无关。
+ * X为空时表示隐式行索引（见 XValues），按下标直接换算，不保存X数组
+ */
+class LodPyramid
+{
+public:
+    /**
+     * @brief 桶的聚合值（忽略NaN/Inf）
+     */
+    struct Bucket {
+        double min;
+        double max;
+        double sum;
+        quint32 count;      // 有效点数
+    };
+
+    /**
+     * @brief 一个像素列的聚合结果
+     */
+    struct Column {
+        double x;           // 该列第一个点的X值
+        double min;
+        double max;
+        double sum;
+        qint64 count;       // 有效点数
+        qint64 firstIndex;  // 覆盖的原始点下标范围 [firstIndex, lastIndex]
+        qint64 lastIndex;
+
+        double mean() const { return count > 0 ? sum / count : 0.0; }
+    };
+
+    /**
+     * @brief 构建金字塔（多线程计算第0级）
+     * @param xData 必须单调不减，见 isSorted()；为空时X为行索引
+     */
+    LodPyramid(const QVector<double> &xData, const QVector<double> &yData);
+
+    /**
+     * @brief 判断X是否单调不减（多线程）
+     */
+    static bool isSorted(const QVector<double> &xData);
+
+    /**
+     * @brief 在X单调（或为隐式行索引）时构建金字塔，否则返回空指针
+     */
+    static QSharedPointer<const LodPyramid> create(const QVector<double> &xData,
+                                                   const QVector<double> &yData);
+
+    qint64 size() const { return m_y.size(); }
+    const QVector<double> &xData() const { return m_x; }  // 隐式行索引时为空
+    const QVector<double> &yData() const { return m_y; }
+
+    /**
+     * @brief 第一个 X >= x 的下标
+     */
+    qint64 lowerBound(double x) const;
+
+    /**
+     * @brief 第一个 X > x 的下标
+     */
+    qint64 upperBound(double x) const;
+
+    /**
+     * @brief 按像素列聚合 [xMin, xMax] 内的数据
+     * 选择桶大小不超过每列点数1/4的层级，列边界对齐到桶边界
+     * @param margin 为true时在两侧各多包含一个点，使折线延伸到边缘
+     */
+    QVector<Column> aggregate(double xMin, double xMax, int columns, bool margin = false) const;
+
+    /**
+     * @brief 精确统计下标范围 [begin, end) 内的数据
+     * 两端不足一桶的部分逐点累加，中间部分使用尽可能高层级的桶
+     */
+    Column summarize(qint64 begin, qint64 end) const;
+
+    /**
+     * @brief 生成用于折线显示的包络点
+     * 每列输出最小值和最大值两个点；范围内点数不超过列数两倍时直接返回原始点。
+     * 含有无效点（NaN）的列之后插入Y为NaN的分隔点，以便折线在间断处断开
+     */
+    QVector<QPointF> envelope(double xMin, double xMax, int columns) const;
+
+    /**
+     * @brief 金字塔自身占用的内存（不含共享的原始数据）
+     */
+    qint64 memoryUsage() const;
+
+private:
+    qint64 bucketSize(int level) const;
+    double xAt(qint64 i) const { return m_x.isEmpty() ? double(i) : m_x[static_cast<int>(i)]; }
+
+    QVector<double> m_x;    // 原始数据（隐式共享），为空表示隐式行索引
+    QVector<double> m_y;
+    QList<QVector<Bucket>> m_levels;
+};
+
+#endif // LODPYRAMID_H
@@ -1,4 +1,5 @@
 #include "mainwindow.h"
+#include "derivedcache.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFileDialog>
@@ -11,22 +12,66 @@
 #include <QInputDialog>
 #include <QLabel>
 #include <QApplication>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QDir>
+#include <QSet>
+#include <QRegularExpression>
 #include <iostream>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_canvasCounter(0)
     , m_statusLabel(nullptr)
+    , m_columnStore(nullptr)
     , m_scriptEngine(nullptr)
+    , m_presetJobId(0)
+    , m_chartExporter(nullptr)
+    , m_exportFormat("png")
+    , m_axisLinkGroup(nullptr)
+    , m_linkXAxisAction(nullptr)
     , m_recentFilesMenu(nullptr)
 {
+    // 数据列存储：源数据列和派生列只保存一份，由脚本引擎和所有Canvas共享
+    m_columnStore = new ColumnStore(this);
+    
     // 创建脚本引擎
     m_scriptEngine = new ScriptEngine(this);
+    m_scriptEngine->setColumnStore(m_columnStore);
+    connect(m_scriptEngine, &ScriptEngine::scriptsFinished, this, &MainWindow::onScriptsFinished);
+    
+    // 派生列结果跨会话缓存，重新打开同一文件并应用相同预设时直接读取
+    DerivedCache::instance().setSizeLimit(AppSettings::instance().derivedCacheLimit());
+    
+    // X轴联动组（默认关闭），Canvas创建时加入
+    m_axisLinkGroup = new AxisLinkGroup(this);
     
     // 先创建状态栏标签
     m_statusLabel = new QLabel("请先打开CSV文件");
     statusBar()->addWidget(m_statusLabel);
     
+    // 创建图表导出器，导出在后台线程进行，进度显示在状态栏
+    m_chartExporter = new ChartExporter(this);
+    connect(m_chartExporter, &ChartExporter::progress,
+            [this](int finished, int total, const QString &filePath, bool success) {
+        m_statusLabel->setText(QString("正在导出图表 (%1/%2)：%3%4")
+                               .arg(finished).arg(total).arg(filePath)
+                               .arg(success ? "" : " 失败"));
+    });
+    connect(m_chartExporter, &ChartExporter::allFinished,
+            [this](int succeeded, int total, const QStringList &errors) {
+        if (errors.isEmpty()) {
+            m_statusLabel->setText(QString("图表导出完成，共 %1 个文件").arg(total));
+        } else {
+            m_statusLabel->setText(QString("图表导出完成：成功 %1 个，失败 %2 个")
+                                   .arg(succeeded).arg(errors.size()));
+            QMessageBox::warning(this, "导出失败", errors.join("\n"));
+        }
+    });
+    
     setupUi();
     createMenuBar();
     createToolBar();
@@ -65,6 +110,14 @@ void MainWindow::setupUi()
         delete widget;
     });
     
+    // 切换标签页：新显示的Canvas在showEvent中完成延迟的数据绑定，随后对齐联动的X轴
+    connect(m_canvasTabWidget, &QTabWidget::currentChanged, [this](int index) {
+        CanvasPanel *canvas = qobject_cast<CanvasPanel*>(m_canvasTabWidget->widget(index));
+        if (canvas) {
+            m_axisLinkGroup->syncChart(canvas->getChart());
+        }
+    });
+    
     // 双击标签页改名
     connect(m_canvasTabWidget, &QTabWidget::tabBarDoubleClicked, [this](int index) {
         if (index >= 0) {
@@ -114,6 +167,10 @@ void MainWindow::createMenuBar()
     connect(saveAction, &QAction::triggered, this, &MainWindow::onSaveChart);
     fileMenu->addAction(saveAction);
     
+    QAction *batchExportAction = new QAction("批量导出所有Canvas(&B)...", this);
+    connect(batchExportAction, &QAction::triggered, this, &MainWindow::onBatchExport);
+    fileMenu->addAction(batchExportAction);
+    
     fileMenu->addSeparator();
     
     // 预设导入导出
@@ -149,6 +206,17 @@ void MainWindow::createMenuBar()
     connect(removeCanvasAction, &QAction::triggered, this, &MainWindow::onRemoveCanvas);
     canvasMenu->addAction(removeCanvasAction);
     
+    canvasMenu->addSeparator();
+    
+    m_linkXAxisAction = new QAction("联动所有Canvas的X轴(&L)", this);
+    m_linkXAxisAction->setCheckable(true);
+    m_linkXAxisAction->setToolTip("缩放或平移任一图表时，同步所有Canvas的X轴范围");
+    connect(m_linkXAxisAction, &QAction::toggled, [this](bool checked) {
+        m_axisLinkGroup->setEnabled(checked);
+        m_statusLabel->setText(checked ? "已启用X轴联动" : "已关闭X轴联动");
+    });
+    canvasMenu->addAction(m_linkXAxisAction);
+    
     // 帮助菜单
     QMenu *helpMenu = menuBar()->addMenu("帮助(&H)");
     
@@ -192,6 +260,9 @@ void MainWindow::createToolBar()
     QAction *removeCanvasAction = toolBar->addAction("删除Canvas");
     connect(removeCanvasAction, &QAction::triggered, this, &MainWindow::onRemoveCanvas);
     
+    // X轴联动（与菜单共用同一个动作）
+    toolBar->addAction(m_linkXAxisAction);
+    
     toolBar->addSeparator();
     
     // 脚本编辑器
@@ -205,6 +276,11 @@ void MainWindow::createToolBar()
     QAction *saveAction = toolBar->addAction("保存图表");
     connect(saveAction, &QAction::triggered, this, &MainWindow::onSaveChart);
     
+    // 批量导出
+    QAction *batchExportAction = toolBar->addAction("批量导出");
+    batchExportAction->setToolTip("将所有Canvas导出到指定文件夹");
+    connect(batchExportAction, &QAction::triggered, this, &MainWindow::onBatchExport);
+    
     toolBar->addSeparator();
     
     // 预设管理
@@ -253,6 +329,7 @@ void MainWindow::onOpenFile()
     QApplication::processEvents();
     
     if (m_csvParser.parseFile(filePath)) {
+        loadSourceColumns();
         m_currentFilePath = filePath;
         
         // 刷新所有Canvas
@@ -328,6 +405,7 @@ void MainWindow::onOpenFolder()
         updateRecentFilesMenu();
         
         if (m_csvParser.parseFile(filePath)) {
+            loadSourceColumns();
             m_currentFilePath = filePath;
             refreshAllCanvases();
             
@@ -371,6 +449,7 @@ void MainWindow::onOpenFolder()
     updateRecentFilesMenu();
     
     if (m_csvParser.parseFile(filePath)) {
+        loadSourceColumns();
         m_currentFilePath = filePath;
         refreshAllCanvases();
         
@@ -391,8 +470,9 @@ void MainWindow::onAddCanvas()
     m_canvasCounter++;
     QString title = QString("Canvas %1").arg(m_canvasCounter);
     
-    CanvasPanel *canvas = new CanvasPanel(&m_csvParser, m_scriptEngine, this);
+    CanvasPanel *canvas = new CanvasPanel(&m_csvParser, m_columnStore, this);
     canvas->setTitle(title);
+    m_axisLinkGroup->addChart(canvas->getChart());
     
     m_canvasTabWidget->addTab(canvas, title);
     m_canvasTabWidget->setCurrentWidget(canvas);
@@ -452,44 +532,188 @@ void MainWindow::onSaveChart()
     QString filePath = QFileDialog::getSaveFileName(this,
         "保存图表",
         lastDir + "/chart.png",
-        "PNG图片 (*.png);;JPEG图片 (*.jpg);;所有文件 (*)");
+        "PNG图片 (*.png);;JPEG图片 (*.jpg);;SVG矢量图 (*.svg);;PDF文档 (*.pdf);;所有文件 (*)");
     
     if (filePath.isEmpty()) {
         return;
     }
     
+    QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix.isEmpty()) {
+        filePath += ".png";
+    } else if (!ChartExporter::supportedFormats().contains(suffix)) {
+        QMessageBox::warning(this, "警告", QString("不支持的文件格式：%1").arg(suffix));
+        return;
+    }
+    
     // 保存目录到惰性配置
     AppSettings::instance().setLastSaveDirectory(filePath);
     
-    if (canvas->getChart()->saveAsImage(filePath)) {
-        m_statusLabel->setText(QString("图表已保存至：%1").arg(filePath));
-    } else {
-        QMessageBox::critical(this, "错误", "保存图表失败");
+    ExportOptions options = m_exportOptions;
+    if (!showExportOptionsDialog(options)) {
+        return;
     }
+    m_exportOptions = options;
+    
+    // 在GUI线程中只采集快照；仍在预览的曲线由导出线程构建完整精度的数据，渲染和写文件也在后台进行
+    ExportJob job;
+    job.snapshot = canvas->getChart()->snapshot();
+    job.filePath = filePath;
+    job.options = options;
+    m_chartExporter->exportCharts(QList<ExportJob>() << job);
+    m_statusLabel->setText(QString("正在导出图表：%1").arg(filePath));
 }
 
-void MainWindow::refreshAllCanvases()
+void MainWindow::onBatchExport()
 {
-    // 获取所有派生列
-    QList<DerivedColumn> derivedColumns = m_scriptEngine->getDerivedColumns();
+    if (m_canvasTabWidget->count() == 0) {
+        QMessageBox::warning(this, "警告", "没有可导出的Canvas");
+        return;
+    }
+    
+    QString dirPath = QFileDialog::getExistingDirectory(this,
+        "选择导出文件夹",
+        AppSettings::instance().lastSaveDirectory());
+    if (dirPath.isEmpty()) {
+        return;
+    }
+    
+    ExportOptions options = m_exportOptions;
+    QString format = m_exportFormat;
+    if (!showExportOptionsDialog(options, &format)) {
+        return;
+    }
+    m_exportOptions = options;
+    m_exportFormat = format;
+    
+    QDir dir(dirPath);
+    AppSettings::instance().setLastSaveDirectory(dir.filePath("chart." + format));
     
+    QList<ExportJob> jobs;
+    QSet<QString> usedNames;
+    for (int i = 0; i < m_canvasTabWidget->count(); ++i) {
+        CanvasPanel *canvas = qobject_cast<CanvasPanel*>(m_canvasTabWidget->widget(i));
+        if (!canvas) {
+            continue;
+        }
+        
+        // 以标签名作为文件名，替换文件名中的非法字符并避免重名
+        QString baseName = m_canvasTabWidget->tabText(i);
+        baseName.replace(QRegularExpression("[\\\\/:*?\"<>|]"), "_");
+        baseName = baseName.trimmed();
+        if (baseName.isEmpty()) {
+            baseName = QString("Canvas%1").arg(i + 1);
+        }
+        QString name = baseName;
+        for (int n = 2; usedNames.contains(name.toLower()); ++n) {
+            name = QString("%1_%2").arg(baseName).arg(n);
+        }
+        usedNames.insert(name.toLower());
+        
+        // 未显示过的标签页先完成数据绑定（大数据量曲线只生成预览），完整数据由导出线程构建
+        canvas->ensureRealized();
+        
+        ExportJob job;
+        job.snapshot = canvas->getChart()->snapshot();
+        job.filePath = dir.filePath(name + "." + format);
+        job.options = options;
+        jobs.append(job);
+    }
+    
+    m_chartExporter->exportCharts(jobs);
+    m_statusLabel->setText(QString("正在导出 %1 个图表到：%2").arg(jobs.size()).arg(dirPath));
+}
+
+bool MainWindow::showExportOptionsDialog(ExportOptions &options, QString *format)
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle("导出选项");
+    
+    QFormLayout *layout = new QFormLayout(&dialog);
+    
+    QComboBox *formatCombo = nullptr;
+    if (format) {
+        formatCombo = new QComboBox();
+        formatCombo->addItem("PNG图片", "png");
+        formatCombo->addItem("JPEG图片", "jpg");
+        formatCombo->addItem("SVG矢量图", "svg");
+        formatCombo->addItem("PDF文档", "pdf");
+        int index = formatCombo->findData(*format);
+        formatCombo->setCurrentIndex(index >= 0 ? index : 0);
+        layout->addRow("格式:", formatCombo);
+    }
+    
+    QSpinBox *widthSpin = new QSpinBox();
+    widthSpin->setRange(100, 20000);
+    widthSpin->setSuffix(" px");
+    widthSpin->setValue(options.size.width());
+    layout->addRow("宽度:", widthSpin);
+    
+    QSpinBox *heightSpin = new QSpinBox();
+    heightSpin->setRange(100, 20000);
+    heightSpin->setSuffix(" px");
+    heightSpin->setValue(options.size.height());
+    layout->addRow("高度:", heightSpin);
+    
+    QSpinBox *dpiSpin = new QSpinBox();
+    dpiSpin->setRange(72, 1200);
+    dpiSpin->setValue(options.dpi);
+    layout->addRow("DPI:", dpiSpin);
+    
+    QCheckBox *fullResCheck = new QCheckBox("使用全分辨率数据");
+    fullResCheck->setToolTip("不勾选时按输出像素抽稀数据，导出更快、矢量文件更小");
+    fullResCheck->setChecked(options.fullResolution);
+    layout->addRow(fullResCheck);
+    
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addRow(buttonBox);
+    
+    if (dialog.exec() != QDialog::Accepted) {
+        return false;
+    }
+    
+    options.size = QSize(widthSpin->value(), heightSpin->value());
+    options.dpi = dpiSpin->value();
+    options.fullResolution = fullResCheck->isChecked();
+    if (format) {
+        *format = formatCombo->currentData().toString();
+    }
+    return true;
+}
+
+void MainWindow::refreshAllCanvases()
+{
+    // 派生列保存在列存储中，各Canvas刷新列表时直接读取
     for (int i = 0; i < m_canvasTabWidget->count(); ++i) {
         CanvasPanel *canvas = qobject_cast<CanvasPanel*>(m_canvasTabWidget->widget(i));
         if (canvas) {
-            // 先清除旧的计算列
-            canvas->clearComputedColumns();
-            
-            // 添加新的计算列到内部存储
-            for (const DerivedColumn &col : derivedColumns) {
-                canvas->addComputedColumn(col.name, col.data);
-            }
-            
-            // 刷新列列表（会从 m_computedColumns 读取并显示）
             canvas->refreshColumnList();
         }
     }
 }
 
+void MainWindow::loadSourceColumns()
+{
+    // 新旧文件的列都视为已改变：只存在于旧文件中的输入列同样要让依赖它的派生列重新计算，
+    // 否则这些派生列会保留旧文件的数据和行数
+    QStringList changedColumns = m_columnStore->sourceColumnNames();
+    m_columnStore->loadSource(m_csvParser);
+    for (const QString &name : m_columnStore->sourceColumnNames()) {
+        if (!changedColumns.contains(name)) {
+            changedColumns.append(name);
+        }
+    }
+    recomputeDerivedColumns(changedColumns);
+}
+
+void MainWindow::recomputeDerivedColumns(const QStringList &changedColumns)
+{
+    // 在后台线程重新计算，完成后由 onScriptsFinished 刷新Canvas
+    m_scriptEngine->recomputeAsync(changedColumns, AppSettings::instance().scriptTimeout() * 1000);
+}
+
 CanvasPanel* MainWindow::getCurrentCanvas()
 {
     return qobject_cast<CanvasPanel*>(m_canvasTabWidget->currentWidget());
@@ -547,6 +771,7 @@ void MainWindow::onSavePreset()
         ScriptPreset scriptPreset;
         scriptPreset.outputName = col.name;
         scriptPreset.script = col.sourceScript;
+        scriptPreset.legacyArrays = col.legacyArrays;
         scheme.scripts.append(scriptPreset);
     }
     
@@ -596,33 +821,68 @@ void MainWindow::onLoadPreset()
     PresetScheme scheme = m_presetManager.getScheme(name);
     
     // 1. 先执行脚本生成派生列
+    // 上一个预设的脚本尚未完成时放弃它的结果，其他任务不受影响
+    if (m_presetJobId != 0) {
+        m_scriptEngine->cancelJob(m_presetJobId);
+        m_presetJobId = 0;
+    }
+    
     // 清除现有派生列
     QList<DerivedColumn> existingCols = m_scriptEngine->getDerivedColumns();
     for (const DerivedColumn &col : existingCols) {
         m_scriptEngine->removeDerivedColumn(col.name);
     }
     
-    // 设置源数据
-    QMap<QString, QVector<double>> sourceData;
-    QStringList columnNames = m_csvParser.getColumnNames();
-    for (int i = 0; i < columnNames.size(); ++i) {
-        if (m_csvParser.isNumericColumn(i)) {
-            sourceData[columnNames[i]] = m_csvParser.getColumnData(i);
-        }
+    if (scheme.scripts.isEmpty()) {
+        applyPresetCanvases(name, scheme, 0);
+        return;
     }
-    m_scriptEngine->setSourceData(sourceData);
     
-    // 执行预设中的脚本
-    int scriptSuccess = 0;
+    // 在后台线程执行预设中的脚本：互不依赖的脚本并行执行，结果按预设顺序写入，
+    // 完成后由 onScriptsFinished 创建Canvas（Canvas的预设可能引用派生列）
+    QList<ScriptSource> scripts;
     for (const ScriptPreset &scriptPreset : scheme.scripts) {
-        if (m_scriptEngine->executeScript(scriptPreset.script, scriptPreset.outputName)) {
-            scriptSuccess++;
-        } else {
-            qWarning() << "脚本执行失败:" << scriptPreset.outputName 
-                       << m_scriptEngine->getLastError();
+        ScriptSource source;
+        source.outputName = scriptPreset.outputName;
+        source.script = scriptPreset.script;
+        source.legacyArrays = scriptPreset.legacyArrays;
+        scripts.append(source);
+    }
+    m_pendingPresetName = name;
+    m_pendingScheme = scheme;
+    m_presetJobId = m_scriptEngine->executeScriptsAsync(scripts, AppSettings::instance().scriptTimeout() * 1000);
+    m_statusLabel->setText(QString("正在执行预设方案 \"%1\" 的脚本...").arg(name));
+}
+
+void MainWindow::onScriptsFinished(int jobId, bool cancelled, int succeeded, int total, const QString &errors)
+{
+    if (!errors.isEmpty()) {
+        qWarning() << "脚本执行失败:" << errors;
+    }
+    
+    if (jobId == m_presetJobId) {
+        m_presetJobId = 0;
+        const PresetScheme scheme = m_pendingScheme;
+        m_pendingScheme = PresetScheme();
+        if (cancelled) {
+            // 取消或超时：预设的派生列没有生成，保留现有Canvas，不按预设重建
+            refreshAllCanvases();
+            m_statusLabel->setText(QString("预设方案 \"%1\" 的脚本已中止：%2")
+                .arg(m_pendingPresetName, errors));
+            return;
         }
+        applyPresetCanvases(m_pendingPresetName, scheme, succeeded);
+        return;
     }
     
+    // 重新载入文件后的派生列重新计算；取消或超时时没有写入结果
+    if (!cancelled && total > 0) {
+        refreshAllCanvases();
+    }
+}
+
+void MainWindow::applyPresetCanvases(const QString &name, const PresetScheme &scheme, int scriptSuccess)
+{
     // 2. 刷新所有Canvas的派生列
     refreshAllCanvases();
     
@@ -641,17 +901,12 @@ void MainWindow::onLoadPreset()
         QString title = preset.name.isEmpty() ? 
             QString("Canvas %1").arg(m_canvasCounter) : preset.name;
         
-        CanvasPanel *canvas = new CanvasPanel(&m_csvParser, m_scriptEngine, this);
+        CanvasPanel *canvas = new CanvasPanel(&m_csvParser, m_columnStore, this);
+        m_axisLinkGroup->addChart(canvas->getChart());
         m_canvasTabWidget->addTab(canvas, title);
         canvas->setTitle(title);
         
-        // 先添加派生列到Canvas内部数据
-        QList<DerivedColumn> derivedColumns = m_scriptEngine->getDerivedColumns();
-        for (const DerivedColumn &col : derivedColumns) {
-            canvas->addComputedColumn(col.name, col.data);
-        }
-        
-        // 刷新列列表（显示CSV列和计算列）
+        // 刷新列列表（显示CSV列和列存储中的计算列）
         canvas->refreshColumnList();
         
         // 再应用预设
@@ -904,6 +1159,7 @@ void MainWindow::openRecentFile(const QString &filePath)
     QApplication::processEvents();
     
     if (m_csvParser.parseFile(filePath)) {
+        loadSourceColumns();
         m_currentFilePath = filePath;
         
         // 保存目录到惰性配置
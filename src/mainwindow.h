@@ -11,11 +11,14 @@
 #include <QMenu>
 #include <QCloseEvent>
 #include "csvparser.h"
+#include "columnstore.h"
 #include "canvaspanel.h"
 #include "presetmanager.h"
 #include "scriptengine.h"
 #include "scripteditor.h"
 #include "appsettings.h"
+#include "chartexporter.h"
+#include "axislinkgroup.h"
 
 /**
  * @brief 主窗口类
@@ -55,6 +58,11 @@ private slots:
      */
     void onSaveChart();
     
+    /**
+     * @brief 批量导出所有Canvas的图表
+     */
+    void onBatchExport();
+    
     /**
      * @brief 打开脚本编辑器
      */
@@ -70,6 +78,11 @@ private slots:
      */
     void onLoadPreset();
     
+    /**
+     * @brief 后台脚本任务结束：预设的脚本完成后创建Canvas，重新计算完成后刷新Canvas
+     */
+    void onScriptsFinished(int jobId, bool cancelled, int succeeded, int total, const QString &errors);
+    
     /**
      * @brief 删除预设
      */
@@ -106,11 +119,34 @@ private:
      */
     void createToolBar();
     
+    /**
+     * @brief 显示导出选项对话框
+     * @param format 非空时提供格式选择（批量导出），返回所选后缀
+     * @return 用户是否确认
+     */
+    bool showExportOptionsDialog(ExportOptions &options, QString *format = nullptr);
+    
     /**
      * @brief 刷新所有Canvas的列列表
      */
     void refreshAllCanvases();
     
+    /**
+     * @brief 将已解析的文件载入列存储，并重新计算依赖新旧源数据列的派生列
+     */
+    void loadSourceColumns();
+    
+    /**
+     * @brief 在后台重新计算直接或间接读取了 changedColumns 的派生列，完成前Canvas仍显示原有数据
+     */
+    void recomputeDerivedColumns(const QStringList &changedColumns);
+    
+    /**
+     * @brief 按预设方案重建所有Canvas（预设的脚本已执行完）
+     * @param scriptSuccess 成功执行的脚本数，显示在状态栏
+     */
+    void applyPresetCanvases(const QString &name, const PresetScheme &scheme, int scriptSuccess);
+    
     /**
      * @brief 获取当前Canvas
      */
@@ -165,8 +201,23 @@ private:
     // 预设管理器
     PresetManager m_presetManager;
     
+    // 数据列存储（源数据列 + 派生列）
+    ColumnStore *m_columnStore;
+    
     // 脚本引擎
     ScriptEngine *m_scriptEngine;
+    int m_presetJobId;              // 正在执行的预设脚本任务，0 表示没有
+    QString m_pendingPresetName;
+    PresetScheme m_pendingScheme;   // 脚本完成后据此创建Canvas
+    
+    // 后台图表导出
+    ChartExporter *m_chartExporter;
+    ExportOptions m_exportOptions;  // 本次会话中上一次使用的导出选项
+    QString m_exportFormat;         // 批量导出上一次使用的格式
+    
+    // 所有Canvas的X轴联动组
+    AxisLinkGroup *m_axisLinkGroup;
+    QAction *m_linkXAxisAction;
     
     // UI组件
     QTabWidget *m_canvasTabWidget;
@@ -0,0 +1,644 @@
+#include "mathutils.h"
+#include "parallelutils.h"
+#include "rollingwindow.h"
+#include "fft.h"
+#include "spectralanalyzer.h"
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+// 逐元素运算每块至少处理的点数
+const qint64 kMinPointsPerChunk = 64 * 1024;
+
+template <typename Fn>
+void parallelFor(int count, Fn fn)
+{
+    ParallelUtils::forChunks(count, kMinPointsPerChunk, 0, [&](qint64 begin, qint64 end, int) {
+        for (qint64 i = begin; i < end; ++i) {
+            fn(i);
+        }
+    });
+}
+}
+
+Float64View MathUtils::input(const QJSValue &value) const
+{
+    Float64View view;
+    if (!m_bridge->view(value, view)) {
+        return Float64View();
+    }
+    return view;
+}
+
+template <typename Fn>
+QJSValue MathUtils::unary(const Float64View &va, Fn fn) const
+{
+    Float64Buffer result(va.size);
+    const double *pa = va.data;
+    double *out = result.data();
+    parallelFor(va.size, [=](qint64 i) { out[i] = fn(pa[i]); });
+    return m_bridge->wrap(result);
+}
+
+template <typename Fn>
+QJSValue MathUtils::binary(const Float64View &va, const Float64View &vb, Fn fn) const
+{
+    Float64Buffer result(qMin(va.size, vb.size));
+    const double *pa = va.data;
+    const double *pb = vb.data;
+    double *out = result.data();
+    parallelFor(result.size(), [=](qint64 i) { out[i] = fn(pa[i], pb[i]); });
+    return m_bridge->wrap(result);
+}
+
+QVariantList MathUtils::to_array(const QJSValue &a)
+{
+    const Float64View va = input(a);
+    QVariantList result;
+    result.reserve(va.size);
+    for (int i = 0; i < va.size; ++i) {
+        result.append(va.data[i]);
+    }
+    return result;
+}
+
+// ===== 基本数组操作 =====
+
+QJSValue MathUtils::add(const QJSValue &a, const QJSValue &b)
+{
+    return binary(input(a), input(b), [](double x, double y) { return x + y; });
+}
+
+QJSValue MathUtils::subtract(const QJSValue &a, const QJSValue &b)
+{
+    return binary(input(a), input(b), [](double x, double y) { return x - y; });
+}
+
+QJSValue MathUtils::multiply(const QJSValue &a, const QJSValue &b)
+{
+    return binary(input(a), input(b), [](double x, double y) { return x * y; });
+}
+
+QJSValue MathUtils::divide(const QJSValue &a, const QJSValue &b)
+{
+    return binary(input(a), input(b), [](double x, double y) { return (y != 0) ? x / y : 0; });
+}
+
+QJSValue MathUtils::scale(const QJSValue &a, double factor)
+{
+    return unary(input(a), [factor](double v) { return v * factor; });
+}
+
+QJSValue MathUtils::offset(const QJSValue &a, double value)
+{
+    return unary(input(a), [value](double v) { return v + value; });
+}
+
+// ===== 统计函数 =====
+
+double MathUtils::meanOf(const Float64View &a)
+{
+    if (a.size == 0) return 0;
+    return std::accumulate(a.data, a.data + a.size, 0.0) / a.size;
+}
+
+double MathUtils::varianceOf(const Float64View &a)
+{
+    if (a.size < 2) return 0;
+    double m = meanOf(a);
+    double sum = 0;
+    for (int i = 0; i < a.size; ++i) {
+        sum += (a.data[i] - m) * (a.data[i] - m);
+    }
+    return sum / (a.size - 1);
+}
+
+double MathUtils::sum(const QJSValue &a)
+{
+    const Float64View va = input(a);
+    return std::accumulate(va.data, va.data + va.size, 0.0);
+}
+
+double MathUtils::mean(const QJSValue &a)
+{
+    return meanOf(input(a));
+}
+
+double MathUtils::std_dev(const QJSValue &a)
+{
+    return std::sqrt(varianceOf(input(a)));
+}
+
+double MathUtils::variance(const QJSValue &a)
+{
+    return varianceOf(input(a));
+}
+
+double MathUtils::min_val(const QJSValue &a)
+{
+    const Float64View va = input(a);
+    if (va.size == 0) return 0;
+    return *std::min_element(va.data, va.data + va.size);
+}
+
+double MathUtils::max_val(const QJSValue &a)
+{
+    const Float64View va = input(a);
+    if (va.size == 0) return 0;
+    return *std::max_element(va.data, va.data + va.size);
+}
+
+double MathUtils::rms(const QJSValue &a)
+{
+    const Float64View va = input(a);
+    if (va.size == 0) return 0;
+    double sumSq = 0;
+    for (int i = 0; i < va.size; ++i) {
+        sumSq += va.data[i] * va.data[i];
+    }
+    return std::sqrt(sumSq / va.size);
+}
+
+// ===== 归一化 =====
+
+QJSValue MathUtils::normalize(const QJSValue &a)
+{
+    const Float64View va = input(a);
+    if (va.size == 0) return a;
+    
+    double minV = *std::min_element(va.data, va.data + va.size);
+    double maxV = *std::max_element(va.data, va.data + va.size);
+    double range = maxV - minV;
+    
+    if (range == 0) {
+        return unary(va, [](double) { return 0.5; });
+    }
+    return unary(va, [minV, range](double v) { return (v - minV) / range; });
+}
+
+QJSValue MathUtils::standardize(const QJSValue &a)
+{
+    const Float64View va = input(a);
+    if (va.size < 2) return a;
+    
+    double m = meanOf(va);
+    double s = std::sqrt(varianceOf(va));
+    
+    if (s == 0) {
+        return unary(va, [](double) { return 0.0; });
+    }
+    return unary(va, [m, s](double v) { return (v - m) / s; });
+}
+
+QJSValue MathUtils::normalize_range(const QJSValue &a, double newMin, double newMax)
+{
+    const Float64View va = input(a);
+    if (va.size == 0) return a;
+    
+    double minV = *std::min_element(va.data, va.data + va.size);
+    double maxV = *std::max_element(va.data, va.data + va.size);
+    double range = maxV - minV;
+    
+    if (range == 0) {
+        const double mid = (newMin + newMax) / 2;
+        return unary(va, [mid](double) { return mid; });
+    }
+    return unary(va, [=](double v) { return newMin + (v - minV) / range * (newMax - newMin); });
+}
+
+// ===== 滤波器 =====
+
+QJSValue MathUtils::rolling(const QJSValue &a, int windowSize,
+                           void (*kernel)(const double *, int, int, double *)) const
+{
+    const Float64View va = input(a);
+    if (va.size == 0 || windowSize < 1) return a;
+    
+    Float64Buffer result(va.size);
+    kernel(va.data, va.size, windowSize, result.data());
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::moving_average(const QJSValue &a, int windowSize)
+{
+    return rolling(a, windowSize, RollingWindow::mean);
+}
+
+QJSValue MathUtils::median_filter(const QJSValue &a, int windowSize)
+{
+    return rolling(a, windowSize, RollingWindow::median);
+}
+
+QJSValue MathUtils::rolling_min(const QJSValue &a, int windowSize)
+{
+    return rolling(a, windowSize, RollingWindow::minimum);
+}
+
+QJSValue MathUtils::rolling_max(const QJSValue &a, int windowSize)
+{
+    return rolling(a, windowSize, RollingWindow::maximum);
+}
+
+QJSValue MathUtils::rolling_std(const QJSValue &a, int windowSize)
+{
+    return rolling(a, windowSize, RollingWindow::stddev);
+}
+
+void MathUtils::lowpass(const Float64View &a, double alpha, double *out)
+{
+    out[0] = a.data[0];
+    for (int i = 1; i < a.size; ++i) {
+        out[i] = alpha * a.data[i] + (1 - alpha) * out[i - 1];
+    }
+}
+
+QJSValue MathUtils::lowpass_filter(const QJSValue &a, double cutoffRatio)
+{
+    const Float64View va = input(a);
+    if (va.size == 0) return a;
+    
+    Float64Buffer result(va.size);
+    lowpass(va, qBound(0.0, cutoffRatio, 1.0), result.data());
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::highpass_filter(const QJSValue &a, double cutoffRatio)
+{
+    const Float64View va = input(a);
+    if (va.size == 0) return a;
+    
+    // 原信号减去低通结果，就地完成
+    Float64Buffer result(va.size);
+    double *out = result.data();
+    lowpass(va, qBound(0.0, cutoffRatio, 1.0), out);
+    const double *pa = va.data;
+    parallelFor(va.size, [=](qint64 i) { out[i] = pa[i] - out[i]; });
+    return m_bridge->wrap(result);
+}
+
+// ===== 微积分 =====
+
+QJSValue MathUtils::derivative(const QJSValue &a, double dt)
+{
+    const Float64View va = input(a);
+    if (va.size < 2) return a;
+    
+    const int n = va.size;
+    const double *pa = va.data;
+    Float64Buffer result(n);
+    double *out = result.data();
+    out[0] = (pa[1] - pa[0]) / dt;
+    parallelFor(n, [=](qint64 i) {
+        if (i > 0 && i < n - 1) {
+            out[i] = (pa[i + 1] - pa[i - 1]) / (2 * dt);
+        }
+    });
+    out[n - 1] = (pa[n - 1] - pa[n - 2]) / dt;
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::integral(const QJSValue &a, double dt)
+{
+    const Float64View va = input(a);
+    if (va.size == 0) return a;
+    
+    Float64Buffer result(va.size);
+    double *out = result.data();
+    out[0] = 0;
+    for (int i = 1; i < va.size; ++i) {
+        out[i] = out[i - 1] + (va.data[i] + va.data[i - 1]) / 2 * dt;
+    }
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::cumsum(const QJSValue &a)
+{
+    const Float64View va = input(a);
+    Float64Buffer result(va.size);
+    double *out = result.data();
+    double sum = 0;
+    for (int i = 0; i < va.size; ++i) {
+        sum += va.data[i];
+        out[i] = sum;
+    }
+    return m_bridge->wrap(result);
+}
+
+// ===== 傅里叶变换 =====
+
+std::vector<std::complex<double>> MathUtils::spectrum(const Float64View &a, int &fftSize)
+{
+    // 补零到2的幂次，保持频率轴与 fft_frequency 一致
+    fftSize = 1;
+    while (fftSize < a.size) fftSize <<= 1;
+    
+    std::vector<double> padded(fftSize, 0.0);
+    std::copy(a.data, a.data + a.size, padded.begin());
+    std::vector<std::complex<double>> bins(fftSize / 2 + 1);
+    Fft::realForward(padded.data(), fftSize, bins.data());
+    return bins;
+}
+
+QVector<double> MathUtils::fftMagnitude(const Float64View &a)
+{
+    int n = 0;
+    const std::vector<std::complex<double>> bins = spectrum(a, n);
+    
+    // 只返回正频率部分
+    QVector<double> result(n / 2 + 1);
+    for (int i = 0; i <= n / 2; ++i) {
+        result[i] = std::abs(bins[i]) * 2 / n;
+    }
+    result[0] /= 2;  // DC分量不需要乘2
+    return result;
+}
+
+QJSValue MathUtils::fft_magnitude(const QJSValue &a)
+{
+    return m_bridge->toFloat64Array(fftMagnitude(input(a)));
+}
+
+QJSValue MathUtils::fft_phase(const QJSValue &a)
+{
+    int n = 0;
+    const std::vector<std::complex<double>> bins = spectrum(input(a), n);
+    
+    Float64Buffer result(n / 2 + 1);
+    double *out = result.data();
+    for (int i = 0; i <= n / 2; ++i) {
+        out[i] = std::arg(bins[i]);
+    }
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::fft_frequency(int n, double sampleRate)
+{
+    int fftSize = 1;
+    while (fftSize < n) fftSize <<= 1;
+    
+    Float64Buffer result(fftSize / 2 + 1);
+    double *out = result.data();
+    for (int i = 0; i <= fftSize / 2; ++i) {
+        out[i] = i * sampleRate / fftSize;
+    }
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::power_spectrum(const QJSValue &a)
+{
+    QVector<double> vm = fftMagnitude(input(a));
+    for (double &v : vm) {
+        v = v * v;
+    }
+    return m_bridge->toFloat64Array(vm);
+}
+
+QJSValue MathUtils::welch(const QJSValue &a, int segmentSize, double sampleRate)
+{
+    const Float64View va = input(a);
+    SpectralSettings settings;
+    settings.segmentSize = segmentSize;
+    return m_bridge->toFloat64Array(
+        SpectralAnalyzer::welch(va.data, va.size, settings, sampleRate > 0 ? sampleRate : 1.0));
+}
+
+// ===== 数学函数 =====
+
+QJSValue MathUtils::abs_array(const QJSValue &a)
+{
+    return unary(input(a), [](double v) { return std::abs(v); });
+}
+
+QJSValue MathUtils::sqrt_array(const QJSValue &a)
+{
+    return unary(input(a), [](double v) { return std::sqrt(qMax(0.0, v)); });
+}
+
+QJSValue MathUtils::pow_array(const QJSValue &a, double exp)
+{
+    return unary(input(a), [exp](double v) { return std::pow(v, exp); });
+}
+
+QJSValue MathUtils::log_array(const QJSValue &a)
+{
+    return unary(input(a), [](double v) { return (v > 0) ? std::log(v) : 0; });
+}
+
+QJSValue MathUtils::log10_array(const QJSValue &a)
+{
+    return unary(input(a), [](double v) { return (v > 0) ? std::log10(v) : 0; });
+}
+
+QJSValue MathUtils::exp_array(const QJSValue &a)
+{
+    return unary(input(a), [](double v) { return std::exp(v); });
+}
+
+QJSValue MathUtils::sin_array(const QJSValue &a)
+{
+    return unary(input(a), [](double v) { return std::sin(v); });
+}
+
+QJSValue MathUtils::cos_array(const QJSValue &a)
+{
+    return unary(input(a), [](double v) { return std::cos(v); });
+}
+
+QJSValue MathUtils::tan_array(const QJSValue &a)
+{
+    return unary(input(a), [](double v) { return std::tan(v); });
+}
+
+// ===== 信号生成 =====
+
+QJSValue MathUtils::linspace(double start, double end, int n)
+{
+    Float64Buffer result(n);
+    double *out = result.data();
+    if (n == 1) {
+        out[0] = start;
+    } else if (n > 1) {
+        double step = (end - start) / (n - 1);
+        parallelFor(n, [=](qint64 i) { out[i] = start + i * step; });
+    }
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::zeros(int n)
+{
+    Float64Buffer result(n);
+    std::fill(result.data(), result.data() + result.size(), 0.0);
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::ones(int n)
+{
+    Float64Buffer result(n);
+    std::fill(result.data(), result.data() + result.size(), 1.0);
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::sine_wave(int n, double frequency, double amplitude, double phase)
+{
+    Float64Buffer result(n);
+    double *out = result.data();
+    parallelFor(result.size(), [=](qint64 i) {
+        out[i] = amplitude * std::sin(2 * M_PI * frequency * i / n + phase);
+    });
+    return m_bridge->wrap(result);
+}
+
+// ===== 相关性分析 =====
+
+QJSValue MathUtils::cross_correlation(const QJSValue &a, const QJSValue &b)
+{
+    const Float64View va = input(a);
+    const Float64View vb = input(b);
+    int n = qMax(va.size, vb.size);
+    
+    Float64Buffer result(2 * n - 1);
+    double *out = result.data();
+    std::fill(out, out + result.size(), 0.0);
+    if (va.size == 0 || vb.size == 0) {
+        return m_bridge->wrap(result);
+    }
+    
+    // FFT求各延迟的乘积和（lag 从 -(na-1) 到 nb-1），再除以重叠的点数
+    std::vector<double> sums(va.size + vb.size - 1);
+    Fft::correlate(va.data, va.size, vb.data, vb.size, sums.data());
+    for (int lag = -(va.size - 1); lag < vb.size; ++lag) {
+        const int count = qMin(va.size, vb.size - lag) - qMax(0, -lag);
+        if (count > 0) {
+            out[lag + n - 1] = sums[lag + va.size - 1] / count;
+        }
+    }
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::convolve(const QJSValue &a, const QJSValue &b)
+{
+    const Float64View va = input(a);
+    const Float64View vb = input(b);
+    if (va.size == 0 || vb.size == 0) {
+        return m_bridge->wrap(Float64Buffer(0));
+    }
+    
+    Float64Buffer result(va.size + vb.size - 1);
+    Fft::convolve(va.data, va.size, vb.data, vb.size, result.data());
+    return m_bridge->wrap(result);
+}
+
+double MathUtils::correlation_coefficient(const QJSValue &a, const QJSValue &b)
+{
+    const Float64View va = input(a);
+    const Float64View vb = input(b);
+    int n = qMin(va.size, vb.size);
+    if (n < 2) return 0;
+    
+    double meanA = 0, meanB = 0;
+    for (int i = 0; i < n; ++i) {
+        meanA += va.data[i];
+        meanB += vb.data[i];
+    }
+    meanA /= n;
+    meanB /= n;
+    
+    double cov = 0, varA = 0, varB = 0;
+    for (int i = 0; i < n; ++i) {
+        double da = va.data[i] - meanA;
+        double db = vb.data[i] - meanB;
+        cov += da * db;
+        varA += da * da;
+        varB += db * db;
+    }
+    
+    if (varA == 0 || varB == 0) return 0;
+    return cov / std::sqrt(varA * varB);
+}
+
+// ===== 插值与重采样 =====
+
+QJSValue MathUtils::resample(const QJSValue &a, int newSize)
+{
+    const Float64View va = input(a);
+    if (va.size == 0 || newSize < 1) return a;
+    
+    const double *pa = va.data;
+    const int last = va.size - 1;
+    Float64Buffer result(newSize);
+    double *out = result.data();
+    double ratio = newSize > 1 ? (double)last / (newSize - 1) : 0.0;
+    
+    parallelFor(newSize, [=](qint64 i) {
+        double idx = i * ratio;
+        int idx0 = (int)idx;
+        int idx1 = qMin(idx0 + 1, last);
+        double frac = idx - idx0;
+        out[i] = pa[idx0] * (1 - frac) + pa[idx1] * frac;
+    });
+    return m_bridge->wrap(result);
+}
+
+QJSValue MathUtils::interp_linear(const QJSValue &x, const QJSValue &y, const QJSValue &xNew)
+{
+    const Float64View vx = input(x);
+    const Float64View vy = input(y);
+    const Float64View vxNew = input(xNew);
+    
+    if (vx.size != vy.size || vx.size == 0) {
+        return xNew;
+    }
+    
+    Float64Buffer result(vxNew.size);
+    double *out = result.data();
+    
+    for (int i = 0; i < vxNew.size; ++i) {
+        double xi = vxNew.data[i];
+        
+        // 找到插值区间
+        int j = 0;
+        while (j < vx.size - 1 && vx.data[j + 1] < xi) j++;
+        
+        if (j >= vx.size - 1) {
+            out[i] = vy.data[vy.size - 1];
+        } else if (xi <= vx.data[0]) {
+            out[i] = vy.data[0];
+        } else {
+            double t = (xi - vx.data[j]) / (vx.data[j + 1] - vx.data[j]);
+            out[i] = vy.data[j] * (1 - t) + vy.data[j + 1] * t;
+        }
+    }
+    return m_bridge->wrap(result);
+}
+
+// ==================== 时间转换函数 ====================
+
+QJSValue MathUtils::ms_to_s_from_zero(const QJSValue &a)
+{
+    // 毫秒转秒，从0开始
+    return time_from_zero(a, 0.001);
+}
+
+QJSValue MathUtils::us_to_s_from_zero(const QJSValue &a)
+{
+    // 微秒转秒，从0开始
+    return time_from_zero(a, 0.000001);
+}
+
+QJSValue MathUtils::ns_to_s_from_zero(const QJSValue &a)
+{
+    // 纳秒转秒，从0开始
+    return time_from_zero(a, 0.000000001);
+}
+
+QJSValue MathUtils::time_from_zero(const QJSValue &a, double scaleFactor)
+{
+    const Float64View va = input(a);
+    if (va.size == 0) return a;
+    
+    // 获取起始时间（第一个值），减去起始时间并乘以缩放因子
+    double startTime = va.data[0];
+    return unary(va, [startTime, scaleFactor](double v) { return (v - startTime) * scaleFactor; });
+}
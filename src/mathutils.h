@@ -0,0 +1,137 @@
+#ifndef MATHUTILS_H
+#define MATHUTILS_H
+
+#include <QObject>
+#include <QJSValue>
+#include <QVariant>
+#include <QVector>
+#include <complex>
+#include <vector>
+#include "typedarraybridge.h"
+
+/**
+ * @brief 数学工具类，提供给JS引擎使用
+ * 数组参数可以是 Float64Array、其他类型化数组或普通数组；Float64Array 直接读取其存储，
+ * 数组结果以 Float64Array 返回，链式调用时中间结果不经过 QVariant 装箱
+ */
+class MathUtils : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit MathUtils(TypedArrayBridge *bridge, QObject *parent = nullptr)
+        : QObject(parent), m_bridge(bridge) {}
+    
+    // ===== 基本数组操作 =====
+    Q_INVOKABLE QJSValue add(const QJSValue &a, const QJSValue &b);
+    Q_INVOKABLE QJSValue subtract(const QJSValue &a, const QJSValue &b);
+    Q_INVOKABLE QJSValue multiply(const QJSValue &a, const QJSValue &b);
+    Q_INVOKABLE QJSValue divide(const QJSValue &a, const QJSValue &b);
+    Q_INVOKABLE QJSValue scale(const QJSValue &a, double factor);
+    Q_INVOKABLE QJSValue offset(const QJSValue &a, double value);
+    
+    // ===== 统计函数 =====
+    Q_INVOKABLE double sum(const QJSValue &a);
+    Q_INVOKABLE double mean(const QJSValue &a);
+    Q_INVOKABLE double std_dev(const QJSValue &a);
+    Q_INVOKABLE double variance(const QJSValue &a);
+    Q_INVOKABLE double min_val(const QJSValue &a);
+    Q_INVOKABLE double max_val(const QJSValue &a);
+    Q_INVOKABLE double rms(const QJSValue &a);
+    
+    // ===== 归一化 =====
+    Q_INVOKABLE QJSValue normalize(const QJSValue &a);           // 0-1归一化
+    Q_INVOKABLE QJSValue standardize(const QJSValue &a);         // Z-score标准化
+    Q_INVOKABLE QJSValue normalize_range(const QJSValue &a, double newMin, double newMax);
+    
+    // ===== 滤波器 =====
+    Q_INVOKABLE QJSValue moving_average(const QJSValue &a, int windowSize);
+    Q_INVOKABLE QJSValue median_filter(const QJSValue &a, int windowSize);
+    Q_INVOKABLE QJSValue rolling_min(const QJSValue &a, int windowSize);
+    Q_INVOKABLE QJSValue rolling_max(const QJSValue &a, int windowSize);
+    Q_INVOKABLE QJSValue rolling_std(const QJSValue &a, int windowSize);
+    Q_INVOKABLE QJSValue lowpass_filter(const QJSValue &a, double cutoffRatio);
+    Q_INVOKABLE QJSValue highpass_filter(const QJSValue &a, double cutoffRatio);
+    
+    // ===== 微积分 =====
+    Q_INVOKABLE QJSValue derivative(const QJSValue &a, double dt = 1.0);
+    Q_INVOKABLE QJSValue integral(const QJSValue &a, double dt = 1.0);
+    Q_INVOKABLE QJSValue cumsum(const QJSValue &a);
+    
+    // ===== 傅里叶变换 =====
+    Q_INVOKABLE QJSValue fft_magnitude(const QJSValue &a);       // FFT幅值
+    Q_INVOKABLE QJSValue fft_phase(const QJSValue &a);           // FFT相位
+    Q_INVOKABLE QJSValue fft_frequency(int n, double sampleRate);    // 频率轴
+    Q_INVOKABLE QJSValue power_spectrum(const QJSValue &a);      // 功率谱
+    Q_INVOKABLE QJSValue welch(const QJSValue &a, int segmentSize = 1024,
+                               double sampleRate = 1.0);          // Welch功率谱密度
+    
+    // ===== 数学函数 =====
+    Q_INVOKABLE QJSValue abs_array(const QJSValue &a);
+    Q_INVOKABLE QJSValue sqrt_array(const QJSValue &a);
+    Q_INVOKABLE QJSValue pow_array(const QJSValue &a, double exp);
+    Q_INVOKABLE QJSValue log_array(const QJSValue &a);
+    Q_INVOKABLE QJSValue log10_array(const QJSValue &a);
+    Q_INVOKABLE QJSValue exp_array(const QJSValue &a);
+    Q_INVOKABLE QJSValue sin_array(const QJSValue &a);
+    Q_INVOKABLE QJSValue cos_array(const QJSValue &a);
+    Q_INVOKABLE QJSValue tan_array(const QJSValue &a);
+    
+    // ===== 信号生成 =====
+    Q_INVOKABLE QJSValue linspace(double start, double end, int n);
+    Q_INVOKABLE QJSValue zeros(int n);
+    Q_INVOKABLE QJSValue ones(int n);
+    Q_INVOKABLE QJSValue sine_wave(int n, double frequency, double amplitude = 1.0, double phase = 0.0);
+    
+    // ===== 相关性分析 =====
+    Q_INVOKABLE QJSValue cross_correlation(const QJSValue &a, const QJSValue &b);
+    Q_INVOKABLE QJSValue convolve(const QJSValue &a, const QJSValue &b);
+    Q_INVOKABLE double correlation_coefficient(const QJSValue &a, const QJSValue &b);
+    
+    // ===== 插值与重采样 =====
+    Q_INVOKABLE QJSValue resample(const QJSValue &a, int newSize);
+    Q_INVOKABLE QJSValue interp_linear(const QJSValue &x, const QJSValue &y, const QJSValue &xNew);
+    
+    // ===== 时间转换 =====
+    Q_INVOKABLE QJSValue ms_to_s_from_zero(const QJSValue &a);   // ms转s，从0开始
+    Q_INVOKABLE QJSValue us_to_s_from_zero(const QJSValue &a);   // us转s，从0开始
+    Q_INVOKABLE QJSValue ns_to_s_from_zero(const QJSValue &a);   // ns转s，从0开始
+    Q_INVOKABLE QJSValue time_from_zero(const QJSValue &a, double scaleFactor = 1.0);  // 通用时间归零并缩放
+    
+    // ===== 兼容 =====
+    Q_INVOKABLE QVariantList to_array(const QJSValue &a);        // 转为普通JS数组（需要 push/concat 等数组方法时使用）
+    
+private:
+    /**
+     * @brief 数组参数的只读视图，不是数组时为空
+     */
+    Float64View input(const QJSValue &value) const;
+    
+    /**
+     * @brief 逐元素运算（多线程分块执行）
+     */
+    template <typename Fn>
+    QJSValue unary(const Float64View &a, Fn fn) const;
+    template <typename Fn>
+    QJSValue binary(const Float64View &a, const Float64View &b, Fn fn) const;
+    
+    /**
+     * @brief 滑动窗口运算，kernel 为 RollingWindow 中的函数
+     */
+    QJSValue rolling(const QJSValue &a, int windowSize,
+                     void (*kernel)(const double *, int, int, double *)) const;
+    
+    static double meanOf(const Float64View &a);
+    static double varianceOf(const Float64View &a);
+    static void lowpass(const Float64View &a, double alpha, double *out);
+    QVector<double> fftMagnitude(const Float64View &a);
+    
+    /**
+     * @brief 补零到2的幂次后的实数FFT，返回 fftSize/2+1 个频率分量
+     */
+    static std::vector<std::complex<double>> spectrum(const Float64View &a, int &fftSize);
+    
+    TypedArrayBridge *m_bridge;
+};
+
+#endif // MATHUTILS_H
@@ -0,0 +1,271 @@
+#include "overviewwidget.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QResizeEvent>
+#include <cmath>
+
+namespace {
+// 刷选框边缘的可拖拽宽度（像素）
+const double kEdgeGrip = 5.0;
+// 刷选框的最小宽度（像素）
+const double kMinBrushWidth = 4.0;
+}
+
+OverviewWidget::OverviewWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_dataMin(0.0)
+    , m_dataMax(1.0)
+    , m_viewMin(0.0)
+    , m_viewMax(1.0)
+    , m_leftMargin(0)
+    , m_rightMargin(0)
+    , m_backgroundDirty(true)
+    , m_dragMode(DragNone)
+    , m_dragStartPixel(0.0)
+    , m_dragStartMin(0.0)
+    , m_dragStartMax(0.0)
+{
+    setMouseTracking(true);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    setFixedHeight(56);
+}
+
+QSize OverviewWidget::sizeHint() const
+{
+    return QSize(400, 56);
+}
+
+void OverviewWidget::setSeries(const QList<OverviewSeries> &series)
+{
+    m_series = series;
+    m_backgroundDirty = true;
+    update();
+}
+
+void OverviewWidget::setDataRange(double xMin, double xMax)
+{
+    if (m_dataMin == xMin && m_dataMax == xMax) {
+        return;
+    }
+    m_dataMin = xMin;
+    m_dataMax = xMax;
+    m_backgroundDirty = true;
+    update();
+}
+
+void OverviewWidget::setViewRange(double xMin, double xMax)
+{
+    m_viewMin = xMin;
+    m_viewMax = xMax;
+    update();
+}
+
+void OverviewWidget::setPlotMargins(int left, int right)
+{
+    if (m_leftMargin == left && m_rightMargin == right) {
+        return;
+    }
+    m_leftMargin = left;
+    m_rightMargin = right;
+    m_backgroundDirty = true;
+    update();
+}
+
+QRectF OverviewWidget::plotRect() const
+{
+    return QRectF(m_leftMargin, 2, qMax(1, width() - m_leftMargin - m_rightMargin), height() - 4);
+}
+
+double OverviewWidget::xToPixel(double x) const
+{
+    QRectF rect = plotRect();
+    if (!(m_dataMax > m_dataMin)) {
+        return rect.left();
+    }
+    return rect.left() + (x - m_dataMin) / (m_dataMax - m_dataMin) * rect.width();
+}
+
+double OverviewWidget::pixelToX(double pixel) const
+{
+    QRectF rect = plotRect();
+    return m_dataMin + (pixel - rect.left()) / rect.width() * (m_dataMax - m_dataMin);
+}
+
+OverviewWidget::DragMode OverviewWidget::hitTest(double pixel) const
+{
+    double left = xToPixel(m_viewMin);
+    double right = xToPixel(m_viewMax);
+    if (qAbs(pixel - left) <= kEdgeGrip) {
+        return DragLeft;
+    }
+    if (qAbs(pixel - right) <= kEdgeGrip) {
+        return DragRight;
+    }
+    if (pixel > left && pixel < right) {
+        return DragMove;
+    }
+    return DragNone;
+}
+
+void OverviewWidget::renderBackground()
+{
+    const qreal dpr = devicePixelRatioF();
+    m_background = QPixmap(size() * dpr);
+    m_background.setDevicePixelRatio(dpr);
+    m_background.fill(Qt::transparent);
+    m_backgroundDirty = false;
+
+    QRectF rect = plotRect();
+    if (!(m_dataMax > m_dataMin) || rect.width() <= 1) {
+        return;
+    }
+
+    QPainter painter(&m_background);
+    painter.fillRect(rect, QColor(248, 248, 248));
+    painter.setPen(QColor(200, 200, 200));
+    painter.drawRect(rect.adjusted(0, 0, -1, -1));
+
+    // 每个物理像素列从金字塔取一次最小/最大值，绘制为竖线
+    const int columns = qMax(1, qRound(rect.width() * dpr));
+    for (const OverviewSeries &series : m_series) {
+        if (!series.lod) {
+            continue;
+        }
+        double yRange = series.yMax - series.yMin;
+        if (!(yRange > 0)) {
+            yRange = 1.0;
+        }
+        QColor color = series.color;
+        color.setAlpha(180);
+        painter.setPen(QPen(color, 1.0 / dpr));
+
+        const QVector<LodPyramid::Column> cols = series.lod->aggregate(m_dataMin, m_dataMax, columns);
+        for (const LodPyramid::Column &c : cols) {
+            if (c.count == 0) {
+                continue;
+            }
+            double px = xToPixel(c.x);
+            double top = rect.bottom() - (c.max - series.yMin) / yRange * rect.height();
+            double bottom = rect.bottom() - (c.min - series.yMin) / yRange * rect.height();
+            painter.drawLine(QPointF(px, top), QPointF(px, qMax(bottom, top + 1.0 / dpr)));
+        }
+    }
+}
+
+void OverviewWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    if (m_backgroundDirty || m_background.size() != size() * devicePixelRatioF()) {
+        renderBackground();
+    }
+
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_background);
+
+    QRectF rect = plotRect();
+    if (!(m_dataMax > m_dataMin)) {
+        return;
+    }
+
+    // 刷选框外的区域变暗
+    double left = qBound(rect.left(), xToPixel(m_viewMin), rect.right());
+    double right = qBound(rect.left(), xToPixel(m_viewMax), rect.right());
+    QColor shade(0, 0, 0, 40);
+    painter.fillRect(QRectF(rect.left(), rect.top(), left - rect.left(), rect.height()), shade);
+    painter.fillRect(QRectF(right, rect.top(), rect.right() - right, rect.height()), shade);
+
+    QRectF brush(left, rect.top(), qMax(right - left, 1.0), rect.height());
+    painter.setPen(QPen(QColor(30, 120, 220), 1.5));
+    painter.setBrush(QColor(30, 120, 220, 30));
+    painter.drawRect(brush);
+}
+
+void OverviewWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    m_backgroundDirty = true;
+}
+
+void OverviewWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || !(m_dataMax > m_dataMin)) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    double pixel = event->position().x();
+#else
+    double pixel = event->localPos().x();
+#endif
+
+    m_dragMode = hitTest(pixel);
+    emit dragStarted();
+    if (m_dragMode == DragNone) {
+        // 点击空白处：将当前视图居中到点击位置，随后可继续拖动
+        double half = (m_viewMax - m_viewMin) / 2;
+        double center = pixelToX(pixel);
+        m_viewMin = center - half;
+        m_viewMax = center + half;
+        emit viewRangeRequested(m_viewMin, m_viewMax);
+        update();
+        m_dragMode = DragMove;
+    }
+    m_dragStartPixel = pixel;
+    m_dragStartMin = m_viewMin;
+    m_dragStartMax = m_viewMax;
+}
+
+void OverviewWidget::mouseMoveEvent(QMouseEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    double pixel = event->position().x();
+#else
+    double pixel = event->localPos().x();
+#endif
+
+    if (m_dragMode == DragNone) {
+        DragMode hover = hitTest(pixel);
+        setCursor(hover == DragLeft || hover == DragRight ? Qt::SizeHorCursor
+                  : hover == DragMove ? Qt::OpenHandCursor : Qt::ArrowCursor);
+        return;
+    }
+
+    QRectF rect = plotRect();
+    double delta = (pixel - m_dragStartPixel) / rect.width() * (m_dataMax - m_dataMin);
+    double minWidth = kMinBrushWidth / rect.width() * (m_dataMax - m_dataMin);
+
+    double newMin = m_dragStartMin;
+    double newMax = m_dragStartMax;
+    switch (m_dragMode) {
+        case DragMove:
+            newMin += delta;
+            newMax += delta;
+            break;
+        case DragLeft:
+            newMin = qMin(m_dragStartMin + delta, newMax - minWidth);
+            break;
+        case DragRight:
+            newMax = qMax(m_dragStartMax + delta, newMin + minWidth);
+            break;
+        case DragNone:
+            break;
+    }
+
+    if (newMin != m_viewMin || newMax != m_viewMax) {
+        m_viewMin = newMin;
+        m_viewMax = newMax;
+        update();
+        emit viewRangeRequested(newMin, newMax);
+    }
+}
+
+void OverviewWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && m_dragMode != DragNone) {
+        m_dragMode = DragNone;
+        emit dragFinished();
+    }
+    QWidget::mouseReleaseEvent(event);
+}
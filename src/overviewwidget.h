@@ -0,0 +1,106 @@
+#ifndef OVERVIEWWIDGET_H
+#define OVERVIEWWIDGET_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <QColor>
+#include <QList>
+#include <QSharedPointer>
+#include "lodpyramid.h"
+
+/**
+ * @brief 概览条中的一条曲线
+ */
+struct OverviewSeries {
+    QSharedPointer<const LodPyramid> lod;
+    QColor color;
+    double yMin = 0.0;      // 曲线自身的Y范围（每条曲线独立归一化）
+    double yMax = 1.0;
+};
+
+/**
+ * @brief 图表下方的概览条
+ * 用LOD金字塔的粗粒度数据绘制全部数据，并以可拖拽的刷选框表示当前X范围。
+ * 拖动刷选框内部平移视图，拖动左右边缘调整范围，点击空白处将视图居中到该位置
+ */
+class OverviewWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit OverviewWidget(QWidget *parent = nullptr);
+
+    /**
+     * @brief 设置曲线（只保存金字塔指针，不复制数据）
+     */
+    void setSeries(const QList<OverviewSeries> &series);
+
+    /**
+     * @brief 设置全部数据的X范围
+     */
+    void setDataRange(double xMin, double xMax);
+
+    /**
+     * @brief 设置当前视图的X范围（刷选框位置）
+     */
+    void setViewRange(double xMin, double xMax);
+
+    /**
+     * @brief 设置左右边距，使概览与主图绘图区域对齐
+     */
+    void setPlotMargins(int left, int right);
+
+    QSize sizeHint() const override;
+
+signals:
+    /**
+     * @brief 用户拖动刷选框请求新的视图范围
+     */
+    void viewRangeRequested(double xMin, double xMax);
+    
+    /**
+     * @brief 开始/结束拖动刷选框，期间主图视为正在交互
+     */
+    void dragStarted();
+    void dragFinished();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
+private:
+    enum DragMode {
+        DragNone,
+        DragMove,
+        DragLeft,
+        DragRight
+    };
+
+    QRectF plotRect() const;
+    double xToPixel(double x) const;
+    double pixelToX(double pixel) const;
+    DragMode hitTest(double pixel) const;
+    void renderBackground();
+
+    QList<OverviewSeries> m_series;
+    double m_dataMin;
+    double m_dataMax;
+    double m_viewMin;
+    double m_viewMax;
+    int m_leftMargin;
+    int m_rightMargin;
+
+    // 曲线部分缓存为位图，刷选框移动时只重绘刷选框
+    QPixmap m_background;
+    bool m_backgroundDirty;
+
+    DragMode m_dragMode;
+    double m_dragStartPixel;
+    double m_dragStartMin;
+    double m_dragStartMax;
+};
+
+#endif // OVERVIEWWIDGET_H
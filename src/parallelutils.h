@@ -0,0 +1,92 @@
+#ifndef PARALLELUTILS_H
+#define PARALLELUTILS_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief 并行工具
+ * 将 [0, count) 均匀划分为若干连续块，并在多个线程上执行
+ */
+namespace ParallelUtils {
+
+/**
+ * @brief 线程数覆盖值，大于0时代替硬件线程数
+ * 供测试在单核机器上也按多块划分，检查块边界的处理
+ */
+inline std::atomic<int> &threadCountOverride()
+{
+    static std::atomic<int> value(0);
+    return value;
+}
+
+/**
+ * @brief 获取可用的硬件线程数
+ */
+inline int threadCount()
+{
+    const int forced = threadCountOverride().load(std::memory_order_relaxed);
+    if (forced > 0) {
+        return forced;
+    }
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n);
+}
+
+/**
+ * @brief 计算实际划分的块数
+ * @param count 元素总数
+ * @param minChunk 每块的最小元素数（任务过小时不值得开线程）
+ * @param maxThreads 最大线程数（<=0 表示不限制）
+ */
+inline int chunkCount(qint64 count, qint64 minChunk, int maxThreads = 0)
+{
+    if (count <= 0) {
+        return 0;
+    }
+    int threads = threadCount();
+    if (maxThreads > 0) {
+        threads = std::min(threads, maxThreads);
+    }
+    qint64 bySize = std::max<qint64>(1, count / std::max<qint64>(1, minChunk));
+    return static_cast<int>(std::min<qint64>(threads, bySize));
+}
+
+/**
+ * @brief 按块并行执行
+ * @param fn 回调 fn(begin, end, chunkIndex)，chunkIndex 范围为 [0, chunkCount)
+ * @return 实际使用的块数（与 chunkCount() 一致）
+ */
+template <typename Fn>
+int forChunks(qint64 count, qint64 minChunk, int maxThreads, Fn fn)
+{
+    const int chunks = chunkCount(count, minChunk, maxThreads);
+    if (chunks <= 1) {
+        if (chunks == 1) {
+            fn(qint64(0), count, 0);
+        }
+        return chunks;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (int c = 1; c < chunks; ++c) {
+        const qint64 begin = count * c / chunks;
+        const qint64 end = count * (c + 1) / chunks;
+        workers.emplace_back([&fn, begin, end, c]() { fn(begin, end, c); });
+    }
+    // 第0块在当前线程执行
+    fn(qint64(0), count / chunks, 0);
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    return chunks;
+}
+
+} // namespace ParallelUtils
+
+#endif // PARALLELUTILS_H
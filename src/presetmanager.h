@@ -11,6 +11,7 @@
 #include <QFile>
 #include <QDir>
 #include <QStandardPaths>
+#include <QVersionNumber>
 #include "seriesstyledialog.h"
 
 /**
@@ -21,18 +22,24 @@ struct ScriptPreset
 {
     QString outputName;             // 输出列名
     QString script;                 // 脚本内容
+    bool legacyArrays = false;      // 按旧版数组接口执行（math 结果和 data 列为普通数组）
     
     QJsonObject toJson() const {
         QJsonObject obj;
         obj["outputName"] = outputName;
         obj["script"] = script;
+        obj["legacyArrays"] = legacyArrays;
         return obj;
     }
     
-    static ScriptPreset fromJson(const QJsonObject &obj) {
+    /**
+     * @param legacyDefault 没有记录数组接口时的取值（旧版本方案中的脚本按旧版接口编写）
+     */
+    static ScriptPreset fromJson(const QJsonObject &obj, bool legacyDefault = false) {
         ScriptPreset preset;
         preset.outputName = obj["outputName"].toString();
         preset.script = obj["script"].toString();
+        preset.legacyArrays = obj["legacyArrays"].toBool(legacyDefault);
         return preset;
     }
 };
@@ -127,15 +134,21 @@ struct PresetScheme
 {
     QString name;                       // 方案名称
     QString description;                // 方案描述（可选）
-    QString version;                    // 版本号
+    QString version;                    // 版本号（读取时为文件中的版本，保存时写入当前版本）
     QList<ScriptPreset> scripts;        // 脚本列表（先执行）
     QList<PlotPreset> canvasPresets;    // 各Canvas的预设
     
+    /**
+     * @brief 当前方案格式的版本
+     * 1.1 起每个脚本记录数组接口；1.0 的脚本按 math 返回普通数组时编写，读取时按旧版接口执行
+     */
+    static QString currentVersion() { return QStringLiteral("1.1"); }
+    
     QJsonObject toJson() const {
         QJsonObject obj;
         obj["name"] = name;
         obj["description"] = description;
-        obj["version"] = version.isEmpty() ? "1.0" : version;
+        obj["version"] = currentVersion();
         
         // 保存脚本
         QJsonArray scriptArray;
@@ -160,9 +173,10 @@ struct PresetScheme
         scheme.version = obj["version"].toString("1.0");
         
         // 加载脚本
+        const bool legacyScripts = QVersionNumber::fromString(scheme.version) < QVersionNumber(1, 1);
         QJsonArray scriptArr = obj["scripts"].toArray();
         for (const auto &val : scriptArr) {
-            scheme.scripts.append(ScriptPreset::fromJson(val.toObject()));
+            scheme.scripts.append(ScriptPreset::fromJson(val.toObject(), legacyScripts));
         }
         
         // 加载Canvas预设
@@ -0,0 +1,163 @@
+#include "rangefilter.h"
+#include "parallelutils.h"
+#include "xvalues.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// 每块至少处理的点数
+const qint64 kMinPointsPerChunk = 256 * 1024;
+
+} // namespace
+
+RangeFilter::Result RangeFilter::filter(const QVector<double> &xData,
+                                        const QVector<double> &yData,
+                                        double minValue, double maxValue)
+{
+    Result result;
+    const qint64 count = XValues::count(xData, yData);
+    if (count == 0) {
+        return result;
+    }
+
+    const XValues px(xData);
+    const double *py = yData.constData();
+    // 取反的比较同时过滤掉NaN；结果为0/1，便于编译器向量化
+    auto keep = [=](qint64 i) -> int {
+        return (py[i] >= minValue) & (py[i] <= maxValue);
+    };
+
+    // 第一遍：统计每块的保留点数和段起点数（段起点 = 保留且前一点未保留）
+    const int chunks = ParallelUtils::chunkCount(count, kMinPointsPerChunk);
+    std::vector<qint64> kept(chunks, 0);
+    std::vector<qint64> starts(chunks, 0);
+    ParallelUtils::forChunks(count, kMinPointsPerChunk, 0,
+                             [&](qint64 begin, qint64 end, int chunk) {
+        qint64 k = 0;
+        qint64 s = 0;
+        int prev = begin > 0 ? keep(begin - 1) : 0;
+        for (qint64 i = begin; i < end; ++i) {
+            const int cur = keep(i);
+            k += cur;
+            s += cur & (prev ^ 1);
+            prev = cur;
+        }
+        kept[chunk] = k;
+        starts[chunk] = s;
+    });
+
+    // 每个段起点前写一个分隔点，第一段除外：整体向前偏移一个位置
+    std::vector<qint64> offsets(chunks, 0);
+    qint64 total = 0;
+    qint64 segments = 0;
+    for (int c = 0; c < chunks; ++c) {
+        offsets[c] = total - 1;
+        total += kept[c] + starts[c];
+        segments += starts[c];
+    }
+    if (segments == 0) {
+        return result;
+    }
+    total -= 1;
+
+    result.x.resize(static_cast<int>(total));
+    result.y.resize(static_cast<int>(total));
+    result.pointCount = static_cast<int>(total - (segments - 1));
+    result.gapCount = static_cast<int>(segments - 1);
+    double *outX = result.x.data();
+    double *outY = result.y.data();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    // 第二遍：各块按偏移并行写出
+    ParallelUtils::forChunks(count, kMinPointsPerChunk, 0,
+                             [&](qint64 begin, qint64 end, int chunk) {
+        qint64 pos = offsets[chunk];
+        int prev = begin > 0 ? keep(begin - 1) : 0;
+        for (qint64 i = begin; i < end; ++i) {
+            const int cur = keep(i);
+            if (cur) {
+                if (!prev) {
+                    if (pos >= 0) {
+                        outX[pos] = px[i];
+                        outY[pos] = nan;
+                    }
+                    ++pos;
+                }
+                outX[pos] = px[i];
+                outY[pos] = py[i];
+                ++pos;
+            }
+            prev = cur;
+        }
+    });
+    return result;
+}
+
+QList<QVector<QPointF>> RangeFilter::splitSegments(const QVector<QPointF> &points, int maxSegments)
+{
+    // 收集各段的下标范围 [first, last)
+    struct Run {
+        int first;
+        int last;
+    };
+    QVector<Run> runs;
+    int i = 0;
+    const int n = points.size();
+    while (i < n) {
+        while (i < n && isBreak(points[i].y())) {
+            ++i;
+        }
+        if (i >= n) {
+            break;
+        }
+        Run run;
+        run.first = i;
+        while (i < n && !isBreak(points[i].y())) {
+            ++i;
+        }
+        run.last = i;
+        runs.append(run);
+    }
+
+    // 段数过多时只保留X跨度最大的 maxSegments-1 个间断
+    QVector<bool> split(qMax(0, runs.size() - 1), true);
+    if (maxSegments == 1) {
+        split.fill(false);
+    } else if (maxSegments > 1 && runs.size() > maxSegments) {
+        QVector<double> widths(split.size());
+        for (int g = 0; g < split.size(); ++g) {
+            widths[g] = qAbs(points[runs[g + 1].first].x() - points[runs[g].last - 1].x());
+        }
+        QVector<double> sorted = widths;
+        const int keepGaps = maxSegments - 1;
+        std::nth_element(sorted.begin(), sorted.begin() + (sorted.size() - keepGaps), sorted.end());
+        const double threshold = sorted[sorted.size() - keepGaps];
+        int remaining = keepGaps;
+        for (int g = 0; g < split.size(); ++g) {
+            split[g] = widths[g] > threshold;
+            remaining -= split[g] ? 1 : 0;
+        }
+        // 与阈值相等的间断按顺序补足
+        for (int g = 0; g < split.size() && remaining > 0; ++g) {
+            if (!split[g] && widths[g] == threshold) {
+                split[g] = true;
+                --remaining;
+            }
+        }
+    }
+
+    QList<QVector<QPointF>> segments;
+    QVector<QPointF> current;
+    for (int r = 0; r < runs.size(); ++r) {
+        for (int k = runs[r].first; k < runs[r].last; ++k) {
+            current.append(points[k]);
+        }
+        if (r == runs.size() - 1 || split[r]) {
+            segments.append(current);
+            current.clear();
+        }
+    }
+    return segments;
+}
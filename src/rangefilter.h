@@ -0,0 +1,49 @@
+#ifndef RANGEFILTER_H
+#define RANGEFILTER_H
+
+#include <QVector>
+#include <QPointF>
+#include <QList>
+#include <cmath>
+
+/**
+ * @brief 曲线数据的区间过滤与断点处理
+ * 被过滤掉的点不再直接删除后首尾相连，而是在每个间断处插入一个Y为NaN的分隔点，
+ * 绘制时在分隔点处断开折线
+ */
+class RangeFilter
+{
+public:
+    /**
+     * @brief 过滤结果
+     * x/y 中每段连续数据之间以一个分隔点隔开（X取下一段第一个点的X，保持X的单调性）
+     */
+    struct Result {
+        QVector<double> x;
+        QVector<double> y;
+        int pointCount = 0;     // 保留的数据点数（不含分隔点）
+        int gapCount = 0;       // 分隔点个数
+    };
+
+    /**
+     * @brief 保留 minValue <= y <= maxValue 的点（NaN总是被过滤）
+     * xData 为空时X为行索引，结果中只为保留下来的点生成X值
+     * 两遍多线程处理：第一遍无分支地统计各块的保留点数和段数，
+     * 第二遍按前缀和得到的偏移并行写出，结果只分配一次
+     */
+    static Result filter(const QVector<double> &xData, const QVector<double> &yData,
+                         double minValue, double maxValue);
+
+    /**
+     * @brief 判断点是否为分隔点（或无效点）
+     */
+    static inline bool isBreak(double y) { return !std::isfinite(y); }
+
+    /**
+     * @brief 按分隔点把折线拆成若干连续段
+     * 段数超过 maxSegments 时只在X跨度最大的间断处断开，其余间断直接相连
+     */
+    static QList<QVector<QPointF>> splitSegments(const QVector<QPointF> &points, int maxSegments);
+};
+
+#endif // RANGEFILTER_H
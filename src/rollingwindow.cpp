@@ -0,0 +1,417 @@
+#include "rollingwindow.h"
+#include "parallelutils.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace {
+// 每块至少处理的点数；每块都要先累积一个完整窗口，块长还应远大于窗口
+const qint64 kMinPointsPerChunk = 64 * 1024;
+const qint64 kChunkPerWindow = 16;
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+const double kInf = std::numeric_limits<double>::infinity();
+
+/**
+ * @brief 按块并行，kernel(begin, end, half) 计算 [begin, end) 的输出
+ */
+template <typename Kernel>
+void forWindows(int count, int windowSize, Kernel kernel)
+{
+    if (count <= 0) {
+        return;
+    }
+    const int half = std::min(std::max(windowSize, 1), count) / 2;
+    const qint64 minChunk = std::max(kMinPointsPerChunk, qint64(half) * 2 * kChunkPerWindow);
+    ParallelUtils::forChunks(count, minChunk, 0, [&](qint64 begin, qint64 end, int) {
+        kernel(static_cast<int>(begin), static_cast<int>(end), half);
+    });
+}
+
+/**
+ * @brief 增量更新的块开始前预先累积的第一个点
+ * 即输出点 begin-1 的窗口 [begin-half-1, begin+half)：主循环在 i == begin 时
+ * 先移出 begin-half-1 再移入 begin+half，因此该点必须已在窗口内
+ */
+inline int primeBegin(int begin, int half)
+{
+    return std::max(0, begin - half - 1);
+}
+
+/**
+ * @brief Neumaier 补偿求和，加入和移出同样补偿
+ */
+struct CompensatedSum
+{
+    double sum = 0.0;
+    double compensation = 0.0;
+
+    void add(double x)
+    {
+        const double t = sum + x;
+        if (std::fabs(sum) >= std::fabs(x)) {
+            compensation += (sum - t) + x;
+        } else {
+            compensation += (x - t) + sum;
+        }
+        sum = t;
+    }
+
+    double value() const { return sum + compensation; }
+};
+
+/**
+ * @brief 窗口内的非有限值计数，用于得到与直接求和相同的 NaN/Inf 结果
+ */
+struct NonFiniteCount
+{
+    int nan = 0;
+    int posInf = 0;
+    int negInf = 0;
+
+    // 返回 true 表示 x 为有限值（未计数）
+    bool update(double x, int delta)
+    {
+        if (std::isnan(x)) {
+            nan += delta;
+        } else if (x == kInf) {
+            posInf += delta;
+        } else if (x == -kInf) {
+            negInf += delta;
+        } else {
+            return true;
+        }
+        return false;
+    }
+
+    bool any() const { return nan > 0 || posInf > 0 || negInf > 0; }
+
+    // 非有限值之和：NaN、+Inf、-Inf 或 NaN（+Inf 与 -Inf 同时存在）
+    double sum() const
+    {
+        if (nan > 0 || (posInf > 0 && negInf > 0)) {
+            return kNaN;
+        }
+        return posInf > 0 ? kInf : -kInf;
+    }
+};
+
+/**
+ * @brief 滑动窗口的中位数（双堆，延迟删除）
+ * 元素以 (值, 下标) 排序，因此没有相等的元素；low 为最大堆，保存较小的一半及中位数，
+ * high 为最小堆。移出窗口的元素只在到达堆顶时删除，堆中失效元素过多时整体重建
+ */
+class MedianWindow
+{
+public:
+    explicit MedianWindow(const double *data)
+        : m_data(data), m_lowCount(0), m_highCount(0), m_start(0)
+    {
+    }
+
+    /**
+     * @brief 窗口起点，下标小于它的元素失效
+     */
+    void setStart(int start) { m_start = start; }
+
+    void insert(int index)
+    {
+        const double value = m_data[index];
+        if (std::isnan(value)) {
+            return;
+        }
+        const Item item(value, index);
+        prune(m_low, std::less<Item>());
+        if (m_lowCount == 0 || item < m_low.front()) {
+            push(m_low, item, std::less<Item>());
+            ++m_lowCount;
+        } else {
+            push(m_high, item, std::greater<Item>());
+            ++m_highCount;
+        }
+    }
+
+    /**
+     * @brief 移出元素，须在 setStart 越过该元素之前调用
+     */
+    void erase(int index)
+    {
+        const double value = m_data[index];
+        if (std::isnan(value)) {
+            return;
+        }
+        prune(m_low, std::less<Item>());
+        if (m_lowCount > 0 && !(m_low.front() < Item(value, index))) {
+            --m_lowCount;
+        } else {
+            --m_highCount;
+        }
+    }
+
+    /**
+     * @brief 调整两堆的元素数，使 low 保存排序后下标 0..k/2 的元素
+     * insert/erase 依赖 low 非空时按其堆顶判断归属，每次移出前须已平衡
+     */
+    void rebalance()
+    {
+        const int total = m_lowCount + m_highCount;
+        const int target = total > 0 ? total / 2 + 1 : 0;
+        while (m_lowCount > target) {
+            prune(m_low, std::less<Item>());
+            push(m_high, pop(m_low, std::less<Item>()), std::greater<Item>());
+            --m_lowCount;
+            ++m_highCount;
+        }
+        while (m_lowCount < target) {
+            prune(m_high, std::greater<Item>());
+            push(m_low, pop(m_high, std::greater<Item>()), std::less<Item>());
+            ++m_lowCount;
+            --m_highCount;
+        }
+        compact(m_low, m_lowCount, std::less<Item>());
+        compact(m_high, m_highCount, std::greater<Item>());
+    }
+
+    /**
+     * @brief 当前窗口的中位数（堆顶即 sorted[k/2]），窗口为空时为 NaN
+     */
+    double median()
+    {
+        rebalance();
+        if (m_lowCount == 0) {
+            return kNaN;
+        }
+        prune(m_low, std::less<Item>());
+        return m_low.front().first;
+    }
+
+private:
+    typedef std::pair<double, int> Item;
+
+    template <typename Compare>
+    static void push(std::vector<Item> &heap, const Item &item, Compare compare)
+    {
+        heap.push_back(item);
+        std::push_heap(heap.begin(), heap.end(), compare);
+    }
+
+    template <typename Compare>
+    static Item pop(std::vector<Item> &heap, Compare compare)
+    {
+        std::pop_heap(heap.begin(), heap.end(), compare);
+        const Item item = heap.back();
+        heap.pop_back();
+        return item;
+    }
+
+    template <typename Compare>
+    void prune(std::vector<Item> &heap, Compare compare)
+    {
+        while (!heap.empty() && heap.front().second < m_start) {
+            pop(heap, compare);
+        }
+    }
+
+    /**
+     * @brief 失效元素超过有效元素时重建堆，保证堆的大小为 O(w)
+     */
+    template <typename Compare>
+    void compact(std::vector<Item> &heap, int validCount, Compare compare)
+    {
+        if (heap.size() <= static_cast<size_t>(validCount) * 2 + 64) {
+            return;
+        }
+        const int start = m_start;
+        heap.erase(std::remove_if(heap.begin(), heap.end(),
+                                  [start](const Item &item) { return item.second < start; }),
+                   heap.end());
+        std::make_heap(heap.begin(), heap.end(), compare);
+    }
+
+    const double *m_data;
+    std::vector<Item> m_low;
+    std::vector<Item> m_high;
+    int m_lowCount;             // low 中的有效元素数
+    int m_highCount;
+    int m_start;
+};
+
+/**
+ * @brief 单调队列求滑动极值，better(a, b) 为 true 表示 a 比 b 更优（更小或更大）
+ */
+template <typename Better>
+void extremum(const double *data, int count, int windowSize, double *out, Better better)
+{
+    forWindows(count, windowSize, [&](int begin, int end, int half) {
+        // 队列中的下标递增，对应的值严格单调，队首即窗口极值
+        std::deque<int> queue;
+        auto push = [&](int j) {
+            const double value = data[j];
+            if (std::isnan(value)) {
+                return;
+            }
+            while (!queue.empty() && !better(data[queue.back()], value)) {
+                queue.pop_back();
+            }
+            queue.push_back(j);
+        };
+
+        for (int j = std::max(0, begin - half); j < std::min(count, begin + half); ++j) {
+            push(j);
+        }
+        for (int i = begin; i < end; ++i) {
+            if (i + half < count) {
+                push(i + half);
+            }
+            while (!queue.empty() && queue.front() < i - half) {
+                queue.pop_front();
+            }
+            out[i] = queue.empty() ? kNaN : data[queue.front()];
+        }
+    });
+}
+}
+
+namespace RollingWindow {
+
+void mean(const double *data, int count, int windowSize, double *out)
+{
+    forWindows(count, windowSize, [&](int begin, int end, int half) {
+        CompensatedSum sum;
+        NonFiniteCount nonFinite;
+        auto update = [&](int j, int sign) {
+            const double value = data[j];
+            if (nonFinite.update(value, sign)) {
+                sum.add(sign > 0 ? value : -value);
+            }
+        };
+
+        for (int j = primeBegin(begin, half); j < std::min(count, begin + half); ++j) {
+            update(j, 1);
+        }
+        for (int i = begin; i < end; ++i) {
+            if (i - half - 1 >= 0) {
+                update(i - half - 1, -1);
+            }
+            if (i + half < count) {
+                update(i + half, 1);
+            }
+            const int size = std::min(count, i + half + 1) - std::max(0, i - half);
+            out[i] = nonFinite.any() ? nonFinite.sum() : sum.value() / size;
+        }
+    });
+}
+
+void stddev(const double *data, int count, int windowSize, double *out)
+{
+    forWindows(count, windowSize, [&](int begin, int end, int half) {
+        // Welford：有限值的个数、均值和离差平方和，支持移出
+        int n = 0;
+        double mean = 0.0;
+        double m2 = 0.0;
+        NonFiniteCount nonFinite;
+        auto add = [&](int j) {
+            const double x = data[j];
+            if (!nonFinite.update(x, 1)) {
+                return;
+            }
+            ++n;
+            const double delta = x - mean;
+            mean += delta / n;
+            m2 += delta * (x - mean);
+        };
+        auto remove = [&](int j) {
+            const double x = data[j];
+            if (!nonFinite.update(x, -1)) {
+                return;
+            }
+            --n;
+            if (n == 0) {
+                mean = 0.0;
+                m2 = 0.0;
+                return;
+            }
+            const double delta = x - mean;
+            mean -= delta / n;
+            m2 -= delta * (x - mean);
+        };
+
+        // 增量更新的舍入误差会逐步累积，定期按当前窗口重新计算（均摊仍为 O(1)）
+        auto resync = [&](int from, int to) {
+            n = 0;
+            mean = 0.0;
+            for (int j = from; j < to; ++j) {
+                if (std::isfinite(data[j])) {
+                    ++n;
+                    mean += data[j];
+                }
+            }
+            mean = n > 0 ? mean / n : 0.0;
+            m2 = 0.0;
+            for (int j = from; j < to; ++j) {
+                if (std::isfinite(data[j])) {
+                    m2 += (data[j] - mean) * (data[j] - mean);
+                }
+            }
+        };
+        const int resyncInterval = std::max(2 * half + 1, 4096);
+        
+        for (int j = primeBegin(begin, half); j < std::min(count, begin + half); ++j) {
+            add(j);
+        }
+        for (int i = begin; i < end; ++i) {
+            if (i - half - 1 >= 0) {
+                remove(i - half - 1);
+            }
+            if (i + half < count) {
+                add(i + half);
+            }
+            if ((i - begin + 1) % resyncInterval == 0) {
+                resync(std::max(0, i - half), std::min(count, i + half + 1));
+            }
+            if (nonFinite.any()) {
+                out[i] = kNaN;
+            } else {
+                out[i] = n < 2 ? 0.0 : std::sqrt(std::max(0.0, m2) / (n - 1));
+            }
+        }
+    });
+}
+
+void median(const double *data, int count, int windowSize, double *out)
+{
+    forWindows(count, windowSize, [&](int begin, int end, int half) {
+        MedianWindow window(data);
+        window.setStart(primeBegin(begin, half));
+        for (int j = primeBegin(begin, half); j < std::min(count, begin + half); ++j) {
+            window.insert(j);
+        }
+        window.rebalance();
+        for (int i = begin; i < end; ++i) {
+            if (i - half - 1 >= 0) {
+                window.erase(i - half - 1);
+                window.setStart(i - half);
+            }
+            if (i + half < count) {
+                window.insert(i + half);
+            }
+            out[i] = window.median();
+        }
+    });
+}
+
+void minimum(const double *data, int count, int windowSize, double *out)
+{
+    extremum(data, count, windowSize, out, [](double a, double b) { return a < b; });
+}
+
+void maximum(const double *data, int count, int windowSize, double *out)
+{
+    extremum(data, count, windowSize, out, [](double a, double b) { return a > b; });
+}
+
+} // namespace RollingWindow
@@ -0,0 +1,37 @@
+#ifndef ROLLINGWINDOW_H
+#define ROLLINGWINDOW_H
+
+/**
+ * @brief 滑动窗口统计
+ * 输出点 i 对应以 i 为中心的窗口 [i - w/2, i + w/2]，在数据两端截断。
+ * 每个窗口由上一个窗口增量更新（移出一个点、移入一个点），不再逐个窗口重新计算；
+ * 数据按块在多个线程上并行处理，每块先累积其前一个输出点的窗口，再逐点增量更新。
+ *   - mean / stddev：窗口内有 NaN 或 Inf 时结果与直接求和相同（NaN 或 ±Inf）
+ *   - median / minimum / maximum：忽略 NaN，窗口内全为 NaN 时结果为 NaN
+ */
+namespace RollingWindow {
+
+/**
+ * @brief 滑动平均，O(n)，使用补偿求和避免长序列上的累积误差
+ */
+void mean(const double *data, int count, int windowSize, double *out);
+
+/**
+ * @brief 滑动样本标准差（n-1），O(n)，Welford 增量更新；窗口内少于2个点时为0
+ */
+void stddev(const double *data, int count, int windowSize, double *out);
+
+/**
+ * @brief 滑动中位数，O(n log w)，双堆维护窗口的顺序统计量；偶数个点时取较大的中间值
+ */
+void median(const double *data, int count, int windowSize, double *out);
+
+/**
+ * @brief 滑动最小值 / 最大值，O(n)，单调队列
+ */
+void minimum(const double *data, int count, int windowSize, double *out);
+void maximum(const double *data, int count, int windowSize, double *out);
+
+} // namespace RollingWindow
+
+#endif // ROLLINGWINDOW_H
@@ -1,4 +1,5 @@
 #include "scripteditor.h"
+#include "appsettings.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
@@ -10,8 +11,17 @@ ScriptEditorDialog::ScriptEditorDialog(ScriptEngine *engine, CsvParser *parser,
     : QDialog(parent)
     , m_scriptEngine(engine)
     , m_csvParser(parser)
+    , m_jobId(0)
+    , m_progressFraction(-1.0)
 {
     setupUi();
+    
+    connect(m_scriptEngine, &ScriptEngine::scriptProgress, this, &ScriptEditorDialog::onScriptProgress);
+    connect(m_scriptEngine, &ScriptEngine::scriptFinished, this, &ScriptEditorDialog::onScriptFinished);
+    
+    m_statusTimer = new QTimer(this);
+    m_statusTimer->setInterval(200);
+    connect(m_statusTimer, &QTimer::timeout, this, &ScriptEditorDialog::updateRunStatus);
     updateAvailableColumns();
     refreshDerivedColumnList();
     
@@ -28,6 +38,15 @@ QList<DerivedColumn> ScriptEditorDialog::getDerivedColumns() const
     return m_scriptEngine->getDerivedColumns();
 }
 
+void ScriptEditorDialog::done(int result)
+{
+    // 只取消本对话框提交的脚本，不影响其他任务
+    if (m_jobId != 0) {
+        m_scriptEngine->cancelJob(m_jobId);
+    }
+    QDialog::done(result);
+}
+
 void ScriptEditorDialog::setupUi()
 {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -65,15 +84,20 @@ void ScriptEditorDialog::setupUi()
     m_functionComboBox->addItem("math.normalize(a)", "math.normalize(data.)");
     m_functionComboBox->addItem("math.standardize(a)", "math.standardize(data.)");
     m_functionComboBox->addItem("math.moving_average(a, n)", "math.moving_average(data., 5)");
+    m_functionComboBox->addItem("math.median_filter(a, n)", "math.median_filter(data., 5)");
+    m_functionComboBox->addItem("math.rolling_std(a, n)", "math.rolling_std(data., 5)");
     m_functionComboBox->addItem("math.lowpass_filter(a, c)", "math.lowpass_filter(data., 0.1)");
     m_functionComboBox->addItem("math.derivative(a, dt)", "math.derivative(data., 1.0)");
     m_functionComboBox->addItem("math.integral(a, dt)", "math.integral(data., 1.0)");
     m_functionComboBox->addItem("math.fft_magnitude(a)", "math.fft_magnitude(data.)");
     m_functionComboBox->addItem("math.power_spectrum(a)", "math.power_spectrum(data.)");
+    m_functionComboBox->addItem("math.welch(a, seg, fs)", "math.welch(data., 1024, 1.0)");
     m_functionComboBox->addItem("math.abs_array(a)", "math.abs_array(data.)");
     m_functionComboBox->addItem("math.sqrt_array(a)", "math.sqrt_array(data.)");
     m_functionComboBox->addItem("math.log_array(a)", "math.log_array(data.)");
     m_functionComboBox->addItem("math.correlation_coefficient(a, b)", "math.correlation_coefficient(data., data.)");
+    m_functionComboBox->addItem("math.cross_correlation(a, b)", "math.cross_correlation(data., data.)");
+    m_functionComboBox->addItem("math.convolve(a, b)", "math.convolve(data., data.)");
     
     QPushButton *insertFuncBtn = new QPushButton("插入");
     connect(insertFuncBtn, &QPushButton::clicked, this, &ScriptEditorDialog::onInsertFunction);
@@ -111,6 +135,23 @@ void ScriptEditorDialog::setupUi()
     m_outputNameEdit = new QLineEdit();
     m_outputNameEdit->setPlaceholderText("请输入新列的名称");
     outputNameLayout->addWidget(m_outputNameEdit);
+    
+    outputNameLayout->addWidget(new QLabel("超时:"));
+    m_timeoutSpinBox = new QSpinBox();
+    m_timeoutSpinBox->setRange(0, 24 * 3600);
+    m_timeoutSpinBox->setSuffix(" 秒");
+    m_timeoutSpinBox->setSpecialValueText("不限");
+    m_timeoutSpinBox->setValue(AppSettings::instance().scriptTimeout());
+    m_timeoutSpinBox->setToolTip("脚本执行超过该时间后自动中止，0 表示不限时");
+    connect(m_timeoutSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [](int seconds) {
+        AppSettings::instance().setScriptTimeout(seconds);
+    });
+    outputNameLayout->addWidget(m_timeoutSpinBox);
+    
+    m_legacyArraysCheckBox = new QCheckBox("旧版数组");
+    m_legacyArraysCheckBox->setToolTip("math 函数的数组结果和 data 列按普通数组提供（较慢），\n"
+                                       "用于依赖 push、concat、字符串排序等普通数组行为的旧脚本");
+    outputNameLayout->addWidget(m_legacyArraysCheckBox);
     scriptLayout->addLayout(outputNameLayout);
     
     leftLayout->addWidget(scriptGroup);
@@ -169,6 +210,13 @@ void ScriptEditorDialog::setupUi()
     m_runButton->setStyleSheet("font-weight: bold; background-color: #4CAF50; color: white;");
     connect(m_runButton, &QPushButton::clicked, this, &ScriptEditorDialog::onRunScript);
     
+    m_cancelButton = new QPushButton("取消执行");
+    m_cancelButton->setMinimumHeight(35);
+    m_cancelButton->setEnabled(false);
+    connect(m_cancelButton, &QPushButton::clicked, this, &ScriptEditorDialog::onCancelScript);
+    
+    m_statusLabel = new QLabel();
+    
     m_helpButton = new QPushButton("帮助文档");
     m_helpButton->setMinimumHeight(35);
     connect(m_helpButton, &QPushButton::clicked, this, &ScriptEditorDialog::onShowHelp);
@@ -178,7 +226,9 @@ void ScriptEditorDialog::setupUi()
     connect(m_closeButton, &QPushButton::clicked, this, &QDialog::accept);
     
     buttonLayout->addWidget(m_runButton);
+    buttonLayout->addWidget(m_cancelButton);
     buttonLayout->addWidget(m_helpButton);
+    buttonLayout->addWidget(m_statusLabel);
     buttonLayout->addStretch();
     buttonLayout->addWidget(m_closeButton);
     
@@ -242,49 +292,101 @@ void ScriptEditorDialog::onRunScript()
         return;
     }
     
-    // 准备源数据
-    if (m_csvParser) {
-        QMap<QString, QVector<double>> sourceData;
-        QStringList columns = m_csvParser->getColumnNames();
-        for (int i = 0; i < columns.size(); ++i) {
-            if (m_csvParser->isNumericColumn(i)) {
-                sourceData[columns[i]] = m_csvParser->getColumnData(i);
-            }
-        }
-        
-        // 添加已有的派生列
-        for (const auto &derived : m_scriptEngine->getDerivedColumns()) {
-            sourceData[derived.name] = derived.data;
-        }
-        
-        m_scriptEngine->setSourceData(sourceData);
+    // 在后台线程执行，结果由 onScriptFinished 处理
+    m_jobId = m_scriptEngine->executeScriptAsync(script, outputName, m_timeoutSpinBox->value() * 1000,
+                                                 m_legacyArraysCheckBox->isChecked());
+    if (m_jobId == 0) {
+        appendOutput(QString("错误: %1").arg(m_scriptEngine->getLastError()), true);
+        return;
     }
-    
-    // 执行脚本
     appendOutput(QString("正在执行脚本，输出列: %1").arg(outputName), false);
+    setRunning(true);
+}
+
+void ScriptEditorDialog::onCancelScript()
+{
+    if (m_jobId != 0) {
+        m_scriptEngine->cancelJob(m_jobId);
+        m_cancelButton->setEnabled(false);
+        m_statusLabel->setText("正在取消...");
+    }
+}
+
+void ScriptEditorDialog::onScriptProgress(int jobId, const QString &, double fraction, const QString &message)
+{
+    if (jobId != m_jobId) {
+        return;
+    }
+    m_progressFraction = fraction;
+    m_progressMessage = message;
+    updateRunStatus();
+}
+
+void ScriptEditorDialog::onScriptFinished(int jobId, const QString &name, bool success, const QString &error)
+{
+    if (jobId != m_jobId) {
+        return;
+    }
+    m_jobId = 0;
+    const double seconds = m_runClock.elapsed() / 1000.0;
+    setRunning(false);
     
-    if (m_scriptEngine->executeScript(script, outputName)) {
-        QVector<double> result = m_scriptEngine->getDerivedColumnData(outputName);
-        appendOutput(QString("成功！生成了 %1 个数据点").arg(result.size()), false);
-        
-        // 显示前几个值
-        QString preview = "预览: [";
-        int previewCount = qMin(5, result.size());
-        for (int i = 0; i < previewCount; ++i) {
-            preview += QString::number(result[i], 'g', 4);
-            if (i < previewCount - 1) preview += ", ";
-        }
-        if (result.size() > 5) preview += ", ...";
-        preview += "]";
-        appendOutput(preview, false);
-        
-        refreshDerivedColumnList();
-        updateAvailableColumns();
-        
-        emit derivedColumnsChanged();
+    if (!success) {
+        appendOutput(QString("错误: %1").arg(error), true);
+        return;
+    }
+    
+    QVector<double> result = m_scriptEngine->getDerivedColumnData(name);
+    appendOutput(QString("成功！生成了 %1 个数据点，耗时 %2 秒")
+        .arg(result.size()).arg(seconds, 0, 'f', 2), false);
+    
+    // 显示前几个值
+    QString preview = "预览: [";
+    int previewCount = qMin(5, result.size());
+    for (int i = 0; i < previewCount; ++i) {
+        preview += QString::number(result[i], 'g', 4);
+        if (i < previewCount - 1) preview += ", ";
+    }
+    if (result.size() > 5) preview += ", ...";
+    preview += "]";
+    appendOutput(preview, false);
+    
+    refreshDerivedColumnList();
+    updateAvailableColumns();
+    
+    emit derivedColumnsChanged();
+}
+
+void ScriptEditorDialog::setRunning(bool running)
+{
+    m_runButton->setEnabled(!running);
+    m_cancelButton->setEnabled(running);
+    m_progressFraction = -1.0;
+    m_progressMessage.clear();
+    if (running) {
+        m_runClock.start();
+        m_statusTimer->start();
+        updateRunStatus();
     } else {
-        appendOutput(QString("错误: %1").arg(m_scriptEngine->getLastError()), true);
+        m_statusTimer->stop();
+        m_statusLabel->clear();
+    }
+}
+
+void ScriptEditorDialog::updateRunStatus()
+{
+    // 取消请求发出后保持“正在取消”提示
+    if (m_jobId == 0 || !m_cancelButton->isEnabled()) {
+        return;
+    }
+    QString status = QString("执行中 %1 秒").arg(m_runClock.elapsed() / 1000.0, 0, 'f', 1);
+    if (m_progressFraction >= 0.0) {
+        status += QString("  %1%").arg(qBound(0.0, m_progressFraction, 1.0) * 100.0, 0, 'f', 0);
+    }
+    if (!m_progressMessage.isEmpty()) {
+        status += "  " + m_progressMessage;
     }
+    m_statusLabel->setText(status);
 }
 
 void ScriptEditorDialog::onClearOutput()
@@ -342,6 +444,7 @@ void ScriptEditorDialog::onDerivedColumnSelected(QListWidgetItem *item)
             if (derived.name == name) {
                 m_scriptEdit->setPlainText(derived.sourceScript);
                 m_outputNameEdit->setText(derived.name);
+                m_legacyArraysCheckBox->setChecked(derived.legacyArrays);
                 break;
             }
         }
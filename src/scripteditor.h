@@ -10,6 +10,10 @@
 #include <QSplitter>
 #include <QTextBrowser>
 #include <QComboBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "scriptengine.h"
 #include "csvparser.h"
 
@@ -29,6 +33,11 @@ public:
      * @brief 获取派生列列表
      */
     QList<DerivedColumn> getDerivedColumns() const;
+    
+    /**
+     * @brief 关闭对话框时取消仍在执行的脚本
+     */
+    void done(int result) override;
 
 signals:
     /**
@@ -38,6 +47,10 @@ signals:
 
 private slots:
     void onRunScript();
+    void onCancelScript();
+    void onScriptProgress(int jobId, const QString &name, double fraction, const QString &message);
+    void onScriptFinished(int jobId, const QString &name, bool success, const QString &error);
+    void updateRunStatus();
     void onClearOutput();
     void onShowHelp();
     void onInsertColumn();
@@ -50,6 +63,7 @@ private:
     void refreshDerivedColumnList();
     void updateAvailableColumns();
     void appendOutput(const QString &text, bool isError = false);
+    void setRunning(bool running);
 
 private:
     ScriptEngine *m_scriptEngine;
@@ -71,9 +85,20 @@ private:
     
     // 按钮
     QPushButton *m_runButton;
+    QPushButton *m_cancelButton;
     QPushButton *m_helpButton;
     QPushButton *m_deleteButton;
     QPushButton *m_closeButton;
+    
+    // 执行状态
+    QSpinBox *m_timeoutSpinBox;
+    QCheckBox *m_legacyArraysCheckBox;  // 按旧版数组接口执行
+    QLabel *m_statusLabel;
+    QTimer *m_statusTimer;          // 执行期间定时刷新已用时间
+    int m_jobId;                    // 本对话框提交、尚未结束的脚本任务，0 表示没有
+    QElapsedTimer m_runClock;
+    double m_progressFraction;      // 脚本上报的进度，小于0表示未知
+    QString m_progressMessage;
 };
 
 #endif // SCRIPTEDITOR_H
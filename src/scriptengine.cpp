@@ -1,93 +1,790 @@
 #include "scriptengine.h"
+#include "scriptrunner.h"
+#include "derivedcache.h"
+#include "expressionplan.h"
 #include <QDebug>
-#include <QtMath>
+#include <QRegularExpression>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <QMutex>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QSemaphore>
+#include <atomic>
+
+/**
+ * @brief 一次脚本执行
+ */
+struct ScriptTask
+{
+    QString name;
+    QString script;
+    bool legacyArrays = false;                  // 按旧版数组接口执行
+    QMap<QString, QVector<double>> columns;     // 脚本可读取的列（隐式共享）
+    QStringList order;
+    QVector<double> result;
+    QString error;
+    bool ok = false;
+};
+
+/**
+ * @brief 一个脚本任务（单个脚本、批量脚本或重新计算），GUI线程与工作线程共享
+ * 主任务替换了已有列时，读取这些列的派生列在同一任务中随之重新计算
+ */
+struct ScriptJob
+{
+    enum Kind { Single, Batch, Recompute };
+    
+    Kind kind = Single;
+    int id = 0;
+    int timeoutMs = 0;
+    QVector<ScriptTask> tasks;                  // 主任务，按顺序生效；提交时已带错误信息的不执行
+    QStringList changedColumns;                 // Recompute：数据已改变的列
+    ScriptProgressHandler report;               // 把进度转发到GUI线程
+    
+    // 开始执行时在GUI线程采集
+    QMap<QString, QVector<double>> columns;     // 列快照（隐式共享）
+    QStringList order;
+    QList<DerivedColumn> derived;               // 派生列的脚本和输入
+    
+    // 工作线程写入，完成通知到达GUI线程后读取
+    QVector<ScriptTask> dependents;             // 随之重新计算的派生列，按执行顺序
+    
+    QMutex mutex;                               // 保护以下成员
+    QList<ScriptRunner*> runners;               // 正在执行该任务的执行器
+    bool cancelled = false;
+    bool timedOut = false;
+    
+    void cancel(bool timeout)
+    {
+        QMutexLocker locker(&mutex);
+        if (cancelled) {
+            return;
+        }
+        cancelled = true;
+        timedOut = timeout;
+        for (ScriptRunner *runner : runners) {
+            runner->setInterrupted(true);
+        }
+    }
+    
+    bool isCancelled()
+    {
+        QMutexLocker locker(&mutex);
+        return cancelled;
+    }
+    
+    /**
+     * @brief 执行器开始为该任务执行脚本
+     */
+    void attach(ScriptRunner *runner)
+    {
+        {
+            // 开始前已取消的任务直接以中断状态执行
+            QMutexLocker locker(&mutex);
+            runner->setInterrupted(cancelled);
+            runners.append(runner);
+        }
+        
+        // 进度限制为每50毫秒最多通知一次，避免事件堆积在GUI线程
+        QElapsedTimer clock;
+        clock.start();
+        qint64 lastReport = -1;
+        const ScriptProgressHandler forward = report;
+        runner->setProgressHandler([clock, lastReport, forward](double fraction, const QString &message) mutable {
+            const qint64 now = clock.elapsed();
+            if (lastReport >= 0 && now - lastReport < 50 && fraction < 1.0) {
+                return;
+            }
+            lastReport = now;
+            forward(fraction, message);
+        });
+    }
+    
+    /**
+     * @brief 执行器留在线程中复用，不再持有本任务的数据和回调
+     */
+    void detach(ScriptRunner *runner)
+    {
+        runner->setProgressHandler(ScriptProgressHandler());
+        runner->bind(QMap<QString, QVector<double>>(), QStringList());
+        QMutexLocker locker(&mutex);
+        runners.removeOne(runner);
+        runner->setInterrupted(false);
+    }
+};
+
+namespace {
+// 计算耗时低于该值的结果不写入磁盘缓存（读取缓存不比重新计算快）
+const qint64 kMinCachedMs = 50;
+
+/**
+ * @brief 执行脚本，结果先查派生列缓存，未命中时计算并保存
+ * 能编译为 ExpressionPlan 的公式不查缓存
+ */
+bool runCached(ScriptRunner *runner, const QString &script, bool legacyArrays,
+               const QMap<QString, QVector<double>> &columns, const QStringList &order,
+               QVector<double> &result, QString &error)
+{
+    // 逐元素公式直接求值比计算输入列的内容哈希还快，不经过缓存
+    ExpressionPlan plan;
+    if (plan.compile(script)) {
+        runner->bind(columns, order);
+        return runner->run(script, result, error, legacyArrays);
+    }
+    
+    DerivedCache &cache = DerivedCache::instance();
+    bool dynamic = false;
+    const QStringList inputs = ScriptEngine::referencedColumns(script, &dynamic);
+    const QByteArray key = cache.makeKey(script, legacyArrays, dynamic ? order : inputs, columns);
+    if (cache.load(key, result)) {
+        return true;
+    }
+    
+    QElapsedTimer clock;
+    clock.start();
+    runner->bind(columns, order);
+    if (!runner->run(script, result, error, legacyArrays)) {
+        return false;
+    }
+    if (clock.elapsed() >= kMinCachedMs) {
+        cache.store(key, result);
+    }
+    return true;
+}
+
+int indexOfColumn(const QList<DerivedColumn> &columns, const QString &name)
+{
+    for (int i = 0; i < columns.size(); ++i) {
+        if (columns[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 受影响的派生列按依赖关系分层，每层只依赖之前的层
+ */
+QList<QStringList> dependentLevels(const QList<DerivedColumn> &derived, const QStringList &changedColumns)
+{
+    const QSet<QString> changed(changedColumns.begin(), changedColumns.end());
+    const int count = derived.size();
+    
+    // 受影响的派生列：直接或间接读取了改变的列（改变的列本身不重算）
+    QVector<bool> dirty(count, false);
+    QSet<QString> dirtyNames;
+    bool grew = !changed.isEmpty();
+    while (grew) {
+        grew = false;
+        for (int i = 0; i < count; ++i) {
+            const DerivedColumn &col = derived[i];
+            if (dirty[i] || changed.contains(col.name)) {
+                continue;
+            }
+            bool affected = col.dynamicInputs;
+            for (int k = 0; !affected && k < col.inputs.size(); ++k) {
+                affected = changed.contains(col.inputs[k]) || dirtyNames.contains(col.inputs[k]);
+            }
+            if (affected) {
+                dirty[i] = true;
+                dirtyNames.insert(col.name);
+                grew = true;
+            }
+        }
+    }
+    
+    // 依赖关系：显式读取的受影响列；动态访问的脚本依赖在它之前创建的所有受影响列
+    QVector<QVector<int>> deps(count);
+    for (int i = 0; i < count; ++i) {
+        if (!dirty[i]) {
+            continue;
+        }
+        for (int k = 0; k < count; ++k) {
+            if (k == i || !dirty[k]) {
+                continue;
+            }
+            const bool reads = derived[i].dynamicInputs
+                ? k < i
+                : derived[i].inputs.contains(derived[k].name);
+            if (reads) {
+                deps[i].append(k);
+            }
+        }
+    }
+    
+    // 按层拓扑排序：每层只包含依赖都已在之前各层中的列
+    QList<QStringList> levels;
+    QVector<bool> done(count, false);
+    int remaining = dirtyNames.size();
+    while (remaining > 0) {
+        QVector<int> level;
+        for (int i = 0; i < count; ++i) {
+            if (!dirty[i] || done[i]) {
+                continue;
+            }
+            bool ready = true;
+            for (int k : deps[i]) {
+                ready = ready && done[k];
+            }
+            if (ready) {
+                level.append(i);
+            }
+        }
+        if (level.isEmpty()) {
+            // 存在循环依赖：剩余的列按创建顺序逐个执行
+            for (int i = 0; i < count; ++i) {
+                if (dirty[i] && !done[i]) {
+                    level.append(i);
+                    break;
+                }
+            }
+        }
+        QStringList names;
+        for (int i : level) {
+            done[i] = true;
+            names.append(derived[i].name);
+        }
+        remaining -= level.size();
+        levels.append(names);
+    }
+    return levels;
+}
+
+/**
+ * @brief 执行一组互不依赖的脚本，多于一个时在线程池中并行，返回时全部完成
+ */
+void runTasks(const QSharedPointer<ScriptJob> &job, QVector<ScriptTask> &tasks,
+              QThreadPool *pool, ScriptRunner *runner)
+{
+    // 同一层的脚本互不依赖：线程池中的线程各自使用本线程的执行器（JS引擎随线程复用），
+    // 执行任务的线程自己也领取脚本，线程池占满时不必等待空闲线程
+    struct Batch {
+        QVector<ScriptTask> tasks;
+        int count = 0;
+        std::atomic<int> next{0};
+        QSemaphore finished;
+    };
+    QSharedPointer<Batch> batch(new Batch());
+    batch->tasks.swap(tasks);
+    batch->count = batch->tasks.size();
+    
+    auto work = [](Batch &b, ScriptRunner *r) {
+        for (int i = b.next++; i < b.count; i = b.next++) {
+            ScriptTask &task = b.tasks[i];
+            task.ok = runCached(r, task.script, task.legacyArrays, task.columns, task.order,
+                                task.result, task.error);
+            b.finished.release();
+        }
+    };
+    
+    // 执行任务的线程本身占用线程池的一个线程
+    const int helpers = qMin(batch->count, pool->maxThreadCount()) - 1;
+    for (int k = 0; k < helpers; ++k) {
+        pool->start([batch, job, work]() {
+            ScriptRunner *helper = ScriptRunner::forCurrentThread();
+            job->attach(helper);
+            work(*batch, helper);
+            job->detach(helper);
+        });
+    }
+    work(*batch, runner);
+    
+    // 晚启动的线程领不到任务，只读取 count 和 next
+    batch->finished.acquire(batch->count);
+    batch->tasks.swap(tasks);
+    for (ScriptTask &task : tasks) {
+        task.columns.clear();
+        task.order.clear();
+    }
+}
+
+/**
+ * @brief 在工作线程中执行任务：主任务，然后是读取了被替换列的派生列
+ */
+void runJob(const QSharedPointer<ScriptJob> &job, QThreadPool *pool)
+{
+    ScriptRunner *runner = ScriptRunner::forCurrentThread();
+    job->attach(runner);
+    
+    QVector<ScriptTask> &tasks = job->tasks;
+    const int count = tasks.size();
+    QVector<bool> valid(count, true);
+    
+    // 依赖：静态读取的列取列表中在它之前最后一个生成该列的脚本；动态访问 data 的脚本依赖之前所有脚本
+    QVector<QVector<int>> deps(count);
+    for (int i = 0; i < count; ++i) {
+        if (!tasks[i].error.isEmpty()) {
+            valid[i] = false;
+            continue;
+        }
+        bool dynamic = false;
+        const QStringList inputs = ScriptEngine::referencedColumns(tasks[i].script, &dynamic);
+        QSet<QString> resolved;
+        for (int j = i - 1; j >= 0; --j) {
+            if (!valid[j]) {
+                continue;
+            }
+            const QString &produced = tasks[j].name;
+            if (dynamic) {
+                deps[i].append(j);
+            } else if (inputs.contains(produced) && !resolved.contains(produced)) {
+                resolved.insert(produced);
+                deps[i].append(j);
+            }
+        }
+    }
+    
+    // 按层执行：每层的脚本所依赖的脚本都已完成
+    QVector<bool> done(count, false);
+    for (int i = 0; i < count; ++i) {
+        done[i] = !valid[i];
+    }
+    int remaining = std::count(valid.begin(), valid.end(), true);
+    while (remaining > 0 && !job->isCancelled()) {
+        QVector<int> level;
+        for (int i = 0; i < count; ++i) {
+            bool ready = !done[i];
+            for (int k = 0; ready && k < deps[i].size(); ++k) {
+                ready = done[deps[i][k]];
+            }
+            if (ready) {
+                level.append(i);
+            }
+        }
+        
+        // 每个脚本只看到原有的列和列表中在它之前、已成功生成的列，与逐个执行时一致
+        QVector<ScriptTask> levelTasks;
+        for (int i : level) {
+            ScriptTask task = tasks[i];
+            task.columns = job->columns;
+            task.order = job->order;
+            for (int j = 0; j < i; ++j) {
+                if (done[j] && tasks[j].ok) {
+                    if (!task.columns.contains(tasks[j].name)) {
+                        task.order.append(tasks[j].name);
+                    }
+                    task.columns.insert(tasks[j].name, tasks[j].result);
+                }
+            }
+            levelTasks.append(task);
+        }
+        runTasks(job, levelTasks, pool, runner);
+        
+        for (int k = 0; k < level.size(); ++k) {
+            tasks[level[k]] = levelTasks[k];
+            done[level[k]] = true;
+        }
+        remaining -= level.size();
+    }
+    
+    // 主任务按顺序生效后的派生列和全部列，同名列以最后一次为准；替换了已有列时，
+    // 与逐个执行一样更新读取它的派生列
+    QList<DerivedColumn> derived = job->derived;
+    QMap<QString, QVector<double>> columns = job->columns;
+    QStringList order = job->order;
+    QStringList replaced = job->changedColumns;
+    QSet<QString> stored;
+    for (const ScriptTask &task : tasks) {
+        if (!task.ok) {
+            continue;
+        }
+        const int index = indexOfColumn(derived, task.name);
+        if ((index >= 0 || stored.contains(task.name)) && !replaced.contains(task.name)) {
+            replaced.append(task.name);
+        }
+        DerivedColumn column;
+        column.name = task.name;
+        column.sourceScript = task.script;
+        column.legacyArrays = task.legacyArrays;
+        column.inputs = ScriptEngine::referencedColumns(task.script, &column.dynamicInputs);
+        if (index >= 0) {
+            derived[index] = column;
+        } else {
+            derived.append(column);
+        }
+        stored.insert(task.name);
+        if (!columns.contains(task.name)) {
+            order.append(task.name);
+        }
+        columns.insert(task.name, task.result);
+    }
+    
+    for (const QStringList &level : dependentLevels(derived, replaced)) {
+        if (job->isCancelled()) {
+            break;
+        }
+        QVector<ScriptTask> levelTasks;
+        for (const QString &name : level) {
+            ScriptTask task;
+            task.name = name;
+            const DerivedColumn &column = derived[indexOfColumn(derived, name)];
+            task.script = column.sourceScript;
+            task.legacyArrays = column.legacyArrays;
+            task.columns = columns;
+            task.order = order;
+            levelTasks.append(task);
+        }
+        runTasks(job, levelTasks, pool, runner);
+        
+        // 失败的列不再提供给之后的层，与写回后清空数据一致
+        for (const ScriptTask &task : levelTasks) {
+            if (task.ok) {
+                if (!columns.contains(task.name)) {
+                    order.append(task.name);
+                }
+                columns.insert(task.name, task.result);
+            } else {
+                columns.remove(task.name);
+                order.removeAll(task.name);
+            }
+        }
+        job->dependents += levelTasks;
+    }
+    
+    job->detach(runner);
+}
+}
 
 // ==================== ScriptEngine ====================
 
 ScriptEngine::ScriptEngine(QObject *parent)
     : QObject(parent)
-{
-    m_jsEngine = new QJSEngine(this);
-    registerBuiltinFunctions();
+    , m_pool(new QThreadPool(this))
+    , m_timeoutTimer(new QTimer(this))
+    , m_columnStore(nullptr)
+    , m_nextJobId(0)
+{
+    // 线程空闲较久才退出，各线程的JS引擎在多次执行间复用
+    m_pool->setExpiryTimeout(5 * 60 * 1000);
+    
+    m_timeoutTimer->setSingleShot(true);
+    connect(m_timeoutTimer, &QTimer::timeout, this, [this]() {
+        if (m_activeJob) {
+            m_activeJob->cancel(true);
+        }
+    });
 }
 
 ScriptEngine::~ScriptEngine()
 {
+    // 析构时不再发出完成信号
+    m_pendingJobs.clear();
+    if (m_activeJob) {
+        m_activeJob->cancel(false);
+    }
+    m_pool->waitForDone();
 }
 
-void ScriptEngine::setSourceData(const QMap<QString, QVector<double>> &columns)
+QMap<QString, QVector<double>> ScriptEngine::columnSnapshot(QStringList &order) const
 {
-    m_sourceData = columns;
-    
-    // 将数据列注册到JS引擎
-    QJSValue dataObj = m_jsEngine->newObject();
-    for (auto it = columns.begin(); it != columns.end(); ++it) {
-        dataObj.setProperty(it.key(), vectorToJSArray(it.value()));
+    // 源数据列 + 派生列（失败的派生列没有数据，不登记）
+    QMap<QString, QVector<double>> columns;
+    order.clear();
+    if (m_columnStore) {
+        for (const QString &name : m_columnStore->sourceColumnNames()) {
+            columns.insert(name, m_columnStore->column(name)->values);
+            order.append(name);
+        }
     }
-    m_jsEngine->globalObject().setProperty("data", dataObj);
-    
-    // 同时添加派生列
     for (const auto &derived : m_derivedColumns) {
-        dataObj.setProperty(derived.name, vectorToJSArray(derived.data));
+        if (derived.data.isEmpty()) {
+            continue;
+        }
+        if (!columns.contains(derived.name)) {
+            order.append(derived.name);
+        }
+        columns.insert(derived.name, derived.data);
     }
+    return columns;
 }
 
-bool ScriptEngine::executeScript(const QString &script, const QString &outputColumnName)
+bool ScriptEngine::checkOutputName(const QString &name)
 {
-    m_lastError.clear();
-    
-    if (outputColumnName.trimmed().isEmpty()) {
+    if (name.trimmed().isEmpty()) {
         m_lastError = "输出列名不能为空";
         return false;
     }
     
     // 检查是否与源数据列重名
-    if (m_sourceData.contains(outputColumnName)) {
-        m_lastError = QString("列名 \"%1\" 与源数据列重名").arg(outputColumnName);
+    if (m_columnStore && m_columnStore->isSourceColumn(name)) {
+        m_lastError = QString("列名 \"%1\" 与源数据列重名").arg(name);
         return false;
     }
+    return true;
+}
+
+int ScriptEngine::executeScriptAsync(const QString &script, const QString &outputColumnName,
+                                     int timeoutMs, bool legacyArrays)
+{
+    m_lastError.clear();
     
-    // 执行脚本
-    QString wrappedScript = QString("(function() { %1 })()").arg(script);
-    QJSValue result = m_jsEngine->evaluate(wrappedScript);
+    if (!checkOutputName(outputColumnName)) {
+        return 0;
+    }
+    
+    QSharedPointer<ScriptJob> job(new ScriptJob());
+    job->kind = ScriptJob::Single;
+    job->timeoutMs = timeoutMs;
+    ScriptTask task;
+    task.name = outputColumnName;
+    task.script = script;
+    task.legacyArrays = legacyArrays;
+    job->tasks.append(task);
+    return enqueue(job);
+}
+
+int ScriptEngine::executeScriptsAsync(const QList<ScriptSource> &scripts, int timeoutMs)
+{
+    QSharedPointer<ScriptJob> job(new ScriptJob());
+    job->kind = ScriptJob::Batch;
+    job->timeoutMs = timeoutMs;
+    for (const ScriptSource &source : scripts) {
+        ScriptTask task;
+        task.name = source.outputName;
+        task.script = source.script;
+        task.legacyArrays = source.legacyArrays;
+        if (!checkOutputName(task.name)) {
+            task.error = m_lastError;
+        }
+        job->tasks.append(task);
+    }
+    m_lastError.clear();
+    return enqueue(job);
+}
+
+int ScriptEngine::recomputeAsync(const QStringList &changedColumns, int timeoutMs)
+{
+    if (m_derivedColumns.isEmpty()) {
+        return 0;
+    }
+    QSharedPointer<ScriptJob> job(new ScriptJob());
+    job->kind = ScriptJob::Recompute;
+    job->timeoutMs = timeoutMs;
+    job->changedColumns = changedColumns;
+    return enqueue(job);
+}
+
+int ScriptEngine::enqueue(const QSharedPointer<ScriptJob> &job)
+{
+    job->id = ++m_nextJobId;
+    m_pendingJobs.append(job);
+    startNextJob();
+    return job->id;
+}
+
+void ScriptEngine::startNextJob()
+{
+    if (m_activeJob || m_pendingJobs.isEmpty()) {
+        return;
+    }
+    const QSharedPointer<ScriptJob> job = m_pendingJobs.takeFirst();
     
-    if (result.isError()) {
-        m_lastError = QString("脚本错误 (行 %1): %2")
-            .arg(result.property("lineNumber").toInt())
-            .arg(result.toString());
-        return false;
+    // 开始时才采集快照，之前的任务写入的派生列对本任务可见
+    job->columns = columnSnapshot(job->order);
+    job->derived = m_derivedColumns;
+    
+    QPointer<ScriptEngine> self(this);
+    const int jobId = job->id;
+    job->report = [self, jobId](double fraction, const QString &message) {
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, jobId, fraction, message]() {
+            if (self) {
+                self->onJobProgress(jobId, fraction, message);
+            }
+        }, Qt::QueuedConnection);
+    };
+    m_activeJob = job;
+    
+    if (job->timeoutMs > 0) {
+        m_timeoutTimer->start(job->timeoutMs);
+    }
+    if (job->kind == ScriptJob::Single) {
+        emit scriptStarted(job->id, job->tasks.first().name);
     }
     
-    // 检查返回值是否为数组
-    if (!result.isArray()) {
-        m_lastError = "脚本必须返回一个数组";
-        return false;
+    // 任务在线程池中协调执行，同一层的其他脚本分给线程池的其他线程
+    QThreadPool *pool = m_pool;
+    m_pool->start([self, job, pool]() {
+        runJob(job, pool);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, job]() {
+            if (self) {
+                self->onJobFinished(job->id);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ScriptEngine::cancelJob(int jobId)
+{
+    if (m_activeJob && m_activeJob->id == jobId) {
+        m_activeJob->cancel(false);
+        return;
     }
     
-    // 转换结果
-    QVector<double> resultData = jsArrayToVector(result);
+    // 等待中的任务尚未开始，直接结束
+    for (int i = 0; i < m_pendingJobs.size(); ++i) {
+        if (m_pendingJobs[i]->id == jobId) {
+            const QSharedPointer<ScriptJob> job = m_pendingJobs.takeAt(i);
+            job->cancel(false);
+            finishJob(job);
+            return;
+        }
+    }
+}
+
+void ScriptEngine::onJobProgress(int jobId, double fraction, const QString &message)
+{
+    if (m_activeJob && m_activeJob->id == jobId) {
+        const QString name = m_activeJob->kind == ScriptJob::Single ? m_activeJob->tasks.first().name : QString();
+        emit scriptProgress(jobId, name, fraction, message);
+    }
+}
+
+void ScriptEngine::onJobFinished(int jobId)
+{
+    if (!m_activeJob || m_activeJob->id != jobId) {
+        return;
+    }
+    const QSharedPointer<ScriptJob> job = m_activeJob;
+    m_timeoutTimer->stop();
+    m_activeJob.clear();
     
-    if (resultData.isEmpty()) {
-        m_lastError = "脚本返回了空数组";
-        return false;
+    finishJob(job);
+    startNextJob();
+}
+
+void ScriptEngine::finishJob(const QSharedPointer<ScriptJob> &job)
+{
+    m_lastError.clear();
+    QStringList errors;
+    QStringList dependentErrors;
+    int succeeded = 0;
+    int total = job->tasks.size();
+    
+    if (job->timedOut) {
+        errors.append(QString("脚本执行超时（%1 秒），已中止").arg(job->timeoutMs / 1000.0, 0, 'g', 3));
+    } else if (job->cancelled) {
+        errors.append("脚本已取消");
+    } else {
+        // 按顺序写回，同名列以最后一次为准
+        for (const ScriptTask &task : job->tasks) {
+            if (!task.ok) {
+                errors.append(job->kind == ScriptJob::Single
+                    ? task.error : QString("%1: %2").arg(task.name, task.error));
+                continue;
+            }
+            storeDerivedColumn(task.name, task.script, task.legacyArrays, task.result);
+            ++succeeded;
+        }
+        
+        for (const ScriptTask &task : job->dependents) {
+            // 任务执行期间已删除或修改了脚本的列不再写入
+            const int index = indexOfDerived(task.name);
+            if (index < 0 || m_derivedColumns[index].sourceScript != task.script ||
+                m_derivedColumns[index].legacyArrays != task.legacyArrays) {
+                continue;
+            }
+            if (task.ok) {
+                storeDerivedColumn(task.name, task.script, task.legacyArrays, task.result);
+                continue;
+            }
+            // 失败的列保留脚本，清空数据（不再显示基于旧数据的结果）
+            m_derivedColumns[index].data.clear();
+            if (m_columnStore) {
+                m_columnStore->removeDerivedColumn(task.name);
+            }
+            dependentErrors.append(QString("%1: %2").arg(task.name, task.error));
+        }
+        if (job->kind == ScriptJob::Recompute) {
+            total = job->dependents.size();
+            succeeded = total - dependentErrors.size();
+        }
     }
     
-    // 保存派生列
+    if (job->kind == ScriptJob::Single) {
+        if (!dependentErrors.isEmpty()) {
+            qWarning() << "依赖列重新计算失败:" << dependentErrors.join("\n");
+        }
+        m_lastError = errors.join("\n");
+        emit scriptFinished(job->id, job->tasks.first().name, errors.isEmpty(), m_lastError);
+        return;
+    }
+    errors += dependentErrors;
+    m_lastError = errors.join("\n");
+    emit scriptsFinished(job->id, job->cancelled, succeeded, total, m_lastError);
+}
+
+int ScriptEngine::indexOfDerived(const QString &name) const
+{
+    for (int i = 0; i < m_derivedColumns.size(); ++i) {
+        if (m_derivedColumns[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ScriptEngine::storeDerivedColumn(const QString &name, const QString &script, bool legacyArrays,
+                                      const QVector<double> &data)
+{
     DerivedColumn derived;
-    derived.name = outputColumnName;
-    derived.data = resultData;
+    derived.name = name;
+    derived.data = data;
     derived.sourceScript = script;
+    derived.legacyArrays = legacyArrays;
+    derived.inputs = referencedColumns(script, &derived.dynamicInputs);
+    if (m_columnStore) {
+        m_columnStore->setDerivedColumn(name, data);
+    }
     
-    // 检查是否已存在同名派生列，如果是则替换
-    for (int i = 0; i < m_derivedColumns.size(); ++i) {
-        if (m_derivedColumns[i].name == outputColumnName) {
-            m_derivedColumns[i] = derived;
-            return true;
+    // 检查是否已存在同名派生列，如果是则替换（保持原有顺序）
+    const int index = indexOfDerived(name);
+    if (index >= 0) {
+        m_derivedColumns[index] = derived;
+    } else {
+        m_derivedColumns.append(derived);
+    }
+}
+
+QStringList ScriptEngine::referencedColumns(const QString &script, bool *dynamic)
+{
+    static const QRegularExpression memberPattern(R"(\bdata\s*\.\s*([\p{L}_$][\p{L}\p{N}_$]*))");
+    static const QRegularExpression indexPattern(R"re(\bdata\s*\[\s*(?:"([^"\\]*)"|'([^'\\]*)')\s*\])re");
+    static const QRegularExpression anyPattern(R"(\bdata\b)");
+    
+    QStringList columns;
+    int matched = 0;
+    QRegularExpressionMatchIterator it = memberPattern.globalMatch(script);
+    while (it.hasNext()) {
+        const QString name = it.next().captured(1);
+        if (!columns.contains(name)) {
+            columns.append(name);
+        }
+        ++matched;
+    }
+    it = indexPattern.globalMatch(script);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        const QString name = match.captured(1).isNull() ? match.captured(2) : match.captured(1);
+        if (!columns.contains(name)) {
+            columns.append(name);
         }
+        ++matched;
     }
     
-    m_derivedColumns.append(derived);
-    return true;
+    if (dynamic) {
+        // data 的其他用法（data[name]、Object.keys(data)、var d = data 等）无法确定读取了哪些列
+        int total = 0;
+        it = anyPattern.globalMatch(script);
+        while (it.hasNext()) {
+            it.next();
+            ++total;
+        }
+        *dynamic = total > matched;
+    }
+    return columns;
 }
 
 QVector<double> ScriptEngine::getDerivedColumnData(const QString &name) const
@@ -103,6 +800,9 @@ QVector<double> ScriptEngine::getDerivedColumnData(const QString &name) const
 void ScriptEngine::clearDerivedColumns()
 {
     m_derivedColumns.clear();
+    if (m_columnStore) {
+        m_columnStore->clearDerivedColumns();
+    }
 }
 
 bool ScriptEngine::removeDerivedColumn(const QString &name)
@@ -110,6 +810,9 @@ bool ScriptEngine::removeDerivedColumn(const QString &name)
     for (int i = 0; i < m_derivedColumns.size(); ++i) {
         if (m_derivedColumns[i].name == name) {
             m_derivedColumns.removeAt(i);
+            if (m_columnStore) {
+                m_columnStore->removeDerivedColumn(name);
+            }
             return true;
         }
     }
@@ -118,7 +821,10 @@ bool ScriptEngine::removeDerivedColumn(const QString &name)
 
 QStringList ScriptEngine::getAllColumnNames() const
 {
-    QStringList names = m_sourceData.keys();
+    QStringList names;
+    if (m_columnStore) {
+        names = m_columnStore->sourceColumnNames();
+    }
     for (const auto &col : m_derivedColumns) {
         names.append(col.name);
     }
@@ -131,9 +837,23 @@ QString ScriptEngine::getHelpDocument()
 === LogParser 脚本引擎帮助 ===
 
 【数据访问】
-  data.列名          - 访问CSV中的列数据，返回数组
+  data.列名          - 访问CSV中的列数据，返回 Float64Array（首次读取时载入）
   例: data.Temperature, data.Pressure
 
+【公式】
+  只由 data 列、数字、运算符和 Math 函数组成的脚本按逐元素公式处理，直接在原生代码中并行计算
+  例: return (data.P1 - data.P2) * 0.001 + data.Offset;
+      return data.Speed > 0 ? Math.sqrt(data.Speed) : 0;
+
+【数组】
+  math 函数的数组参数可以是 data 列、普通数组或类型化数组
+  data 列和 math 的数组结果是 Float64Array（旧版为普通数组）。与普通数组的区别：
+    没有 push、pop、concat 等方法，长度固定（写入 out[out.length] 无效），
+    Array.isArray 为 false，sort() 按数值而不是按字符串排序
+  math.to_array(a)    - 转为普通数组（需要 push、concat 等数组方法时使用）
+  旧版数组            - 勾选后（或 1.1 之前保存的预设方案中的脚本）math 结果和 data 列
+                        按普通数组提供，行为与旧版相同，但较慢
+
 【基本运算】
   math.add(a, b)      - 数组加法
   math.subtract(a, b) - 数组减法
@@ -158,7 +878,11 @@ QString ScriptEngine::getHelpDocument()
 
 【滤波器】
   math.moving_average(a, windowSize) - 移动平均
-  math.median_filter(a, windowSize)  - 中值滤波
+  math.median_filter(a, windowSize)  - 中值滤波（忽略NaN）
+  math.rolling_min(a, windowSize)    - 滑动最小值（忽略NaN）
+  math.rolling_max(a, windowSize)    - 滑动最大值（忽略NaN）
+  math.rolling_std(a, windowSize)    - 滑动标准差
+  窗口以当前点为中心，在数据两端截断；计算量与窗口大小基本无关
   math.lowpass_filter(a, cutoff)     - 低通滤波 (cutoff: 0-1)
   math.highpass_filter(a, cutoff)    - 高通滤波 (cutoff: 0-1)
 
@@ -172,6 +896,8 @@ QString ScriptEngine::getHelpDocument()
   math.fft_phase(a)            - FFT相位谱
   math.fft_frequency(n, fs)    - 频率轴 (n: 点数, fs: 采样率)
   math.power_spectrum(a)       - 功率谱
+  math.welch(a, seg, fs)       - Welch功率谱密度 (汉宁窗、50%重叠，第k点频率为 k*fs/seg)
+  （幅值、相位、功率谱先补零到2的幂次；互相关、卷积也基于FFT计算）
 
 【数学函数】
   math.abs_array(a)     - 绝对值
@@ -190,7 +916,8 @@ QString ScriptEngine::getHelpDocument()
   math.sine_wave(n, freq, amp, phase) - 正弦波
 
 【相关性】
-  math.cross_correlation(a, b)      - 互相关
+  math.cross_correlation(a, b)      - 互相关 (长度 2n-1，各延迟按重叠点数取平均)
+  math.convolve(a, b)               - 线性卷积 (长度 na+nb-1)
   math.correlation_coefficient(a, b) - 相关系数
 
 【插值】
@@ -203,6 +930,11 @@ QString ScriptEngine::getHelpDocument()
   math.ns_to_s_from_zero(a)    - 纳秒转秒，从0开始
   math.time_from_zero(a, scale) - 通用时间归零 (先减起始值，再乘以scale)
 
+【执行】
+  脚本在后台线程中执行，界面保持响应，可随时取消；超过超时时间自动中止
+  progress(比例, 说明) - 上报进度，比例为 0~1，例: progress(i / n, "第一遍")
+  计算较慢的结果缓存在磁盘上，脚本和所读取的列都未改变时直接读取（使用 Math.random、Date 的脚本除外）
+
 【示例脚本】
 
 // 示例1: 两列相加
@@ -229,696 +961,3 @@ return math.ms_to_s_from_zero(data.Timestamp);
 return math.time_from_zero(data.Timestamp, 0.001);
 )";
 }
-
-void ScriptEngine::registerBuiltinFunctions()
-{
-    // 注册数学工具对象
-    MathUtils *mathUtils = new MathUtils(this);
-    QJSValue mathObj = m_jsEngine->newQObject(mathUtils);
-    m_jsEngine->globalObject().setProperty("math", mathObj);
-    
-    // 添加一些常用的全局函数
-    m_jsEngine->evaluate(R"(
-        function len(arr) { return arr.length; }
-        function print(msg) { console.log(msg); }
-    )");
-}
-
-QJSValue ScriptEngine::vectorToJSArray(const QVector<double> &vec)
-{
-    QJSValue arr = m_jsEngine->newArray(vec.size());
-    for (int i = 0; i < vec.size(); ++i) {
-        arr.setProperty(i, vec[i]);
-    }
-    return arr;
-}
-
-QVector<double> ScriptEngine::jsArrayToVector(const QJSValue &array)
-{
-    QVector<double> result;
-    int length = array.property("length").toInt();
-    result.reserve(length);
-    for (int i = 0; i < length; ++i) {
-        result.append(array.property(i).toNumber());
-    }
-    return result;
-}
-
-// ==================== MathUtils ====================
-
-QVector<double> MathUtils::toVector(const QVariantList &list)
-{
-    QVector<double> result;
-    result.reserve(list.size());
-    for (const auto &v : list) {
-        result.append(v.toDouble());
-    }
-    return result;
-}
-
-QVariantList MathUtils::toVariantList(const QVector<double> &vec)
-{
-    QVariantList result;
-    for (double v : vec) {
-        result.append(v);
-    }
-    return result;
-}
-
-// ===== 基本数组操作 =====
-
-QVariantList MathUtils::add(const QVariantList &a, const QVariantList &b)
-{
-    QVector<double> va = toVector(a);
-    QVector<double> vb = toVector(b);
-    QVector<double> result(qMin(va.size(), vb.size()));
-    for (int i = 0; i < result.size(); ++i) {
-        result[i] = va[i] + vb[i];
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::subtract(const QVariantList &a, const QVariantList &b)
-{
-    QVector<double> va = toVector(a);
-    QVector<double> vb = toVector(b);
-    QVector<double> result(qMin(va.size(), vb.size()));
-    for (int i = 0; i < result.size(); ++i) {
-        result[i] = va[i] - vb[i];
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::multiply(const QVariantList &a, const QVariantList &b)
-{
-    QVector<double> va = toVector(a);
-    QVector<double> vb = toVector(b);
-    QVector<double> result(qMin(va.size(), vb.size()));
-    for (int i = 0; i < result.size(); ++i) {
-        result[i] = va[i] * vb[i];
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::divide(const QVariantList &a, const QVariantList &b)
-{
-    QVector<double> va = toVector(a);
-    QVector<double> vb = toVector(b);
-    QVector<double> result(qMin(va.size(), vb.size()));
-    for (int i = 0; i < result.size(); ++i) {
-        result[i] = (vb[i] != 0) ? va[i] / vb[i] : 0;
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::scale(const QVariantList &a, double factor)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) {
-        v *= factor;
-    }
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::offset(const QVariantList &a, double value)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) {
-        v += value;
-    }
-    return toVariantList(va);
-}
-
-// ===== 统计函数 =====
-
-double MathUtils::sum(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    return std::accumulate(va.begin(), va.end(), 0.0);
-}
-
-double MathUtils::mean(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return 0;
-    return std::accumulate(va.begin(), va.end(), 0.0) / va.size();
-}
-
-double MathUtils::std_dev(const QVariantList &a)
-{
-    return std::sqrt(variance(a));
-}
-
-double MathUtils::variance(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    if (va.size() < 2) return 0;
-    double m = mean(a);
-    double sum = 0;
-    for (double v : va) {
-        sum += (v - m) * (v - m);
-    }
-    return sum / (va.size() - 1);
-}
-
-double MathUtils::min_val(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return 0;
-    return *std::min_element(va.begin(), va.end());
-}
-
-double MathUtils::max_val(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return 0;
-    return *std::max_element(va.begin(), va.end());
-}
-
-double MathUtils::rms(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return 0;
-    double sumSq = 0;
-    for (double v : va) {
-        sumSq += v * v;
-    }
-    return std::sqrt(sumSq / va.size());
-}
-
-// ===== 归一化 =====
-
-QVariantList MathUtils::normalize(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return a;
-    
-    double minV = *std::min_element(va.begin(), va.end());
-    double maxV = *std::max_element(va.begin(), va.end());
-    double range = maxV - minV;
-    
-    if (range == 0) {
-        std::fill(va.begin(), va.end(), 0.5);
-    } else {
-        for (double &v : va) {
-            v = (v - minV) / range;
-        }
-    }
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::standardize(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    if (va.size() < 2) return a;
-    
-    double m = mean(a);
-    double s = std_dev(a);
-    
-    if (s == 0) {
-        std::fill(va.begin(), va.end(), 0);
-    } else {
-        for (double &v : va) {
-            v = (v - m) / s;
-        }
-    }
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::normalize_range(const QVariantList &a, double newMin, double newMax)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return a;
-    
-    double minV = *std::min_element(va.begin(), va.end());
-    double maxV = *std::max_element(va.begin(), va.end());
-    double range = maxV - minV;
-    
-    if (range == 0) {
-        std::fill(va.begin(), va.end(), (newMin + newMax) / 2);
-    } else {
-        for (double &v : va) {
-            v = newMin + (v - minV) / range * (newMax - newMin);
-        }
-    }
-    return toVariantList(va);
-}
-
-// ===== 滤波器 =====
-
-QVariantList MathUtils::moving_average(const QVariantList &a, int windowSize)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty() || windowSize < 1) return a;
-    
-    windowSize = qMin(windowSize, va.size());
-    QVector<double> result(va.size());
-    
-    for (int i = 0; i < va.size(); ++i) {
-        int start = qMax(0, i - windowSize / 2);
-        int end = qMin(va.size(), i + windowSize / 2 + 1);
-        double sum = 0;
-        for (int j = start; j < end; ++j) {
-            sum += va[j];
-        }
-        result[i] = sum / (end - start);
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::median_filter(const QVariantList &a, int windowSize)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty() || windowSize < 1) return a;
-    
-    windowSize = qMin(windowSize, va.size());
-    QVector<double> result(va.size());
-    
-    for (int i = 0; i < va.size(); ++i) {
-        int start = qMax(0, i - windowSize / 2);
-        int end = qMin(va.size(), i + windowSize / 2 + 1);
-        QVector<double> window;
-        for (int j = start; j < end; ++j) {
-            window.append(va[j]);
-        }
-        std::sort(window.begin(), window.end());
-        result[i] = window[window.size() / 2];
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::lowpass_filter(const QVariantList &a, double cutoffRatio)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return a;
-    
-    cutoffRatio = qBound(0.0, cutoffRatio, 1.0);
-    double alpha = cutoffRatio;
-    
-    QVector<double> result(va.size());
-    result[0] = va[0];
-    for (int i = 1; i < va.size(); ++i) {
-        result[i] = alpha * va[i] + (1 - alpha) * result[i - 1];
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::highpass_filter(const QVariantList &a, double cutoffRatio)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return a;
-    
-    QVariantList lowpassed = lowpass_filter(a, cutoffRatio);
-    return subtract(a, lowpassed);
-}
-
-// ===== 微积分 =====
-
-QVariantList MathUtils::derivative(const QVariantList &a, double dt)
-{
-    QVector<double> va = toVector(a);
-    if (va.size() < 2) return a;
-    
-    QVector<double> result(va.size());
-    result[0] = (va[1] - va[0]) / dt;
-    for (int i = 1; i < va.size() - 1; ++i) {
-        result[i] = (va[i + 1] - va[i - 1]) / (2 * dt);
-    }
-    result[va.size() - 1] = (va[va.size() - 1] - va[va.size() - 2]) / dt;
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::integral(const QVariantList &a, double dt)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return a;
-    
-    QVector<double> result(va.size());
-    result[0] = 0;
-    for (int i = 1; i < va.size(); ++i) {
-        result[i] = result[i - 1] + (va[i] + va[i - 1]) / 2 * dt;
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::cumsum(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    QVector<double> result(va.size());
-    double sum = 0;
-    for (int i = 0; i < va.size(); ++i) {
-        sum += va[i];
-        result[i] = sum;
-    }
-    return toVariantList(result);
-}
-
-// ===== 傅里叶变换 =====
-
-void MathUtils::fft_impl(std::vector<std::complex<double>> &data, bool inverse)
-{
-    int n = data.size();
-    if (n <= 1) return;
-    
-    // 位反转置换
-    for (int i = 1, j = 0; i < n; ++i) {
-        int bit = n >> 1;
-        for (; j & bit; bit >>= 1) {
-            j ^= bit;
-        }
-        j ^= bit;
-        if (i < j) std::swap(data[i], data[j]);
-    }
-    
-    // Cooley-Tukey FFT
-    for (int len = 2; len <= n; len <<= 1) {
-        double angle = 2 * M_PI / len * (inverse ? 1 : -1);
-        std::complex<double> wn(cos(angle), sin(angle));
-        for (int i = 0; i < n; i += len) {
-            std::complex<double> w(1);
-            for (int j = 0; j < len / 2; ++j) {
-                std::complex<double> u = data[i + j];
-                std::complex<double> t = w * data[i + j + len / 2];
-                data[i + j] = u + t;
-                data[i + j + len / 2] = u - t;
-                w *= wn;
-            }
-        }
-    }
-    
-    if (inverse) {
-        for (auto &x : data) {
-            x /= n;
-        }
-    }
-}
-
-QVariantList MathUtils::fft_magnitude(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    
-    // 补零到2的幂次
-    int n = 1;
-    while (n < va.size()) n <<= 1;
-    
-    std::vector<std::complex<double>> data(n);
-    for (int i = 0; i < va.size(); ++i) {
-        data[i] = std::complex<double>(va[i], 0);
-    }
-    
-    fft_impl(data, false);
-    
-    // 只返回正频率部分
-    QVector<double> result(n / 2 + 1);
-    for (int i = 0; i <= n / 2; ++i) {
-        result[i] = std::abs(data[i]) * 2 / n;
-    }
-    result[0] /= 2;  // DC分量不需要乘2
-    
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::fft_phase(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    
-    int n = 1;
-    while (n < va.size()) n <<= 1;
-    
-    std::vector<std::complex<double>> data(n);
-    for (int i = 0; i < va.size(); ++i) {
-        data[i] = std::complex<double>(va[i], 0);
-    }
-    
-    fft_impl(data, false);
-    
-    QVector<double> result(n / 2 + 1);
-    for (int i = 0; i <= n / 2; ++i) {
-        result[i] = std::arg(data[i]);
-    }
-    
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::fft_frequency(int n, double sampleRate)
-{
-    int fftSize = 1;
-    while (fftSize < n) fftSize <<= 1;
-    
-    QVector<double> result(fftSize / 2 + 1);
-    for (int i = 0; i <= fftSize / 2; ++i) {
-        result[i] = i * sampleRate / fftSize;
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::power_spectrum(const QVariantList &a)
-{
-    QVariantList mag = fft_magnitude(a);
-    QVector<double> vm = toVector(mag);
-    for (double &v : vm) {
-        v = v * v;
-    }
-    return toVariantList(vm);
-}
-
-// ===== 数学函数 =====
-
-QVariantList MathUtils::abs_array(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) v = std::abs(v);
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::sqrt_array(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) v = std::sqrt(qMax(0.0, v));
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::pow_array(const QVariantList &a, double exp)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) v = std::pow(v, exp);
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::log_array(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) v = (v > 0) ? std::log(v) : 0;
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::log10_array(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) v = (v > 0) ? std::log10(v) : 0;
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::exp_array(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) v = std::exp(v);
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::sin_array(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) v = std::sin(v);
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::cos_array(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) v = std::cos(v);
-    return toVariantList(va);
-}
-
-QVariantList MathUtils::tan_array(const QVariantList &a)
-{
-    QVector<double> va = toVector(a);
-    for (double &v : va) v = std::tan(v);
-    return toVariantList(va);
-}
-
-// ===== 信号生成 =====
-
-QVariantList MathUtils::linspace(double start, double end, int n)
-{
-    QVector<double> result(n);
-    if (n == 1) {
-        result[0] = start;
-    } else {
-        double step = (end - start) / (n - 1);
-        for (int i = 0; i < n; ++i) {
-            result[i] = start + i * step;
-        }
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::zeros(int n)
-{
-    return toVariantList(QVector<double>(n, 0));
-}
-
-QVariantList MathUtils::ones(int n)
-{
-    return toVariantList(QVector<double>(n, 1));
-}
-
-QVariantList MathUtils::sine_wave(int n, double frequency, double amplitude, double phase)
-{
-    QVector<double> result(n);
-    for (int i = 0; i < n; ++i) {
-        result[i] = amplitude * std::sin(2 * M_PI * frequency * i / n + phase);
-    }
-    return toVariantList(result);
-}
-
-// ===== 相关性分析 =====
-
-QVariantList MathUtils::cross_correlation(const QVariantList &a, const QVariantList &b)
-{
-    QVector<double> va = toVector(a);
-    QVector<double> vb = toVector(b);
-    int n = qMax(va.size(), vb.size());
-    
-    QVector<double> result(2 * n - 1, 0);
-    
-    for (int lag = -(n - 1); lag < n; ++lag) {
-        double sum = 0;
-        int count = 0;
-        for (int i = 0; i < va.size(); ++i) {
-            int j = i + lag;
-            if (j >= 0 && j < vb.size()) {
-                sum += va[i] * vb[j];
-                count++;
-            }
-        }
-        result[lag + n - 1] = (count > 0) ? sum / count : 0;
-    }
-    return toVariantList(result);
-}
-
-double MathUtils::correlation_coefficient(const QVariantList &a, const QVariantList &b)
-{
-    QVector<double> va = toVector(a);
-    QVector<double> vb = toVector(b);
-    int n = qMin(va.size(), vb.size());
-    if (n < 2) return 0;
-    
-    double meanA = 0, meanB = 0;
-    for (int i = 0; i < n; ++i) {
-        meanA += va[i];
-        meanB += vb[i];
-    }
-    meanA /= n;
-    meanB /= n;
-    
-    double cov = 0, varA = 0, varB = 0;
-    for (int i = 0; i < n; ++i) {
-        double da = va[i] - meanA;
-        double db = vb[i] - meanB;
-        cov += da * db;
-        varA += da * da;
-        varB += db * db;
-    }
-    
-    if (varA == 0 || varB == 0) return 0;
-    return cov / std::sqrt(varA * varB);
-}
-
-// ===== 插值与重采样 =====
-
-QVariantList MathUtils::resample(const QVariantList &a, int newSize)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty() || newSize < 1) return a;
-    
-    QVector<double> result(newSize);
-    double ratio = (double)(va.size() - 1) / (newSize - 1);
-    
-    for (int i = 0; i < newSize; ++i) {
-        double idx = i * ratio;
-        int idx0 = (int)idx;
-        int idx1 = qMin(idx0 + 1, va.size() - 1);
-        double frac = idx - idx0;
-        result[i] = va[idx0] * (1 - frac) + va[idx1] * frac;
-    }
-    return toVariantList(result);
-}
-
-QVariantList MathUtils::interp_linear(const QVariantList &x, const QVariantList &y, const QVariantList &xNew)
-{
-    QVector<double> vx = toVector(x);
-    QVector<double> vy = toVector(y);
-    QVector<double> vxNew = toVector(xNew);
-    
-    if (vx.size() != vy.size() || vx.isEmpty()) {
-        return xNew;
-    }
-    
-    QVector<double> result(vxNew.size());
-    
-    for (int i = 0; i < vxNew.size(); ++i) {
-        double xi = vxNew[i];
-        
-        // 找到插值区间
-        int j = 0;
-        while (j < vx.size() - 1 && vx[j + 1] < xi) j++;
-        
-        if (j >= vx.size() - 1) {
-            result[i] = vy.last();
-        } else if (xi <= vx[0]) {
-            result[i] = vy[0];
-        } else {
-            double t = (xi - vx[j]) / (vx[j + 1] - vx[j]);
-            result[i] = vy[j] * (1 - t) + vy[j + 1] * t;
-        }
-    }
-    return toVariantList(result);
-}
-
-// ==================== 时间转换函数 ====================
-
-QVariantList MathUtils::ms_to_s_from_zero(const QVariantList &a)
-{
-    // 毫秒转秒，从0开始
-    return time_from_zero(a, 0.001);
-}
-
-QVariantList MathUtils::us_to_s_from_zero(const QVariantList &a)
-{
-    // 微秒转秒，从0开始
-    return time_from_zero(a, 0.000001);
-}
-
-QVariantList MathUtils::ns_to_s_from_zero(const QVariantList &a)
-{
-    // 纳秒转秒，从0开始
-    return time_from_zero(a, 0.000000001);
-}
-
-QVariantList MathUtils::time_from_zero(const QVariantList &a, double scaleFactor)
-{
-    QVector<double> va = toVector(a);
-    if (va.isEmpty()) return a;
-    
-    // 获取起始时间（第一个值）
-    double startTime = va[0];
-    
-    // 减去起始时间并乘以缩放因子
-    QVector<double> result(va.size());
-    for (int i = 0; i < va.size(); ++i) {
-        result[i] = (va[i] - startTime) * scaleFactor;
-    }
-    
-    return toVariantList(result);
-}
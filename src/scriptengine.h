@@ -8,10 +8,15 @@
 #include <QVariant>
 #include <QJSEngine>
 #include <QJSValue>
+#include <QSharedPointer>
 #include <cmath>
-#include <complex>
 #include <algorithm>
 #include <numeric>
+#include "columnstore.h"
+
+class QThreadPool;
+class QTimer;
+struct ScriptJob;
 
 /**
  * @brief 派生数据列结构
@@ -19,8 +24,21 @@
 struct DerivedColumn
 {
     QString name;               // 列名
-    QVector<double> data;       // 数据
+    QVector<double> data;       // 数据（与列存储共享）
     QString sourceScript;       // 生成该列的脚本
+    QStringList inputs;         // 脚本读取的列（data.X / data["X"]）
+    bool dynamicInputs = false; // 以无法静态确定的方式访问 data（如 data[name]），视为依赖之前的所有列
+    bool legacyArrays = false;  // 按旧版数组接口执行（math 结果和 data 列为普通数组）
+};
+
+/**
+ * @brief 批量执行的一个脚本
+ */
+struct ScriptSource
+{
+    QString outputName;         // 输出列名
+    QString script;
+    bool legacyArrays = false;  // 按旧版数组接口执行，见 ScriptRunner::run
 };
 
 /**
@@ -36,18 +54,52 @@ public:
     ~ScriptEngine();
     
     /**
-     * @brief 设置源数据列
-     * @param columns 列名到数据的映射
+     * @brief 设置数据列存储，源数据从中读取，派生列写回其中
+     */
+    void setColumnStore(ColumnStore *store) { m_columnStore = store; }
+    ColumnStore *columnStore() const { return m_columnStore; }
+    
+    /**
+     * @brief 在工作线程中执行脚本，不阻塞界面，完成后发出 scriptFinished
+     * 替换已有的派生列时，读取该列的其他派生列在同一任务中随之重新计算
+     * 工作线程各自持有独立的JS引擎并重复使用；任务按提交顺序逐个执行，开始执行时采集列快照
+     * @param timeoutMs 超时时间（毫秒），超时后中断脚本；0 表示不限时
+     * @param legacyArrays 按旧版数组接口执行，见 ScriptRunner::run
+     * @return 任务编号，与 scriptFinished 的 jobId 对应；参数无效时返回 0，错误信息见 getLastError()
+     */
+    int executeScriptAsync(const QString &script, const QString &outputColumnName,
+                           int timeoutMs = 0, bool legacyArrays = false);
+    
+    /**
+     * @brief 在工作线程中批量执行脚本（如加载预设），完成后发出 scriptsFinished
+     * 结果与按列表顺序逐个执行相同：脚本读取列表中在它之前生成的列时依赖该脚本；互不依赖的脚本
+     * 在线程池的独立JS引擎上并行执行，共享只读的源数据列。全部完成后按列表顺序写入派生列
+     * @param scripts 按执行顺序排列的脚本
+     * @param timeoutMs 整个任务的超时时间（毫秒）；0 表示不限时
+     * @return 任务编号，与 scriptsFinished 的 jobId 对应
+     */
+    int executeScriptsAsync(const QList<ScriptSource> &scripts, int timeoutMs = 0);
+    
+    /**
+     * @brief 列数据改变后（重新载入文件等）在工作线程中重新计算受影响的派生列，完成后发出 scriptsFinished
+     * 按依赖关系分层执行，同一层互不依赖的脚本在多个线程上并行运行；
+     * 失败的派生列保留脚本但清空数据，取消或超时时保留原有数据
+     * @param changedColumns 数据已改变的列
+     * @param timeoutMs 整个任务的超时时间（毫秒）；0 表示不限时
+     * @return 任务编号；没有派生列时返回 0，不发出信号
+     */
+    int recomputeAsync(const QStringList &changedColumns, int timeoutMs = 0);
+    
+    /**
+     * @brief 是否有脚本任务正在执行或等待执行
      */
-    void setSourceData(const QMap<QString, QVector<double>> &columns);
+    bool isRunning() const { return !m_activeJob.isNull() || !m_pendingJobs.isEmpty(); }
     
     /**
-     * @brief 执行脚本生成新列
-     * @param script 用户脚本
-     * @param outputColumnName 输出列名
-     * @return 是否成功
+     * @brief 解析脚本读取的数据列
+     * @param dynamic 输出：脚本是否以无法静态确定的方式访问 data
      */
-    bool executeScript(const QString &script, const QString &outputColumnName);
+    static QStringList referencedColumns(const QString &script, bool *dynamic = nullptr);
     
     /**
      * @brief 获取生成的派生列
@@ -84,115 +136,85 @@ public:
      */
     static QString getHelpDocument();
 
-private:
+public slots:
+    /**
+     * @brief 取消指定的脚本任务，不写入其任何结果；正在执行时JS引擎在下一个检查点中断
+     * 其他任务（如排在后面的重新计算）不受影响
+     */
+    void cancelJob(int jobId);
+
+signals:
+    /**
+     * @brief 异步脚本开始执行
+     */
+    void scriptStarted(int jobId, const QString &name);
+    
     /**
-     * @brief 注册内置函数到JS引擎
+     * @brief 脚本通过 progress(比例, 说明) 上报的进度
+     * @param fraction 完成比例 0~1，小于0表示未知
      */
-    void registerBuiltinFunctions();
+    void scriptProgress(int jobId, const QString &name, double fraction, const QString &message);
     
     /**
-     * @brief 将QVector转换为JS数组
+     * @brief 异步脚本执行结束（成功、失败、取消或超时）
      */
-    QJSValue vectorToJSArray(const QVector<double> &vec);
+    void scriptFinished(int jobId, const QString &name, bool success, const QString &error);
     
     /**
-     * @brief 将JS数组转换为QVector
+     * @brief 批量执行或重新计算任务结束
+     * @param cancelled 任务被取消或超时，没有写入任何结果
+     * @param succeeded 成功的脚本数：批量执行时为列表中的脚本，重新计算时为受影响的派生列
+     * @param total 同上，参与执行的脚本数
+     * @param errors 失败信息，每行一条；为空表示全部成功
      */
-    QVector<double> jsArrayToVector(const QJSValue &array);
+    void scriptsFinished(int jobId, bool cancelled, int succeeded, int total, const QString &errors);
 
 private:
-    QJSEngine *m_jsEngine;
-    QMap<QString, QVector<double>> m_sourceData;
-    QList<DerivedColumn> m_derivedColumns;
-    QString m_lastError;
-};
-
-/**
- * @brief 数学工具类，提供给JS引擎使用
- */
-class MathUtils : public QObject
-{
-    Q_OBJECT
+    /**
+     * @brief 当前所有列（源数据列 + 派生列）的快照，数据隐式共享
+     */
+    QMap<QString, QVector<double>> columnSnapshot(QStringList &order) const;
     
-public:
-    explicit MathUtils(QObject *parent = nullptr) : QObject(parent) {}
-    
-    // ===== 基本数组操作 =====
-    Q_INVOKABLE QVariantList add(const QVariantList &a, const QVariantList &b);
-    Q_INVOKABLE QVariantList subtract(const QVariantList &a, const QVariantList &b);
-    Q_INVOKABLE QVariantList multiply(const QVariantList &a, const QVariantList &b);
-    Q_INVOKABLE QVariantList divide(const QVariantList &a, const QVariantList &b);
-    Q_INVOKABLE QVariantList scale(const QVariantList &a, double factor);
-    Q_INVOKABLE QVariantList offset(const QVariantList &a, double value);
-    
-    // ===== 统计函数 =====
-    Q_INVOKABLE double sum(const QVariantList &a);
-    Q_INVOKABLE double mean(const QVariantList &a);
-    Q_INVOKABLE double std_dev(const QVariantList &a);
-    Q_INVOKABLE double variance(const QVariantList &a);
-    Q_INVOKABLE double min_val(const QVariantList &a);
-    Q_INVOKABLE double max_val(const QVariantList &a);
-    Q_INVOKABLE double rms(const QVariantList &a);
-    
-    // ===== 归一化 =====
-    Q_INVOKABLE QVariantList normalize(const QVariantList &a);           // 0-1归一化
-    Q_INVOKABLE QVariantList standardize(const QVariantList &a);         // Z-score标准化
-    Q_INVOKABLE QVariantList normalize_range(const QVariantList &a, double newMin, double newMax);
-    
-    // ===== 滤波器 =====
-    Q_INVOKABLE QVariantList moving_average(const QVariantList &a, int windowSize);
-    Q_INVOKABLE QVariantList median_filter(const QVariantList &a, int windowSize);
-    Q_INVOKABLE QVariantList lowpass_filter(const QVariantList &a, double cutoffRatio);
-    Q_INVOKABLE QVariantList highpass_filter(const QVariantList &a, double cutoffRatio);
-    
-    // ===== 微积分 =====
-    Q_INVOKABLE QVariantList derivative(const QVariantList &a, double dt = 1.0);
-    Q_INVOKABLE QVariantList integral(const QVariantList &a, double dt = 1.0);
-    Q_INVOKABLE QVariantList cumsum(const QVariantList &a);
-    
-    // ===== 傅里叶变换 =====
-    Q_INVOKABLE QVariantList fft_magnitude(const QVariantList &a);       // FFT幅值
-    Q_INVOKABLE QVariantList fft_phase(const QVariantList &a);           // FFT相位
-    Q_INVOKABLE QVariantList fft_frequency(int n, double sampleRate);    // 频率轴
-    Q_INVOKABLE QVariantList power_spectrum(const QVariantList &a);      // 功率谱
-    
-    // ===== 数学函数 =====
-    Q_INVOKABLE QVariantList abs_array(const QVariantList &a);
-    Q_INVOKABLE QVariantList sqrt_array(const QVariantList &a);
-    Q_INVOKABLE QVariantList pow_array(const QVariantList &a, double exp);
-    Q_INVOKABLE QVariantList log_array(const QVariantList &a);
-    Q_INVOKABLE QVariantList log10_array(const QVariantList &a);
-    Q_INVOKABLE QVariantList exp_array(const QVariantList &a);
-    Q_INVOKABLE QVariantList sin_array(const QVariantList &a);
-    Q_INVOKABLE QVariantList cos_array(const QVariantList &a);
-    Q_INVOKABLE QVariantList tan_array(const QVariantList &a);
-    
-    // ===== 信号生成 =====
-    Q_INVOKABLE QVariantList linspace(double start, double end, int n);
-    Q_INVOKABLE QVariantList zeros(int n);
-    Q_INVOKABLE QVariantList ones(int n);
-    Q_INVOKABLE QVariantList sine_wave(int n, double frequency, double amplitude = 1.0, double phase = 0.0);
-    
-    // ===== 相关性分析 =====
-    Q_INVOKABLE QVariantList cross_correlation(const QVariantList &a, const QVariantList &b);
-    Q_INVOKABLE double correlation_coefficient(const QVariantList &a, const QVariantList &b);
-    
-    // ===== 插值与重采样 =====
-    Q_INVOKABLE QVariantList resample(const QVariantList &a, int newSize);
-    Q_INVOKABLE QVariantList interp_linear(const QVariantList &x, const QVariantList &y, const QVariantList &xNew);
-    
-    // ===== 时间转换 =====
-    Q_INVOKABLE QVariantList ms_to_s_from_zero(const QVariantList &a);   // ms转s，从0开始
-    Q_INVOKABLE QVariantList us_to_s_from_zero(const QVariantList &a);   // us转s，从0开始
-    Q_INVOKABLE QVariantList ns_to_s_from_zero(const QVariantList &a);   // ns转s，从0开始
-    Q_INVOKABLE QVariantList time_from_zero(const QVariantList &a, double scaleFactor = 1.0);  // 通用时间归零并缩放
+    /**
+     * @brief 加入任务队列，没有任务在执行时立即开始
+     */
+    int enqueue(const QSharedPointer<ScriptJob> &job);
     
-private:
-    QVector<double> toVector(const QVariantList &list);
-    QVariantList toVariantList(const QVector<double> &vec);
+    /**
+     * @brief 开始执行队列中的下一个任务
+     */
+    void startNextJob();
     
-    // FFT辅助函数
-    void fft_impl(std::vector<std::complex<double>> &data, bool inverse = false);
+    /**
+     * @brief 写入任务结果并发出完成信号
+     */
+    void finishJob(const QSharedPointer<ScriptJob> &job);
+    
+    /**
+     * @brief 保存派生列结果（数据只在列存储中保留一份）
+     */
+    void storeDerivedColumn(const QString &name, const QString &script, bool legacyArrays,
+                            const QVector<double> &data);
+    
+    int indexOfDerived(const QString &name) const;
+    
+    /**
+     * @brief 检查输出列名是否可用
+     */
+    bool checkOutputName(const QString &name);
+    
+    void onJobProgress(int jobId, double fraction, const QString &message);
+    void onJobFinished(int jobId);
+
+private:
+    QThreadPool *m_pool;                        // 脚本任务的工作线程
+    QTimer *m_timeoutTimer;
+    QSharedPointer<ScriptJob> m_activeJob;      // 正在执行的任务
+    QList<QSharedPointer<ScriptJob>> m_pendingJobs;
+    int m_nextJobId;
+    ColumnStore *m_columnStore;
+    QList<DerivedColumn> m_derivedColumns;
+    QString m_lastError;
 };
 
 #endif // SCRIPTENGINE_H
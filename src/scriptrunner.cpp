@@ -0,0 +1,177 @@
+#include "scriptrunner.h"
+#include "mathutils.h"
+#include "expressionplan.h"
+#include "typedarraybridge.h"
+#include <QJSEngine>
+#include <QMetaMethod>
+#include <QThreadStorage>
+
+void ScriptProgressReporter::report(double fraction, const QString &message)
+{
+    if (m_handler && *m_handler) {
+        (*m_handler)(fraction, message);
+    }
+}
+
+ScriptRunner::ScriptRunner()
+    : m_interrupted(false)
+    , m_engine(nullptr)
+    , m_bridge(nullptr)
+    , m_dataBound(false)
+{
+}
+
+ScriptRunner::~ScriptRunner()
+{
+    // 桥接对象持有JS值，须在引擎之前销毁；数学工具对象随引擎一起销毁
+    delete m_bridge;
+    delete m_engine;
+}
+
+void ScriptRunner::bind(const QMap<QString, QVector<double>> &columns, const QStringList &order)
+{
+    m_columns = columns;
+    m_order = order;
+    m_dataBound = false;
+}
+
+ScriptRunner *ScriptRunner::forCurrentThread()
+{
+    static QThreadStorage<ScriptRunner *> runners;
+    if (!runners.hasLocalData()) {
+        runners.setLocalData(new ScriptRunner());
+    }
+    return runners.localData();
+}
+
+void ScriptRunner::setInterrupted(bool interrupted)
+{
+    QMutexLocker locker(&m_engineMutex);
+    m_interrupted = interrupted;
+    if (m_engine) {
+        m_engine->setInterrupted(interrupted);
+    }
+}
+
+void ScriptRunner::ensureEngine()
+{
+    if (!m_engine) {
+        QJSEngine *engine = new QJSEngine();
+        m_bridge = new TypedArrayBridge(engine, engine);
+
+        // 注册数学工具对象
+        MathUtils *mathUtils = new MathUtils(m_bridge, engine);
+        engine->globalObject().setProperty("math", engine->newQObject(mathUtils));
+
+        // 旧版数组接口的兼容层：math 的数组结果和 data 列转为普通数组（首次读取时转换）
+        QStringList mathFunctions;
+        const QMetaObject *meta = mathUtils->metaObject();
+        for (int i = meta->methodOffset(); i < meta->methodCount(); ++i) {
+            const QString name = QString::fromLatin1(meta->method(i).name());
+            if (!mathFunctions.contains(name)) {
+                mathFunctions.append(name);
+            }
+        }
+        QJSValue legacy = engine->evaluate(R"(
+            (function(math, names) {
+                function plain(value) {
+                    return ArrayBuffer.isView(value) ? Array.from(value) : value;
+                }
+                function settle(obj, name, value) {
+                    Object.defineProperty(obj, name, {
+                        value: value, writable: true, enumerable: true, configurable: true
+                    });
+                    return value;
+                }
+                var legacyMath = {};
+                names.forEach(function(name) {
+                    legacyMath[name] = function() { return plain(math[name].apply(math, arguments)); };
+                });
+                return {
+                    math: legacyMath,
+                    data: function(data) {
+                        var legacyData = {};
+                        Object.keys(data).forEach(function(name) {
+                            Object.defineProperty(legacyData, name, {
+                                enumerable: true, configurable: true,
+                                get: function() { return settle(legacyData, name, plain(data[name])); },
+                                set: function(value) { settle(legacyData, name, value); }
+                            });
+                        });
+                        return legacyData;
+                    }
+                };
+            })
+        )").call(QJSValueList() << engine->globalObject().property("math")
+                                << engine->toScriptValue(mathFunctions));
+        engine->globalObject().setProperty("__legacy", legacy);
+
+        // 进度上报对象，回调在执行脚本的线程中调用
+        ScriptProgressReporter *reporter = new ScriptProgressReporter(&m_progressHandler, engine);
+        engine->globalObject().setProperty("__progress", engine->newQObject(reporter));
+
+        // 添加一些常用的全局函数
+        engine->evaluate(R"(
+            function len(arr) { return arr.length; }
+            function print(msg) { console.log(msg); }
+            function progress(fraction, message) {
+                __progress.report(Number(fraction), message === undefined ? "" : String(message));
+            }
+        )");
+
+        // 引擎创建前已请求的中断在此生效
+        QMutexLocker locker(&m_engineMutex);
+        m_engine = engine;
+        m_engine->setInterrupted(m_interrupted);
+    }
+    if (!m_dataBound) {
+        m_engine->globalObject().setProperty("data", m_bridge->createDataObject(m_columns, m_order));
+        m_dataBound = true;
+    }
+}
+
+bool ScriptRunner::run(const QString &script, QVector<double> &result, QString &error,
+                       bool legacyArrays)
+{
+    result.clear();
+    if (m_interrupted) {
+        error = "脚本已中断";
+        return false;
+    }
+
+    // 纯逐元素公式直接编译为原生计划求值，其他脚本交给JS引擎
+    ExpressionPlan plan;
+    if (!plan.compile(script) || !plan.evaluate(m_columns, result)) {
+        ensureEngine();
+        QString wrappedScript = legacyArrays
+            ? QString("(function(math, data) { %1 })(__legacy.math, __legacy.data(data))").arg(script)
+            : QString("(function() { %1 })()").arg(script);
+        QJSValue value = m_engine->evaluate(wrappedScript);
+
+        // 脚本可能改写了 data 的属性，下次执行前重新绑定
+        m_dataBound = false;
+
+        if (m_interrupted) {
+            error = "脚本已中断";
+            return false;
+        }
+        if (value.isError()) {
+            error = QString("脚本错误 (行 %1): %2")
+                .arg(value.property("lineNumber").toInt())
+                .arg(value.toString());
+            return false;
+        }
+
+        // 转换结果（普通数组或类型化数组）
+        if (!m_bridge->toVector(value, result)) {
+            error = "脚本必须返回一个数组";
+            return false;
+        }
+    }
+
+    if (result.isEmpty()) {
+        error = "脚本返回了空数组";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef SCRIPTRUNNER_H
+#define SCRIPTRUNNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QObject>
+#include <QMutex>
+#include <atomic>
+#include <functional>
+
+class QJSEngine;
+class TypedArrayBridge;
+
+/**
+ * @brief 脚本进度回调
+ * @param fraction 完成比例 0~1，小于0表示未知
+ */
+typedef std::function<void(double fraction, const QString &message)> ScriptProgressHandler;
+
+/**
+ * @brief 提供给JS的进度上报对象，脚本通过 progress(比例, 说明) 调用
+ */
+class ScriptProgressReporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ScriptProgressReporter(const ScriptProgressHandler *handler, QObject *parent = nullptr)
+        : QObject(parent), m_handler(handler) {}
+
+    Q_INVOKABLE void report(double fraction, const QString &message);
+
+private:
+    const ScriptProgressHandler *m_handler;
+};
+
+/**
+ * @brief 脚本执行器
+ * 每个执行器拥有独立的JS引擎，只能在创建它的线程中使用，多个执行器可在不同线程并行运行。
+ * 纯逐元素公式由 ExpressionPlan 直接求值；JS引擎在第一次需要时才创建。
+ * 按旧版数组接口执行的脚本，math 的数组结果和 data 列以普通数组提供。
+ * setInterrupted 可从其他线程调用，用于取消正在执行的脚本
+ */
+class ScriptRunner
+{
+public:
+    ScriptRunner();
+    ~ScriptRunner();
+
+    /**
+     * @brief 绑定数据列（隐式共享，不复制），脚本通过 data.列名 读取
+     * @param order 列在 data 对象中的顺序
+     */
+    void bind(const QMap<QString, QVector<double>> &columns, const QStringList &order);
+
+    /**
+     * @brief 执行脚本
+     * @param result 脚本返回的数组
+     * @param error 失败时的错误信息
+     * @param legacyArrays 按旧版数组接口执行：math 的数组结果和 data 列为普通数组（较慢），
+     *        用于依赖 push、concat、字符串排序等普通数组行为的旧预设脚本
+     */
+    bool run(const QString &script, QVector<double> &result, QString &error,
+             bool legacyArrays = false);
+
+    /**
+     * @brief 中断（或恢复）脚本执行，线程安全
+     * 中断后 JS 引擎在下一个检查点抛出错误，run 返回 false；再次执行前需恢复
+     */
+    void setInterrupted(bool interrupted);
+    bool isInterrupted() const { return m_interrupted.load(); }
+
+    /**
+     * @brief 设置脚本调用 progress() 时的回调，在执行脚本的线程中调用
+     */
+    void setProgressHandler(const ScriptProgressHandler &handler) { m_progressHandler = handler; }
+
+    /**
+     * @brief 当前线程专用的执行器（线程池中每个线程一个，JS引擎随线程复用，线程结束时销毁）
+     */
+    static ScriptRunner *forCurrentThread();
+
+private:
+    void ensureEngine();
+
+    QMutex m_engineMutex;                       // 保护 m_engine 的创建与跨线程中断
+    std::atomic<bool> m_interrupted;
+    ScriptProgressHandler m_progressHandler;
+    QJSEngine *m_engine;
+    TypedArrayBridge *m_bridge;
+    QMap<QString, QVector<double>> m_columns;
+    QStringList m_order;
+    bool m_dataBound;                           // data 对象是否与当前绑定的列一致
+};
+
+#endif // SCRIPTRUNNER_H
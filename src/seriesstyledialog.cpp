@@ -27,6 +27,9 @@ void SeriesStyleDialog::setupUi()
     m_displayModeCombo->addItem("连线模式", static_cast<int>(SeriesDisplayMode::Line));
     m_displayModeCombo->addItem("散点模式", static_cast<int>(SeriesDisplayMode::Scatter));
     m_displayModeCombo->addItem("连线 + 散点", static_cast<int>(SeriesDisplayMode::LineAndScatter));
+    m_displayModeCombo->addItem("密度热力图", static_cast<int>(SeriesDisplayMode::Density));
+    m_displayModeCombo->addItem("包络带（最小/最大值）", static_cast<int>(SeriesDisplayMode::Envelope));
+    m_displayModeCombo->addItem("时频图（STFT）", static_cast<int>(SeriesDisplayMode::Spectrogram));
     connect(m_displayModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &SeriesStyleDialog::onDisplayModeChanged);
     modeLayout->addRow("模式:", m_displayModeCombo);
@@ -37,6 +40,11 @@ void SeriesStyleDialog::setupUi()
     m_lineWidthSpin->setSuffix(" px");
     modeLayout->addRow("线宽:", m_lineWidthSpin);
     
+    m_meanLineCheck = new QCheckBox("显示均值线");
+    m_meanLineCheck->setChecked(true);
+    m_meanLineCheck->setToolTip("在包络带中叠加每个像素列的平均值曲线");
+    modeLayout->addRow("", m_meanLineCheck);
+    
     mainLayout->addWidget(modeGroup);
     
     // ========== 散点设置 ==========
@@ -51,6 +59,37 @@ void SeriesStyleDialog::setupUi()
     
     mainLayout->addWidget(m_scatterGroup);
     
+    // ========== 时频图设置 ==========
+    m_spectrogramGroup = new QGroupBox("时频图设置");
+    QFormLayout *spectrogramLayout = new QFormLayout(m_spectrogramGroup);
+    
+    m_segmentCombo = new QComboBox();
+    for (int size = 128; size <= 16384; size *= 2) {
+        m_segmentCombo->addItem(QString::number(size), size);
+    }
+    m_segmentCombo->setToolTip("每段的点数：越长频率分辨率越高，时间分辨率越低");
+    spectrogramLayout->addRow("分段长度:", m_segmentCombo);
+    
+    m_overlapSpin = new QSpinBox();
+    m_overlapSpin->setRange(0, 90);
+    m_overlapSpin->setSingleStep(5);
+    m_overlapSpin->setSuffix(" %");
+    spectrogramLayout->addRow("重叠:", m_overlapSpin);
+    
+    m_windowCombo = new QComboBox();
+    m_windowCombo->addItem("矩形窗", static_cast<int>(SpectralWindow::Rectangular));
+    m_windowCombo->addItem("汉宁窗 (Hann)", static_cast<int>(SpectralWindow::Hann));
+    m_windowCombo->addItem("汉明窗 (Hamming)", static_cast<int>(SpectralWindow::Hamming));
+    m_windowCombo->addItem("布莱克曼窗 (Blackman)", static_cast<int>(SpectralWindow::Blackman));
+    spectrogramLayout->addRow("窗函数:", m_windowCombo);
+    
+    QLabel *spectrogramHint = new QLabel("Y轴为频率（按X轴估计采样率，要求均匀采样），颜色为功率谱密度(dB)");
+    spectrogramHint->setWordWrap(true);
+    spectrogramHint->setStyleSheet("color: gray; font-size: 10px;");
+    spectrogramLayout->addRow("", spectrogramHint);
+    
+    mainLayout->addWidget(m_spectrogramGroup);
+    
     // ========== Y值区间过滤 ==========
     m_rangeGroup = new QGroupBox("Y值区间过滤");
     m_rangeGroup->setCheckable(true);
@@ -124,10 +163,24 @@ void SeriesStyleDialog::applyStyle(const SeriesStyle &style)
     
     // 设置线宽
     m_lineWidthSpin->setValue(style.lineWidth);
+    m_meanLineCheck->setChecked(style.showMeanLine);
     
     // 设置散点大小
     m_scatterSizeSpin->setValue(style.scatterSize);
     
+    // 设置时频图参数（不在列表中的分段长度追加为选项）
+    int segmentIndex = m_segmentCombo->findData(style.spectral.segmentSize);
+    if (segmentIndex < 0) {
+        m_segmentCombo->addItem(QString::number(style.spectral.segmentSize), style.spectral.segmentSize);
+        segmentIndex = m_segmentCombo->count() - 1;
+    }
+    m_segmentCombo->setCurrentIndex(segmentIndex);
+    m_overlapSpin->setValue(style.spectral.overlapPercent);
+    int windowIndex = m_windowCombo->findData(static_cast<int>(style.spectral.window));
+    if (windowIndex >= 0) {
+        m_windowCombo->setCurrentIndex(windowIndex);
+    }
+    
     // 设置区间过滤
     m_rangeGroup->setChecked(style.filterByRange);
     m_minValueSpin->setValue(style.minValue);
@@ -144,7 +197,11 @@ SeriesStyle SeriesStyleDialog::getStyle() const
     style.displayMode = static_cast<SeriesDisplayMode>(
         m_displayModeCombo->currentData().toInt());
     style.lineWidth = m_lineWidthSpin->value();
+    style.showMeanLine = m_meanLineCheck->isChecked();
     style.scatterSize = m_scatterSizeSpin->value();
+    style.spectral.segmentSize = m_segmentCombo->currentData().toInt();
+    style.spectral.overlapPercent = m_overlapSpin->value();
+    style.spectral.window = static_cast<SpectralWindow>(m_windowCombo->currentData().toInt());
     style.filterByRange = m_rangeGroup->isChecked();
     style.minValue = m_minValueSpin->value();
     style.maxValue = m_maxValueSpin->value();
@@ -169,10 +226,18 @@ void SeriesStyleDialog::onDisplayModeChanged(int index)
                         mode == SeriesDisplayMode::LineAndScatter);
     m_scatterGroup->setEnabled(showScatter);
     
-    // 线宽仅在连线模式或连线+散点模式下可用
+    // 线宽仅在连线模式、连线+散点模式或包络带（均值线）下可用
     bool showLine = (mode == SeriesDisplayMode::Line || 
-                     mode == SeriesDisplayMode::LineAndScatter);
+                     mode == SeriesDisplayMode::LineAndScatter ||
+                     mode == SeriesDisplayMode::Envelope);
     m_lineWidthSpin->setEnabled(showLine);
+    
+    // 均值线仅在包络带模式下可用
+    m_meanLineCheck->setEnabled(mode == SeriesDisplayMode::Envelope);
+    
+    // 时频图直接使用原始信号，不做Y值区间过滤
+    m_spectrogramGroup->setEnabled(mode == SeriesDisplayMode::Spectrogram);
+    m_rangeGroup->setEnabled(mode != SeriesDisplayMode::Spectrogram);
 }
 
 void SeriesStyleDialog::onResetToDefault()
@@ -13,6 +13,7 @@
 #include <QDialogButtonBox>
 #include <QPushButton>
 #include <QJsonObject>
+#include "spectralanalyzer.h"
 
 /**
  * @brief 曲线显示模式枚举
@@ -20,7 +21,10 @@
 enum class SeriesDisplayMode {
     Line,           // 连线模式（默认）
     Scatter,        // 散点模式
-    LineAndScatter  // 连线+散点
+    LineAndScatter, // 连线+散点
+    Density,        // 密度热力图（适用于海量散点）
+    Envelope,       // 包络带：按像素列填充最小/最大值区域（适用于高采样率信号）
+    Spectrogram     // 时频图：Y轴为频率，按视图分段计算功率谱密度（适用于振动等均匀采样信号）
 };
 
 /**
@@ -46,6 +50,12 @@ struct SeriesStyle
     // Y轴分组（多Y轴模式下使用，相同组号的系列共享Y轴）
     int yAxisGroup = 0;
     
+    // 包络带模式下是否显示均值线
+    bool showMeanLine = true;
+    
+    // 时频图模式的分段长度、重叠和窗函数
+    SpectralSettings spectral;
+    
     /**
      * @brief 序列化为JSON
      */
@@ -58,6 +68,10 @@ struct SeriesStyle
         obj["scatterSize"] = scatterSize;
         obj["lineWidth"] = lineWidth;
         obj["yAxisGroup"] = yAxisGroup;
+        obj["showMeanLine"] = showMeanLine;
+        obj["spectrogramSegment"] = spectral.segmentSize;
+        obj["spectrogramOverlap"] = spectral.overlapPercent;
+        obj["spectrogramWindow"] = static_cast<int>(spectral.window);
         return obj;
     }
     
@@ -73,6 +87,11 @@ struct SeriesStyle
         style.scatterSize = obj["scatterSize"].toInt(6);
         style.lineWidth = obj["lineWidth"].toInt(2);
         style.yAxisGroup = obj["yAxisGroup"].toInt(0);
+        style.showMeanLine = obj["showMeanLine"].toBool(true);
+        style.spectral.segmentSize = obj["spectrogramSegment"].toInt(1024);
+        style.spectral.overlapPercent = obj["spectrogramOverlap"].toInt(50);
+        style.spectral.window = static_cast<SpectralWindow>(
+            obj["spectrogramWindow"].toInt(static_cast<int>(SpectralWindow::Hann)));
         return style;
     }
     
@@ -84,7 +103,9 @@ struct SeriesStyle
                !filterByRange &&
                scatterSize == 6 &&
                lineWidth == 2 &&
-               yAxisGroup == 0;
+               yAxisGroup == 0 &&
+               showMeanLine &&
+               spectral == SpectralSettings();
     }
 };
 
@@ -130,12 +151,21 @@ private:
     // 线宽设置
     QSpinBox *m_lineWidthSpin;
     
+    // 包络带均值线
+    QCheckBox *m_meanLineCheck;
+    
+    // 时频图设置
+    QComboBox *m_segmentCombo;
+    QSpinBox *m_overlapSpin;
+    QComboBox *m_windowCombo;
+    
     // Y轴分组设置
     QSpinBox *m_yAxisGroupSpin;
     
     // 分组框
     QGroupBox *m_rangeGroup;
     QGroupBox *m_scatterGroup;
+    QGroupBox *m_spectrogramGroup;
 };
 
 #endif // SERIESSTYLEDIALOG_H
@@ -0,0 +1,173 @@
+#include "sortindex.h"
+#include "parallelutils.h"
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// 每块至少处理的点数
+const qint64 kMinPointsPerChunk = 256 * 1024;
+// 排序下标缓存的内存上限（KB）
+const int kMaxCacheKB = 256 * 1024;
+
+struct CacheEntry {
+    QVector<double> xData;      // 持有X数据，保证键中的地址有效
+    SortIndex::Permutation order;
+};
+
+typedef QPair<quintptr, int> CacheKey;
+
+QMutex &cacheMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QCache<CacheKey, CacheEntry> &cache()
+{
+    static QCache<CacheKey, CacheEntry> instance(kMaxCacheKB);
+    return instance;
+}
+
+CacheKey makeKey(const QVector<double> &xData)
+{
+    return qMakePair(reinterpret_cast<quintptr>(xData.constData()), xData.size());
+}
+
+} // namespace
+
+SortIndex::Permutation SortIndex::permutation(const QVector<double> &xData)
+{
+    const CacheKey key = makeKey(xData);
+    {
+        QMutexLocker locker(&cacheMutex());
+        if (CacheEntry *entry = cache().object(key)) {
+            return entry->order;
+        }
+    }
+
+    // 排序不持锁进行；并发请求同一列时可能重复计算，结果相同
+    Permutation order(new QVector<int>(compute(xData)));
+
+    CacheEntry *entry = new CacheEntry;
+    entry->xData = xData;
+    entry->order = order;
+    const qint64 bytes = qint64(xData.size()) * sizeof(double) + qint64(order->size()) * sizeof(int);
+    QMutexLocker locker(&cacheMutex());
+    cache().insert(key, entry, static_cast<int>(bytes / 1024 + 1));
+    return order;
+}
+
+QVector<int> SortIndex::compute(const QVector<double> &xData)
+{
+    const double *px = xData.constData();
+    QVector<int> order;
+    order.reserve(xData.size());
+    for (int i = 0; i < xData.size(); ++i) {
+        if (std::isfinite(px[i])) {
+            order.append(i);
+        }
+    }
+    const qint64 n = order.size();
+    if (n < 2) {
+        return order;
+    }
+
+    // 相同X按原下标排序，保证结果确定且与分块方式无关
+    auto less = [px](int a, int b) {
+        return px[a] < px[b] || (px[a] == px[b] && a < b);
+    };
+
+    // 各块独立排序（块边界与 ParallelUtils::forChunks 的划分一致）
+    const int chunks = ParallelUtils::chunkCount(n, kMinPointsPerChunk);
+    std::vector<qint64> runs(chunks + 1);
+    for (int c = 0; c <= chunks; ++c) {
+        runs[c] = n * c / chunks;
+    }
+    int *data = order.data();
+    ParallelUtils::forChunks(n, kMinPointsPerChunk, 0, [&](qint64 begin, qint64 end, int) {
+        std::sort(data + begin, data + end, less);
+    });
+
+    // 逐轮把相邻的有序段两两归并
+    QVector<int> buffer(static_cast<int>(n));
+    int *src = data;
+    int *dst = buffer.data();
+    while (runs.size() > 2) {
+        const int runCount = static_cast<int>(runs.size()) - 1;
+        const int pairs = (runCount + 1) / 2;
+        ParallelUtils::forChunks(pairs, 1, 0, [&](qint64 begin, qint64 end, int) {
+            for (qint64 p = begin; p < end; ++p) {
+                const qint64 lo = runs[2 * p];
+                const qint64 mid = runs[qMin<qint64>(2 * p + 1, runCount)];
+                const qint64 hi = runs[qMin<qint64>(2 * p + 2, runCount)];
+                std::merge(src + lo, src + mid, src + mid, src + hi, dst + lo, less);
+            }
+        });
+
+        std::vector<qint64> next;
+        next.reserve(pairs + 1);
+        for (int p = 0; p < pairs; ++p) {
+            next.push_back(runs[2 * p]);
+        }
+        next.push_back(n);
+        runs.swap(next);
+        std::swap(src, dst);
+    }
+    return src == data ? order : buffer;
+}
+
+void SortIndex::gather(const QVector<double> &xData, const QVector<double> &yData,
+                       const QVector<int> &order,
+                       QVector<double> &sortedX, QVector<double> &sortedY)
+{
+    const double *px = xData.constData();
+    const double *py = yData.constData();
+    const int *po = order.constData();
+    const qint64 n = order.size();
+
+    // 第一遍统计各块的有效点数，第二遍按偏移并行写出
+    const int chunks = ParallelUtils::chunkCount(n, kMinPointsPerChunk);
+    std::vector<qint64> offsets(qMax(1, chunks), 0);
+    ParallelUtils::forChunks(n, kMinPointsPerChunk, 0, [&](qint64 begin, qint64 end, int chunk) {
+        qint64 valid = 0;
+        for (qint64 i = begin; i < end; ++i) {
+            valid += std::isfinite(py[po[i]]) ? 1 : 0;
+        }
+        offsets[chunk] = valid;
+    });
+    qint64 total = 0;
+    for (int c = 0; c < chunks; ++c) {
+        const qint64 valid = offsets[c];
+        offsets[c] = total;
+        total += valid;
+    }
+
+    sortedX.resize(static_cast<int>(total));
+    sortedY.resize(static_cast<int>(total));
+    double *outX = sortedX.data();
+    double *outY = sortedY.data();
+    ParallelUtils::forChunks(n, kMinPointsPerChunk, 0, [&](qint64 begin, qint64 end, int chunk) {
+        qint64 pos = offsets[chunk];
+        for (qint64 i = begin; i < end; ++i) {
+            const int k = po[i];
+            if (std::isfinite(py[k])) {
+                outX[pos] = px[k];
+                outY[pos] = py[k];
+                ++pos;
+            }
+        }
+    });
+}
+
+void SortIndex::clearCache()
+{
+    QMutexLocker locker(&cacheMutex());
+    cache().clear();
+}
@@ -0,0 +1,40 @@
+#ifndef SORTINDEX_H
+#define SORTINDEX_H
+
+#include <QVector>
+#include <QSharedPointer>
+
+/**
+ * @brief X无序数据的排序下标
+ * 多线程分块排序后逐轮两两归并；结果按X的存储缓存（线程安全），
+ * 多条曲线共用同一X列时只排序一次
+ */
+class SortIndex
+{
+public:
+    typedef QSharedPointer<const QVector<int>> Permutation;
+
+    /**
+     * @brief 按X升序排列的原始下标（跳过非有限的X，相同X保持原顺序），优先取缓存
+     */
+    static Permutation permutation(const QVector<double> &xData);
+
+    /**
+     * @brief 计算排序下标（不使用缓存）
+     */
+    static QVector<int> compute(const QVector<double> &xData);
+
+    /**
+     * @brief 按排序下标重排数据，跳过Y为NaN/Inf的点
+     */
+    static void gather(const QVector<double> &xData, const QVector<double> &yData,
+                       const QVector<int> &order,
+                       QVector<double> &sortedX, QVector<double> &sortedY);
+
+    /**
+     * @brief 清空缓存（载入新文件时调用）
+     */
+    static void clearCache();
+};
+
+#endif // SORTINDEX_H
@@ -0,0 +1,361 @@
+#include "spectralanalyzer.h"
+#include "fft.h"
+#include "parallelutils.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const float kNoData = std::numeric_limits<float>::quiet_NaN();
+
+// 时频图每块至少处理的像素列数
+const qint64 kMinColumnsPerChunk = 8;
+// Welch 累加时每块至少包含的段数 / 最多的块数（限制分块累加的内存）
+const qint64 kMinFramesPerBlock = 64;
+const qint64 kMaxWelchBlocks = 256;
+// 重叠百分比上限，保证相邻段至少错开 1/10
+const int kMaxOverlapPercent = 90;
+
+/**
+ * @brief 分段方式：第 j 段从 j·hop 开始，长度 segment；数据短于一段时补零为一段
+ */
+struct Framing
+{
+    int segment;
+    int hop;
+    qint64 frames;
+
+    Framing(qint64 count, const SpectralSettings &settings)
+        : segment(settings.segmentLength())
+        , hop(settings.hopSize())
+        , frames(0)
+    {
+        if (count >= segment) {
+            frames = (count - segment) / hop + 1;
+        } else if (count > 0) {
+            frames = 1;
+        }
+    }
+
+    int bins() const { return segment / 2 + 1; }
+
+    // 第 j 段的中心位置为 j·hop + centerOffset（以采样点为单位）
+    double centerOffset() const { return (segment - 1) / 2.0; }
+};
+
+/**
+ * @brief 单个线程的分段计算：去均值、加窗、实数FFT、单边功率谱密度
+ * 连续请求同一段时直接复用上次的结果（放大到一段跨越多个像素列时）
+ */
+class FrameProcessor
+{
+public:
+    FrameProcessor(const double *data, qint64 count, const Framing &framing,
+                   const QVector<double> &window, double scale)
+        : m_data(data), m_count(count), m_framing(framing), m_window(window.constData())
+        , m_scale(scale), m_frame(framing.segment), m_spectrum(framing.bins())
+        , m_power(framing.bins()), m_lastFrame(-1), m_lastValid(false)
+    {
+    }
+
+    /**
+     * @brief 计算第 j 段，段内有 NaN/Inf 时返回 false
+     */
+    bool compute(qint64 j)
+    {
+        if (j == m_lastFrame) {
+            return m_lastValid;
+        }
+        m_lastFrame = j;
+        m_lastValid = false;
+
+        const int segment = m_framing.segment;
+        const qint64 start = j * m_framing.hop;
+        const int available = static_cast<int>(qMin<qint64>(segment, m_count - start));
+        const double *src = m_data + start;
+
+        double mean = 0.0;
+        for (int i = 0; i < available; ++i) {
+            if (!std::isfinite(src[i])) {
+                return false;
+            }
+            mean += src[i];
+        }
+        mean /= available;
+        for (int i = 0; i < available; ++i) {
+            m_frame[i] = (src[i] - mean) * m_window[i];
+        }
+        std::fill(m_frame.begin() + available, m_frame.end(), 0.0);
+
+        Fft::realForward(m_frame.data(), segment, m_spectrum.data());
+        const int bins = m_framing.bins();
+        for (int k = 0; k < bins; ++k) {
+            // 单边谱：除直流和奈奎斯特频率外，负频率的功率折算到正频率
+            const double factor = (k > 0 && 2 * k < segment) ? 2.0 : 1.0;
+            m_power[k] = std::norm(m_spectrum[k]) * m_scale * factor;
+        }
+        m_lastValid = true;
+        return true;
+    }
+
+    const double *power() const { return m_power.data(); }
+
+private:
+    const double *m_data;
+    qint64 m_count;
+    const Framing &m_framing;
+    const double *m_window;
+    double m_scale;
+    std::vector<double> m_frame;
+    std::vector<Complex> m_spectrum;
+    std::vector<double> m_power;
+    qint64 m_lastFrame;
+    bool m_lastValid;
+};
+
+/**
+ * @brief 功率谱密度的归一化系数 1/(fs·Σw²)
+ */
+double densityScale(const QVector<double> &window, double sampleRate)
+{
+    double sum = 0.0;
+    for (double w : window) {
+        sum += w * w;
+    }
+    return sum > 0.0 && sampleRate > 0.0 ? 1.0 / (sampleRate * sum) : 0.0;
+}
+}
+
+int SpectralSettings::segmentLength() const
+{
+    return qMax(2, segmentSize);
+}
+
+int SpectralSettings::hopSize() const
+{
+    const int segment = segmentLength();
+    const int overlap = qBound(0, overlapPercent, kMaxOverlapPercent);
+    return qMax(1, segment - segment * overlap / 100);
+}
+
+QVector<double> SpectralAnalyzer::window(SpectralWindow type, int size)
+{
+    // 周期形式（分母为 n），相邻段重叠相加时更平坦，适用于谱分析
+    QVector<double> w(qMax(0, size), 1.0);
+    for (int i = 0; i < w.size(); ++i) {
+        const double phase = 2.0 * kPi * i / size;
+        switch (type) {
+        case SpectralWindow::Rectangular:
+            break;
+        case SpectralWindow::Hann:
+            w[i] = 0.5 - 0.5 * std::cos(phase);
+            break;
+        case SpectralWindow::Hamming:
+            w[i] = 0.54 - 0.46 * std::cos(phase);
+            break;
+        case SpectralWindow::Blackman:
+            w[i] = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+            break;
+        }
+    }
+    return w;
+}
+
+QVector<double> SpectralAnalyzer::welch(const double *data, qint64 count,
+                                        const SpectralSettings &settings, double sampleRate)
+{
+    const Framing framing(count, settings);
+    if (!data || framing.frames == 0) {
+        return QVector<double>();
+    }
+    const int bins = framing.bins();
+    const QVector<double> win = window(settings.window, framing.segment);
+    const double scale = densityScale(win, sampleRate);
+
+    // 段按固定大小分块，各块并行累加后按顺序合并
+    const qint64 blockFrames = qMax(kMinFramesPerBlock,
+                                    (framing.frames + kMaxWelchBlocks - 1) / kMaxWelchBlocks);
+    const qint64 blocks = (framing.frames + blockFrames - 1) / blockFrames;
+    std::vector<std::vector<double>> sums(blocks);
+    std::vector<qint64> validCounts(blocks, 0);
+
+    ParallelUtils::forChunks(blocks, 1, 0, [&](qint64 begin, qint64 end, int) {
+        FrameProcessor processor(data, count, framing, win, scale);
+        for (qint64 b = begin; b < end; ++b) {
+            std::vector<double> &sum = sums[b];
+            sum.assign(bins, 0.0);
+            const qint64 last = qMin(framing.frames, (b + 1) * blockFrames);
+            for (qint64 j = b * blockFrames; j < last; ++j) {
+                if (!processor.compute(j)) {
+                    continue;
+                }
+                const double *power = processor.power();
+                for (int k = 0; k < bins; ++k) {
+                    sum[k] += power[k];
+                }
+                ++validCounts[b];
+            }
+        }
+    });
+
+    QVector<double> result(bins, 0.0);
+    qint64 valid = 0;
+    for (qint64 b = 0; b < blocks; ++b) {
+        for (int k = 0; k < bins; ++k) {
+            result[k] += sums[b][k];
+        }
+        valid += validCounts[b];
+    }
+    for (double &value : result) {
+        value = valid > 0 ? value / valid : std::numeric_limits<double>::quiet_NaN();
+    }
+    return result;
+}
+
+SpectralAnalyzer::Grid SpectralAnalyzer::spectrogram(const double *data, qint64 count,
+                                                     const SpectralSettings &settings,
+                                                     const View &view, bool *exhaustive,
+                                                     const QAtomicInt *cancel)
+{
+    Grid grid;
+    const Framing framing(count, settings);
+    if (!data || framing.frames == 0 || view.columns <= 0 || view.rows <= 0 ||
+        !(view.lastSample > view.firstSample) || !(view.binHigh > view.binLow)) {
+        return grid;
+    }
+    const int bins = framing.bins();
+    const int columns = view.columns;
+    const int rows = view.rows;
+
+    // 每行对应的频率分量 [rowBegin, rowEnd)：中心落在该行内的分量，没有时取最近的一个
+    std::vector<int> rowBegin(rows);
+    std::vector<int> rowEnd(rows);
+    const double rowStep = (view.binHigh - view.binLow) / rows;
+    for (int r = 0; r < rows; ++r) {
+        const double high = view.binHigh - r * rowStep;
+        const double low = high - rowStep;
+        double first = std::ceil(low);
+        double last = std::ceil(high);
+        if (first >= last) {
+            first = std::floor((low + high) / 2 + 0.5);
+            last = first + 1;
+        }
+        first = qMax(first, 0.0);
+        last = qMin(last, static_cast<double>(bins));
+        rowBegin[r] = first < last ? static_cast<int>(first) : 0;
+        rowEnd[r] = first < last ? static_cast<int>(last) : 0;
+    }
+
+    grid.columns = columns;
+    grid.rows = rows;
+    grid.power.resize(columns * rows);
+    float *out = grid.power.data();
+
+    const QVector<double> win = window(settings.window, framing.segment);
+    const double scale = densityScale(win, 1.0);
+    const double columnSpan = (view.lastSample - view.firstSample) / columns;
+    const double centerOffset = framing.centerOffset();
+    const int chunks = ParallelUtils::chunkCount(columns, kMinColumnsPerChunk);
+    std::vector<float> maxima(qMax(1, chunks), 0.0f);
+    std::atomic<bool> subsampled(false);
+
+    ParallelUtils::forChunks(columns, kMinColumnsPerChunk, 0, [&](qint64 begin, qint64 end, int chunk) {
+        FrameProcessor processor(data, count, framing, win, scale);
+        std::vector<double> average(bins);
+        float localMax = 0.0f;
+
+        for (qint64 c = begin; c < end; ++c) {
+            if (cancel && cancel->loadAcquire()) {
+                return;
+            }
+            const double left = view.firstSample + c * columnSpan;
+            const double right = left + columnSpan;
+
+            // 中心落在该列内的段；一段跨越多列时取中心最近的段
+            qint64 firstFrame = 0;
+            qint64 lastFrame = 0;
+            if (right > 0.0 && left < count) {
+                firstFrame = static_cast<qint64>(std::ceil((left - centerOffset) / framing.hop));
+                lastFrame = static_cast<qint64>(std::ceil((right - centerOffset) / framing.hop));
+                firstFrame = qBound<qint64>(0, firstFrame, framing.frames);
+                lastFrame = qBound<qint64>(0, lastFrame, framing.frames);
+                if (firstFrame >= lastFrame) {
+                    const double middle = (left + right) / 2;
+                    firstFrame = qBound<qint64>(0, std::llround((middle - centerOffset) / framing.hop),
+                                                framing.frames - 1);
+                    lastFrame = firstFrame + 1;
+                }
+            }
+
+            // 段数超过上限时均匀抽取
+            const qint64 available = lastFrame - firstFrame;
+            qint64 picks = available;
+            if (view.maxFramesPerColumn > 0 && available > view.maxFramesPerColumn) {
+                picks = view.maxFramesPerColumn;
+                subsampled.store(true, std::memory_order_relaxed);
+            }
+
+            std::fill(average.begin(), average.end(), 0.0);
+            qint64 valid = 0;
+            for (qint64 i = 0; i < picks; ++i) {
+                qint64 j = firstFrame + i;
+                if (picks < available) {
+                    j = firstFrame + (picks == 1 ? available / 2 : i * (available - 1) / (picks - 1));
+                }
+                if (!processor.compute(j)) {
+                    continue;
+                }
+                const double *power = processor.power();
+                for (int k = 0; k < bins; ++k) {
+                    average[k] += power[k];
+                }
+                ++valid;
+            }
+
+            for (int r = 0; r < rows; ++r) {
+                float value = kNoData;
+                if (valid > 0 && rowBegin[r] < rowEnd[r]) {
+                    double peak = 0.0;
+                    for (int k = rowBegin[r]; k < rowEnd[r]; ++k) {
+                        peak = qMax(peak, average[k]);
+                    }
+                    value = static_cast<float>(peak / valid);
+                    localMax = qMax(localMax, value);
+                }
+                out[qint64(r) * columns + c] = value;
+            }
+        }
+        maxima[chunk] = localMax;
+    });
+
+    if (cancel && cancel->loadAcquire()) {
+        return Grid();
+    }
+    for (float m : maxima) {
+        grid.maxPower = qMax(grid.maxPower, m);
+    }
+    if (exhaustive) {
+        *exhaustive = !subsampled.load();
+    }
+    return grid;
+}
+
+double SpectralAnalyzer::sampleRate(const QVector<double> &xData, int count)
+{
+    if (xData.isEmpty()) {
+        return 1.0;
+    }
+    const int n = qMin(count, xData.size());
+    if (n < 2) {
+        return 0.0;
+    }
+    const double span = xData[n - 1] - xData[0];
+    if (!std::isfinite(span) || !(span > 0.0)) {
+        return 0.0;
+    }
+    return (n - 1) / span;
+}
@@ -0,0 +1,106 @@
+#ifndef SPECTRALANALYZER_H
+#define SPECTRALANALYZER_H
+
+#include <QAtomicInt>
+#include <QVector>
+
+/**
+ * @brief 分段谱估计使用的窗函数
+ */
+enum class SpectralWindow {
+    Rectangular,
+    Hann,
+    Hamming,
+    Blackman
+};
+
+/**
+ * @brief 分段谱估计的参数
+ */
+struct SpectralSettings
+{
+    int segmentSize = 1024;                         // 每段点数（FFT长度）
+    int overlapPercent = 50;                        // 相邻段重叠的百分比（0~90）
+    SpectralWindow window = SpectralWindow::Hann;
+
+    /**
+     * @brief 实际使用的段长（至少2点）
+     */
+    int segmentLength() const;
+
+    /**
+     * @brief 相邻段起点的间隔（点数）
+     */
+    int hopSize() const;
+
+    bool operator==(const SpectralSettings &other) const
+    {
+        return segmentSize == other.segmentSize && overlapPercent == other.overlapPercent &&
+               window == other.window;
+    }
+    bool operator!=(const SpectralSettings &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief STFT 时频图与 Welch 功率谱密度
+ * 信号按 segmentSize 分段，每段去均值、加窗后做实数FFT，功率按单边谱密度归一化；
+ * 含 NaN/Inf 的段跳过。各段在多个线程上并行计算。
+ * 时频图只按显示分辨率计算：每个像素列平均落在该列内的各段功率，
+ * 每个像素行取对应频率范围内的最大值，不保存完整的 STFT 矩阵，内存占用与数据长度无关
+ */
+class SpectralAnalyzer
+{
+public:
+    /**
+     * @brief 时频图的像素网格
+     * power 按行优先存储，第0行对应最高频率；NaN 表示该处没有数据
+     */
+    struct Grid {
+        int columns = 0;
+        int rows = 0;
+        QVector<float> power;
+        float maxPower = 0.0f;
+    };
+
+    /**
+     * @brief 时频图的可见范围与分辨率
+     */
+    struct View {
+        double firstSample = 0.0;       // 左、右边缘对应的采样点位置（可超出数据范围）
+        double lastSample = 0.0;
+        int columns = 0;
+        double binLow = 0.0;            // 底边、顶边对应的频率分量序号（可为小数）
+        double binHigh = 0.0;
+        int rows = 0;
+        int maxFramesPerColumn = 0;     // 每列最多平均的段数（均匀抽取），<=0 表示不限
+    };
+
+    /**
+     * @brief 窗函数系数（周期形式）
+     */
+    static QVector<double> window(SpectralWindow type, int size);
+
+    /**
+     * @brief Welch 功率谱密度，返回 segmentSize/2+1 个点，第 k 点的频率为 k·fs/segmentSize
+     * 各段的累加按固定大小的块分组，结果与线程数无关
+     */
+    static QVector<double> welch(const double *data, qint64 count,
+                                 const SpectralSettings &settings, double sampleRate);
+
+    /**
+     * @brief 计算可见范围内的时频图
+     * @param exhaustive 非空时返回是否每列的段都已全部计算（没有因 maxFramesPerColumn 抽取）
+     * @param cancel 非空且被置1时尽快返回空网格
+     */
+    static Grid spectrogram(const double *data, qint64 count, const SpectralSettings &settings,
+                            const View &view, bool *exhaustive = nullptr,
+                            const QAtomicInt *cancel = nullptr);
+
+    /**
+     * @brief 按均匀采样估计采样率 (n-1)/(X末-X首)，X为空时为1（每行一个采样点）
+     * 无法估计时返回0
+     */
+    static double sampleRate(const QVector<double> &xData, int count);
+};
+
+#endif // SPECTRALANALYZER_H
@@ -0,0 +1,73 @@
+#include "spectrogramrenderer.h"
+#include "densitymap.h"
+#include "parallelutils.h"
+#include "xvalues.h"
+#include <cmath>
+
+QImage SpectrogramRenderer::colorize(const SpectralAnalyzer::Grid &grid, double dynamicRange)
+{
+    if (grid.columns <= 0 || grid.rows <= 0) {
+        return QImage();
+    }
+
+    QImage image(grid.columns, grid.rows, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    const QVector<QRgb> &palette = DensityBinner::palette();
+    const double range = dynamicRange > 0.0 ? dynamicRange : 80.0;
+    const double top = grid.maxPower > 0.0f ? 10.0 * std::log10(static_cast<double>(grid.maxPower)) : 0.0;
+    const double bottom = top - range;
+
+    // 在进入并行区之前取得像素指针，避免多线程中触发隐式共享的分离
+    uchar *bits = image.bits();
+    const qint64 bytesPerLine = image.bytesPerLine();
+
+    ParallelUtils::forChunks(grid.rows, 64, 0, [&](qint64 begin, qint64 end, int) {
+        for (qint64 row = begin; row < end; ++row) {
+            QRgb *line = reinterpret_cast<QRgb *>(bits + row * bytesPerLine);
+            const float *src = grid.power.constData() + row * grid.columns;
+            for (int col = 0; col < grid.columns; ++col) {
+                const float power = src[col];
+                if (std::isnan(power)) {
+                    continue;  // 无数据处透明
+                }
+                int index = 0;
+                if (power > 0.0f) {
+                    const double t = (10.0 * std::log10(static_cast<double>(power)) - bottom) / range;
+                    index = static_cast<int>(qBound(0.0, t, 1.0) * 255);
+                }
+                line[col] = palette[index];
+            }
+        }
+    });
+    return image;
+}
+
+QImage SpectrogramRenderer::render(const QVector<double> &xData, const QVector<double> &yData,
+                                   const SpectralSettings &settings,
+                                   double xMin, double xMax, double fMin, double fMax,
+                                   int width, int height, int maxFramesPerColumn,
+                                   bool *exhaustive, const QAtomicInt *cancel)
+{
+    const qint64 count = XValues::count(xData, yData);
+    const double fs = SpectralAnalyzer::sampleRate(xData, static_cast<int>(count));
+    if (count == 0 || !(fs > 0.0) || width <= 0 || height <= 0) {
+        return QImage();
+    }
+
+    // X与采样点的换算按均匀采样：第 i 点位于 x0 + i/fs
+    const double x0 = xData.isEmpty() ? 0.0 : xData.first();
+    const double binWidth = fs / settings.segmentLength();
+
+    SpectralAnalyzer::View view;
+    view.firstSample = (xMin - x0) * fs;
+    view.lastSample = (xMax - x0) * fs;
+    view.columns = width;
+    view.binLow = fMin / binWidth;
+    view.binHigh = fMax / binWidth;
+    view.rows = height;
+    view.maxFramesPerColumn = maxFramesPerColumn;
+
+    const SpectralAnalyzer::Grid grid = SpectralAnalyzer::spectrogram(yData.constData(), count, settings, view, exhaustive, cancel);
+    return colorize(grid);
+}
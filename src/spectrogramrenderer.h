@@ -0,0 +1,32 @@
+#ifndef SPECTROGRAMRENDERER_H
+#define SPECTROGRAMRENDERER_H
+
+#include "spectralanalyzer.h"
+#include <QAtomicInt>
+#include <QImage>
+#include <QVector>
+
+/**
+ * @brief 时频图着色与绘制
+ * 谱计算由 SpectralAnalyzer 完成，这里只负责换算坐标范围并按调色板生成图像
+ */
+class SpectrogramRenderer
+{
+public:
+    /**
+     * @brief 按分贝着色，最大值以下 dynamicRange dB 映射到调色板，无数据处透明
+     */
+    static QImage colorize(const SpectralAnalyzer::Grid &grid, double dynamicRange = 80.0);
+
+    /**
+     * @brief 按坐标范围绘制时频图：X为时间（与 xData 同单位，xData 为空时为行号），Y为频率
+     * @return 无法绘制（数据为空、采样率未知等）时返回空图像
+     */
+    static QImage render(const QVector<double> &xData, const QVector<double> &yData,
+                         const SpectralSettings &settings,
+                         double xMin, double xMax, double fMin, double fMax,
+                         int width, int height, int maxFramesPerColumn,
+                         bool *exhaustive = nullptr, const QAtomicInt *cancel = nullptr);
+};
+
+#endif // SPECTROGRAMRENDERER_H
@@ -0,0 +1,111 @@
+#include "typedarraybridge.h"
+#include <QByteArray>
+#include <cstring>
+
+TypedArrayBridge::TypedArrayBridge(QJSEngine *engine, QObject *parent)
+    : QObject(parent)
+    , m_engine(engine)
+{
+    m_self = m_engine->newQObject(this);
+
+    m_viewFunction = m_engine->evaluate(R"(
+        (function(buffer) { return new Float64Array(buffer); })
+    )");
+
+    m_convertFunction = m_engine->evaluate(R"(
+        (function(value) {
+            if (value instanceof Float64Array) return value;
+            if (Array.isArray(value) || ArrayBuffer.isView(value)) return Float64Array.from(value);
+            return null;
+        })
+    )");
+
+    // 首次读取时向本对象取数据，并把访问器替换为普通属性，同一次执行内只载入一次
+    m_bindFunction = m_engine->evaluate(R"(
+        (function(bridge, obj, name) {
+            function settle(value) {
+                Object.defineProperty(obj, name, {
+                    value: value, writable: true, enumerable: true, configurable: true
+                });
+                return value;
+            }
+            Object.defineProperty(obj, name, {
+                enumerable: true, configurable: true,
+                get: function() { return settle(bridge.column(name)); },
+                set: function(value) { settle(value); }
+            });
+        })
+    )");
+}
+
+QJSValue TypedArrayBridge::toFloat64Array(const QVector<double> &values) const
+{
+    // 共享列存储会让脚本写入改动列数据，因此拷贝一份
+    Float64Buffer buffer(values.size());
+    if (!values.isEmpty()) {
+        std::memcpy(buffer.data(), values.constData(), values.size() * sizeof(double));
+    }
+    return wrap(buffer);
+}
+
+QJSValue TypedArrayBridge::wrap(const Float64Buffer &buffer) const
+{
+    // QJSEngine 将 QByteArray 转换为共享同一存储的 ArrayBuffer
+    return m_viewFunction.call(QJSValueList() << m_engine->toScriptValue(buffer.bytes()));
+}
+
+bool TypedArrayBridge::view(const QJSValue &value, Float64View &view) const
+{
+    const QJSValue array = m_convertFunction.call(QJSValueList() << value);
+    if (!array.isObject()) {
+        return false;
+    }
+
+    const int length = array.property("length").toInt();
+    const int byteOffset = array.property("byteOffset").toInt();
+    const QByteArray bytes = array.property("buffer").toVariant().toByteArray();
+    if (length < 0 || byteOffset < 0 ||
+        bytes.size() < byteOffset + length * static_cast<int>(sizeof(double))) {
+        return false;
+    }
+
+    view.storage = bytes;
+    view.data = reinterpret_cast<const double *>(view.storage.constData() + byteOffset);
+    view.size = length;
+    return true;
+}
+
+bool TypedArrayBridge::toVector(const QJSValue &value, QVector<double> &values) const
+{
+    Float64View array;
+    if (!view(value, array)) {
+        return false;
+    }
+    values.resize(array.size);
+    if (array.size > 0) {
+        std::memcpy(values.data(), array.data, array.size * sizeof(double));
+    }
+    return true;
+}
+
+QJSValue TypedArrayBridge::createDataObject(const QMap<QString, QVector<double>> &columns,
+                                            const QStringList &order)
+{
+    m_columns = columns;
+    QJSValue dataObj = m_engine->newObject();
+    for (const QString &name : order) {
+        if (m_columns.contains(name)) {
+            m_bindFunction.call(QJSValueList() << m_self << dataObj << name);
+        }
+    }
+    return dataObj;
+}
+
+QJSValue TypedArrayBridge::column(const QString &name) const
+{
+    auto it = m_columns.constFind(name);
+    if (it == m_columns.constEnd()) {
+        return QJSValue(QJSValue::UndefinedValue);
+    }
+    return toFloat64Array(it.value());
+}
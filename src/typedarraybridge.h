@@ -0,0 +1,100 @@
+#ifndef TYPEDARRAYBRIDGE_H
+#define TYPEDARRAYBRIDGE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QJSEngine>
+#include <QJSValue>
+
+/**
+ * @brief 只读的 double 数组视图
+ * 引用 Float64Array 底层的 ArrayBuffer 存储，读取时不拷贝
+ */
+struct Float64View
+{
+    QByteArray storage;             // 持有底层存储，保证 data 有效
+    const double *data = nullptr;
+    int size = 0;
+};
+
+/**
+ * @brief 可写的 double 缓冲区，计算完成后由 TypedArrayBridge::wrap 直接交给JS（不拷贝）
+ */
+class Float64Buffer
+{
+public:
+    explicit Float64Buffer(int size)
+        : m_bytes(qMax(0, size) * static_cast<int>(sizeof(double)), Qt::Uninitialized)
+    {
+    }
+
+    double *data() { return reinterpret_cast<double *>(m_bytes.data()); }
+    int size() const { return m_bytes.size() / static_cast<int>(sizeof(double)); }
+    const QByteArray &bytes() const { return m_bytes; }
+
+private:
+    QByteArray m_bytes;
+};
+
+/**
+ * @brief C++ 数据列与 JS 类型化数组（Float64Array）之间的批量转换
+ * 每个 QJSEngine 对应一个实例。数据列以 Float64Array 的形式提供给脚本，
+ * 转换为整块内存拷贝，不再逐元素调用 setProperty/property
+ */
+class TypedArrayBridge : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TypedArrayBridge(QJSEngine *engine, QObject *parent = nullptr);
+
+    /**
+     * @brief 将数据整块拷贝为 Float64Array
+     */
+    QJSValue toFloat64Array(const QVector<double> &values) const;
+
+    /**
+     * @brief 将缓冲区包装为 Float64Array，与缓冲区共享存储（之后不应再写入缓冲区）
+     */
+    QJSValue wrap(const Float64Buffer &buffer) const;
+
+    /**
+     * @brief 获取数组的只读视图：Float64Array 直接引用其存储，
+     * 其他类型化数组和普通数组先在引擎内转换为 Float64Array
+     * @return 不是数组时返回 false
+     */
+    bool view(const QJSValue &value, Float64View &view) const;
+
+    /**
+     * @brief 读取脚本返回的数组（整块拷贝）
+     * @return 不是数组时返回 false
+     */
+    bool toVector(const QJSValue &value, QVector<double> &values) const;
+
+    /**
+     * @brief 创建 data 对象：每列注册为访问器属性，首次读取时才生成 Float64Array，
+     * 绑定的开销只与列数有关，与列长度无关
+     * @param columns 列名 -> 数据（隐式共享，不复制）
+     */
+    QJSValue createDataObject(const QMap<QString, QVector<double>> &columns,
+                              const QStringList &order);
+
+    /**
+     * @brief 供 data 对象的访问器回调，返回已绑定列的 Float64Array
+     */
+    Q_INVOKABLE QJSValue column(const QString &name) const;
+
+private:
+    QJSEngine *m_engine;
+    QJSValue m_self;                            // 本对象在JS中的包装
+    QJSValue m_viewFunction;                    // ArrayBuffer -> Float64Array
+    QJSValue m_convertFunction;                 // 任意数组 -> Float64Array
+    QJSValue m_bindFunction;                    // 注册延迟载入的列
+    QMap<QString, QVector<double>> m_columns;   // 当前绑定的列
+};
+
+#endif // TYPEDARRAYBRIDGE_H
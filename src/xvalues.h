@@ -0,0 +1,37 @@
+#ifndef XVALUES_H
+#define XVALUES_H
+
+#include <QVector>
+
+/**
+ * @brief X数据的只读访问
+ * X数组为空表示隐式行索引 0,1,2,...：X值由下标直接算出，不生成索引数组
+ */
+class XValues
+{
+public:
+    explicit XValues(const QVector<double> &xData)
+        : m_data(xData.isEmpty() ? nullptr : xData.constData())
+    {
+    }
+
+    bool isImplicit() const { return m_data == nullptr; }
+
+    double operator[](qint64 i) const
+    {
+        return m_data ? m_data[i] : static_cast<double>(i);
+    }
+
+    /**
+     * @brief 数据点个数：显式X取两者中较短的长度，隐式X以Y为准
+     */
+    static int count(const QVector<double> &xData, const QVector<double> &yData)
+    {
+        return xData.isEmpty() ? yData.size() : qMin(xData.size(), yData.size());
+    }
+
+private:
+    const double *m_data;
+};
+
+#endif // XVALUES_H
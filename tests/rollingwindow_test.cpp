@@ -0,0 +1,168 @@
+/**
+ * @brief RollingWindow 与逐窗口直接计算的对比测试
+ * 强制按多个线程划分数据块，检查块边界处增量窗口的初始化
+ */
+#include "rollingwindow.h"
+#include "parallelutils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+typedef void (*Kernel)(const double *, int, int, double *);
+typedef double (*Reference)(const double *, int, int);
+
+double referenceMean(const double *window, int size, int)
+{
+    double sum = 0.0;
+    for (int j = 0; j < size; ++j) {
+        sum += window[j];
+    }
+    return sum / size;
+}
+
+double referenceStddev(const double *window, int size, int)
+{
+    double mean = 0.0;
+    for (int j = 0; j < size; ++j) {
+        if (!std::isfinite(window[j])) {
+            return kNaN;
+        }
+        mean += window[j];
+    }
+    if (size < 2) {
+        return 0.0;
+    }
+    mean /= size;
+    double m2 = 0.0;
+    for (int j = 0; j < size; ++j) {
+        m2 += (window[j] - mean) * (window[j] - mean);
+    }
+    return std::sqrt(m2 / (size - 1));
+}
+
+double referenceMedian(const double *window, int size, int)
+{
+    std::vector<double> values;
+    for (int j = 0; j < size; ++j) {
+        if (!std::isnan(window[j])) {
+            values.push_back(window[j]);
+        }
+    }
+    if (values.empty()) {
+        return kNaN;
+    }
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+double referenceMinimum(const double *window, int size, int)
+{
+    double result = kNaN;
+    for (int j = 0; j < size; ++j) {
+        if (!std::isnan(window[j]) && !(result <= window[j])) {
+            result = window[j];
+        }
+    }
+    return result;
+}
+
+double referenceMaximum(const double *window, int size, int)
+{
+    double result = kNaN;
+    for (int j = 0; j < size; ++j) {
+        if (!std::isnan(window[j]) && !(result >= window[j])) {
+            result = window[j];
+        }
+    }
+    return result;
+}
+
+bool same(double actual, double expected, double tolerance)
+{
+    if (std::isnan(expected) || std::isnan(actual)) {
+        return std::isnan(expected) && std::isnan(actual);
+    }
+    return std::fabs(actual - expected) <= tolerance * std::max(1.0, std::fabs(expected));
+}
+
+/**
+ * @brief 返回不一致的输出点个数
+ */
+int check(const char *name, Kernel kernel, Reference reference,
+          const std::vector<double> &data, int windowSize, int threads, double tolerance = 1e-9)
+{
+    ParallelUtils::threadCountOverride() = threads;
+    const int count = static_cast<int>(data.size());
+    std::vector<double> out(count, 0.0);
+    kernel(data.data(), count, windowSize, out.data());
+    ParallelUtils::threadCountOverride() = 0;
+
+    const int half = std::min(std::max(windowSize, 1), count) / 2;
+    int wrong = 0;
+    int firstWrong = -1;
+    for (int i = 0; i < count; ++i) {
+        const int from = std::max(0, i - half);
+        const int to = std::min(count, i + half + 1);
+        if (!same(out[i], reference(data.data() + from, to - from, half), tolerance)) {
+            if (wrong++ == 0) {
+                firstWrong = i;
+            }
+        }
+    }
+    if (wrong > 0) {
+        std::printf("FAIL %s w=%d threads=%d: %d of %d wrong, first at %d\n",
+                    name, windowSize, threads, wrong, count, firstWrong);
+    }
+    return wrong;
+}
+
+} // namespace
+
+int main()
+{
+    // 随机游走加一个大偏移，检验增量求和的精度；均值和标准差用无 NaN 的数据，
+    // 中位数和极值另测含 NaN 的数据
+    std::mt19937_64 rng(12345);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    const int count = 300000;
+    std::vector<double> walk(count);
+    double level = 1.0e4;
+    for (int i = 0; i < count; ++i) {
+        level += noise(rng);
+        walk[i] = level;
+    }
+    std::vector<double> gappy = walk;
+    std::uniform_int_distribution<int> position(0, count - 1);
+    for (int k = 0; k < 2000; ++k) {
+        gappy[position(rng)] = kNaN;
+    }
+
+    const int windows[] = {1, 5, 101, 401};
+    const int threadCounts[] = {1, 3, 4, 7};
+    int failures = 0;
+    for (int windowSize : windows) {
+        for (int threads : threadCounts) {
+            failures += check("mean", RollingWindow::mean, referenceMean, walk, windowSize, threads) > 0;
+            // 增量移出的舍入误差约为 eps·(偏移/标准差)²，块边界错误时误差为 O(1)
+            failures += check("stddev", RollingWindow::stddev, referenceStddev, walk, windowSize, threads,
+                              1e-6) > 0;
+            failures += check("median", RollingWindow::median, referenceMedian, gappy, windowSize, threads) > 0;
+            failures += check("minimum", RollingWindow::minimum, referenceMinimum, gappy, windowSize, threads) > 0;
+            failures += check("maximum", RollingWindow::maximum, referenceMaximum, gappy, windowSize, threads) > 0;
+        }
+    }
+
+    if (failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("all rolling window checks passed\n");
+    return 0;
+}
@@ -0,0 +1,190 @@
+/**
+ * @brief 旧版数组接口的兼容性测试
+ * math 函数和 data 列改为 Float64Array 之前编写的脚本（使用 push、concat、Array.isArray、
+ * 按字符串排序等）按旧版数组接口执行时，应得到与普通数组时相同的结果；
+ * 默认接口下 math 结果和 data 列为 Float64Array，需要数组方法时用 math.to_array 转换
+ */
+#include "scriptrunner.h"
+#include <QCoreApplication>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+struct Case {
+    const char *name;
+    bool legacyArrays;
+    const char *script;
+    QVector<double> expected;
+};
+
+bool same(const QVector<double> &actual, const QVector<double> &expected)
+{
+    if (actual.size() != expected.size()) {
+        return false;
+    }
+    for (int i = 0; i < actual.size(); ++i) {
+        if (std::fabs(actual[i] - expected[i]) > 1e-9 * std::max(1.0, std::fabs(expected[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const int count = 1000;
+    QVector<double> time(count);
+    QVector<double> value(count);
+    for (int i = 0; i < count; ++i) {
+        time[i] = 1000.0 + i * 10.0;
+        value[i] = std::sin(i * 0.1) * 10.0 + i;
+    }
+    QMap<QString, QVector<double>> columns;
+    columns.insert("Time", time);
+    columns.insert("Value", value);
+
+    QVector<double> doubled(count);
+    QVector<double> shifted(count);
+    QVector<double> seconds(count);
+    QVector<double> running(count);
+    double total = 0.0;
+    for (int i = 0; i < count; ++i) {
+        doubled[i] = value[i] * 2.0;
+        shifted[i] = value[i] + 1.0;
+        seconds[i] = (time[i] - time[0]) * 0.001;
+        total += value[i];
+        running[i] = total;
+    }
+    QVector<double> sums = running;
+    sums.append(total);
+
+    // 1~20：按数值排序，以及普通数组 sort() 默认的按字符串排序
+    QVector<double> numeric;
+    for (int i = 1; i <= 20; ++i) {
+        numeric.append(i);
+    }
+    QVector<double> lexical;
+    lexical.append(1);
+    for (int i = 10; i <= 19; ++i) {
+        lexical.append(i);
+    }
+    lexical.append(2);
+    lexical.append(20);
+    for (int i = 3; i <= 9; ++i) {
+        lexical.append(i);
+    }
+
+    const Case cases[] = {
+        // 逐点处理后用 push 收集结果
+        {"push", true, R"(
+            var v = math.scale(data.Value, 2);
+            var out = [];
+            v.forEach(function(x) { out.push(x); });
+            v.push(0);
+            v.pop();
+            return out.length === v.length ? v : [];
+        )", doubled},
+        // 分段处理后用 concat 拼接，并检查 Array.isArray
+        {"concat", true, R"(
+            var head = math.offset(data.Value, 1).slice(0, 10);
+            var tail = math.offset(data.Value, 1).slice(10);
+            if (!Array.isArray(head) || !Array.isArray(tail)) {
+                throw new Error("math 的结果不是数组");
+            }
+            return head.concat(tail);
+        )", shifted},
+        // 对 data 列直接使用数组方法
+        {"data", true, R"(
+            var t = data.Time.concat([]);
+            if (!(t instanceof Array)) {
+                throw new Error("data 列不是数组");
+            }
+            return math.ms_to_s_from_zero(t);
+        )", seconds},
+        // 在 math 结果末尾追加汇总值
+        {"append", true, R"(
+            var c = math.cumsum(data.Value);
+            c.push(math.sum(data.Value));
+            return c;
+        )", sums},
+        // 在结果末尾按下标追加（类型化数组长度固定，写入无效）
+        {"index-append", true, R"(
+            var out = math.zeros(0);
+            for (var i = 0; i < data.Value.length; ++i) {
+                out[out.length] = data.Value[i] * 2;
+            }
+            return out;
+        )", doubled},
+        // 普通数组的 sort() 按字符串排序
+        {"sort-legacy", true, R"(
+            var v = math.linspace(1, 20, 20);
+            v.sort();
+            return v;
+        )", lexical},
+        // 类型化数组的 sort() 按数值排序
+        {"sort-typed", false, R"(
+            var v = math.linspace(1, 20, 20);
+            v.sort();
+            return v;
+        )", numeric},
+        // 默认接口下用 math.to_array 取得普通数组
+        {"to_array", false, R"(
+            var out = math.to_array(math.scale(data.Value, 2));
+            out.push(0);
+            out.pop();
+            if (!Array.isArray(out)) {
+                throw new Error("to_array 的结果不是数组");
+            }
+            return out;
+        )", doubled},
+        // 脚本自己创建的数组不受数组接口影响
+        {"own-array", false, R"(
+            var out = [];
+            for (var i = 0; i < data.Value.length; ++i) {
+                out.push(data.Value[i] * 2);
+            }
+            return out;
+        )", doubled},
+        // 默认接口下 math 结果和 data 列为 Float64Array
+        {"typed", false, R"(
+            var r = math.scale(data.Value, 2);
+            if (!(r instanceof Float64Array) || !(data.Value instanceof Float64Array)) {
+                throw new Error("结果应为 Float64Array");
+            }
+            return r;
+        )", doubled},
+    };
+
+    ScriptRunner runner;
+    int failures = 0;
+    for (const Case &c : cases) {
+        runner.bind(columns, QStringList() << "Time" << "Value");
+        QVector<double> result;
+        QString error;
+        if (!runner.run(QString::fromUtf8(c.script), result, error, c.legacyArrays)) {
+            std::printf("FAIL %s: %s\n", c.name, error.toUtf8().constData());
+            ++failures;
+        } else if (!same(result, c.expected)) {
+            std::printf("FAIL %s: result differs (%d values, expected %d)\n",
+                        c.name, result.size(), c.expected.size());
+            ++failures;
+        }
+    }
+
+    if (failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("all script compatibility checks passed\n");
+    return 0;
+}